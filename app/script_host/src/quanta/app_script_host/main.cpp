@@ -7,6 +7,7 @@
 #include <quanta/app_script_host/types.hpp>
 
 #include <quanta/core/lua/lua.hpp>
+#include <quanta/core/object/object.hpp>
 
 #include <togo/core/utility/utility.hpp>
 #include <togo/core/log/log.hpp>
@@ -69,6 +70,8 @@ signed main(signed argc, char* argv[]) {
 	lua_pop(L, 1);
 	lua_close(L);
 
+	// Pooled object nodes belong to the default allocator
+	object::pool_trim();
 	memory::shutdown();
 	return ec;
 }
@@ -7,6 +7,7 @@
 #include <quanta/app_tool/types.hpp>
 
 #include <quanta/core/lua/lua.hpp>
+#include <quanta/core/object/object.hpp>
 
 #include <togo/core/utility/utility.hpp>
 #include <togo/core/log/log.hpp>
@@ -51,6 +52,8 @@ signed main(signed argc, char* argv[]) {
 	lua_pop(L, 2);
 	lua_close(L);
 
+	// Pooled object nodes belong to the default allocator
+	object::pool_trim();
 	memory::shutdown();
 	return ec;
 }
@@ -72,21 +72,23 @@ function quanta.make_library(name, configs, env)
 			"src/**.cpp",
 		}
 
-	if os.isfile("test/build.lua") then
-		precore.push_wd("test")
-		local prev_solution = solution()
-		precore.make_solution(
-			"lib_" .. name .. "_test",
-			{"debug", "release"},
-			{"x64", "x32"},
-			nil,
-			{
-				"precore.generic",
-			}
-		)
-		precore.import(".")
-		precore.pop_wd()
-		solution(prev_solution.name)
+	for _, group in pairs({"test", "bench"}) do
+		if os.isfile(group .. "/build.lua") then
+			precore.push_wd(group)
+			local prev_solution = solution()
+			precore.make_solution(
+				"lib_" .. name .. "_" .. group,
+				{"debug", "release"},
+				{"x64", "x32"},
+				nil,
+				{
+					"precore.generic",
+				}
+			)
+			precore.import(".")
+			precore.pop_wd()
+			solution(prev_solution.name)
+		end
 	end
 end
 
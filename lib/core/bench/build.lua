@@ -0,0 +1,13 @@
+
+local S, G, R = precore.helpers()
+
+local configs = {
+	"quanta.lib.core.dep",
+}
+
+togo.make_tests("object", {
+	["general"] = {nil, configs},
+	["io_text"] = {nil, configs},
+	["memory"] = {nil, configs},
+	["number"] = {nil, configs},
+})
@@ -0,0 +1,229 @@
+
+#pragma once
+
+#include <togo/core/types.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/log/log.hpp>
+#include <togo/core/collection/array.hpp>
+#include <togo/core/string/types.hpp>
+#include <togo/core/system/system.hpp>
+#include <togo/core/io/io.hpp>
+#include <togo/core/io/memory_stream.hpp>
+
+#include <quanta/core/object/object.hpp>
+
+#include <cstdarg>
+#include <cstdio>
+
+using namespace quanta;
+
+/// Corpus size.
+struct BenchSize {
+	char const* name;
+	unsigned num_entries;
+};
+
+static BenchSize const bench_sizes[]{
+	{"small", 1000},
+	{"medium", 10000},
+	{"large", 100000},
+};
+
+/// Deterministic random numbers (PCG32).
+struct BenchRandom {
+	u64 state;
+
+	u32 next() {
+		u64 const prev = state;
+		state = prev * 6364136223846793005ull + 1442695040888963407ull;
+		u32 const x = static_cast<u32>(((prev >> 18u) ^ prev) >> 27u);
+		u32 const r = static_cast<u32>(prev >> 59u);
+		return (x >> r) | (x << ((32 - r) & 31));
+	}
+
+	/// [0, n).
+	unsigned range(unsigned const n) {
+		return next() % n;
+	}
+};
+
+inline void bench_write(MemoryStream& stream, char const* format, ...) {
+	char text[1024];
+	va_list args;
+	va_start(args, format);
+	signed const size = std::vsnprintf(text, sizeof(text), format, args);
+	va_end(args);
+	io::write(stream, text, static_cast<unsigned>(min(size, static_cast<signed>(sizeof(text)) - 1)));
+}
+
+/// Generate a tracker-like document with num_entries top-level entries.
+///
+/// The same seed always produces the same document.
+inline void bench_make_corpus(MemoryStream& stream, unsigned const num_entries, u64 const seed = 1) {
+	static char const* const s_actions[]{
+		"Work", "Study", "Eat", "Sleep", "Travel", "Exercise", "Read", "Shop",
+	};
+	static char const* const s_tags[]{
+		"primary", "uncertain", "home", "away", "weekend", "late",
+	};
+	static char const* const s_units[]{"g", "kg", "mL", "L", "km", "min"};
+	static char const* const s_currencies[]{"usd", "eur", "cad", "yen"};
+
+	BenchRandom r{seed};
+	stream.clear();
+	bench_write(stream, "\\\\ generated benchmark corpus (%u entries)\n", num_entries);
+	for (unsigned i = 0; i < num_entries; ++i) {
+		unsigned const day = 1 + r.range(28);
+		unsigned const h = r.range(23);
+		unsigned const m = r.range(60);
+		bench_write(
+			stream,
+			"e%u = Entry:%s{\n"
+			"\trange = 2016-01-%02uT%02u:%02u:%02uZ - 2016-01-%02uT%02u:%02u:00Z\n",
+			i, s_tags[r.range(6)],
+			day, h, m, r.range(60),
+			day, h + 1, r.range(60)
+		);
+		unsigned const num_actions = 1 + r.range(4);
+		bench_write(stream, "\tactions = {\n");
+		for (unsigned a = 0; a < num_actions; ++a) {
+			switch (r.range(4)) {
+			case 0:
+				bench_write(
+					stream, "\t\t%s{\"note %u\", n = %u}\n",
+					s_actions[r.range(8)], r.next(), r.range(1000)
+				);
+				break;
+
+			case 1:
+				bench_write(
+					stream, "\t\t%s:%s[%u.%02u%s]\n",
+					s_actions[r.range(8)], s_tags[r.range(6)],
+					r.range(1000), r.range(100), s_units[r.range(6)]
+				);
+				break;
+
+			case 2:
+				bench_write(
+					stream, "\t\tcost = \xC2\xA4%u.%02u%s, qty = %u\n",
+					r.range(500), r.range(100), s_currencies[r.range(4)], 1 + r.range(12)
+				);
+				break;
+
+			case 3:
+				bench_write(
+					stream, "\t\t%s{at = %02u:%02u, d = {x = %d, y = %u.%03ue%d, z = 1 + 2 * x}}\n",
+					s_actions[r.range(8)], r.range(24), r.range(60),
+					static_cast<signed>(r.range(20001)) - 10000, r.range(100), r.range(1000),
+					static_cast<signed>(r.range(7)) - 3
+				);
+				break;
+			}
+		}
+		bench_write(stream, "\t}\n");
+		if (r.range(3) == 0) {
+			bench_write(
+				stream, "\tdesc = ```%u\nfree-form text %u```\n", r.next(), r.next()
+			);
+		}
+		bench_write(stream, "}\n");
+	}
+}
+
+/// Stream data as a string.
+inline StringRef bench_stream_ref(MemoryStream& stream) {
+	return StringRef{
+		reinterpret_cast<char const*>(array::begin(stream.data())),
+		static_cast<unsigned>(stream.size())
+	};
+}
+
+/// Number of objects in a tree (excluding obj).
+inline u64 bench_count_objects(Object const& obj) {
+	u64 count = 0;
+	if (object::is_type(obj, ObjectValueType::expression)) {
+		for (auto const& sub : object::expression(obj)) {
+			count += 1 + bench_count_objects(sub);
+		}
+	}
+	for (auto const& sub : object::tags(obj)) {
+		count += 1 + bench_count_objects(sub);
+	}
+	for (auto const& sub : object::children(obj)) {
+		count += 1 + bench_count_objects(sub);
+	}
+	if (object::has_quantity(obj)) {
+		count += 1 + bench_count_objects(*object::quantity(obj));
+	}
+	return count;
+}
+
+/// Number of objects in a frozen tree (excluding obj).
+inline u64 bench_count_objects(FrozenObject const& obj) {
+	u64 count = 0;
+	if (object::is_type(obj, ObjectValueType::expression)) {
+		for (auto const& sub : object::expression(obj)) {
+			count += 1 + bench_count_objects(sub);
+		}
+	}
+	for (auto const& sub : object::tags(obj)) {
+		count += 1 + bench_count_objects(sub);
+	}
+	for (auto const& sub : object::children(obj)) {
+		count += 1 + bench_count_objects(sub);
+	}
+	if (object::has_quantity(obj)) {
+		count += 1 + bench_count_objects(*object::quantity(obj));
+	}
+	return count;
+}
+
+/// Best time of f() in seconds, calling setup() untimed before each run.
+///
+/// f is run at least min_runs times and for at least min_time seconds of
+/// measured time.
+template<class S, class F>
+inline f64 bench_time_setup(S setup, F f, unsigned const min_runs = 3, f64 const min_time = 0.5) {
+	f64 best = 0.0;
+	f64 total = 0.0;
+	for (unsigned run = 0; run < min_runs || total < min_time; ++run) {
+		setup();
+		f64 const start = system::time_monotonic();
+		f();
+		f64 const duration = system::time_monotonic() - start;
+		if (run == 0 || duration < best) {
+			best = duration;
+		}
+		total += duration;
+	}
+	return best;
+}
+
+/// Best time of f() in seconds.
+///
+/// f is run at least min_runs times and for at least min_time seconds.
+template<class F>
+inline f64 bench_time(F f, unsigned const min_runs = 3, f64 const min_time = 0.5) {
+	return bench_time_setup([]() {}, f, min_runs, min_time);
+}
+
+/// Print a result line.
+///
+/// bytes and objects may be 0 if they do not apply.
+inline void bench_report(
+	char const* const name,
+	BenchSize const& size,
+	f64 const seconds,
+	u64 const bytes,
+	u64 const objects
+) {
+	std::printf("%-32s %-6s %10.3f ms", name, size.name, seconds * 1000.0);
+	if (bytes > 0) {
+		std::printf(" %10.2f MB/s", static_cast<f64>(bytes) / seconds / (1024.0 * 1024.0));
+	}
+	if (objects > 0) {
+		std::printf(" %14.0f objects/s", static_cast<f64>(objects) / seconds);
+	}
+	std::printf("\n");
+	std::fflush(stdout);
+}
@@ -0,0 +1,128 @@
+#include <togo/core/error/assert.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/memory/memory.hpp>
+#include <togo/core/collection/array.hpp>
+#include <togo/core/io/memory_stream.hpp>
+
+#include <quanta/core/object/object.hpp>
+
+#include <togo/support/test.hpp>
+
+#include "../common.hpp"
+
+#include <cstdio>
+
+void bench_general(BenchSize const& size) {
+	MemoryStream corpus{memory::default_allocator(), size.num_entries * 256};
+	bench_make_corpus(corpus, size.num_entries);
+	StringRef const text = bench_stream_ref(corpus);
+
+	Object root;
+	TOGO_ASSERTE(object::read_text_string(root, text));
+	u64 const num_objects = bench_count_objects(root);
+	unsigned const num_children = array::size(object::children(root));
+
+	f64 seconds;
+	{
+	Object copy;
+	seconds = bench_time([&]() {
+		object::copy(copy, root);
+	});
+	bench_report("copy", size, seconds, 0, num_objects);
+	}
+
+	{
+	// Copy, then change one entry; only the root level is copied
+	Object copy;
+	seconds = bench_time([&]() {
+		object::copy_shared(copy, root);
+		object::set_integer(object::children(copy)[0], 1);
+	});
+	bench_report("copy_shared + change", size, seconds, 0, num_objects);
+	object::clear(copy);
+	}
+
+	// Look up a spread of entries by name; with linear search this is
+	// quadratic in the number of children, so the count is bounded
+	unsigned const num_lookups = min(num_children, 1000u);
+	unsigned const stride = max(num_children / max(num_lookups, 1u), 1u);
+	char name[32];
+	seconds = bench_time([&]() {
+		for (unsigned i = 0; i < num_lookups; ++i) {
+			signed const length = std::snprintf(name, sizeof(name), "e%u", i * stride);
+			TOGO_ASSERTE(object::find_child(root, StringRef{name, static_cast<unsigned>(length)}));
+		}
+	});
+	bench_report("find_child (by name)", size, seconds, 0, num_lookups);
+
+	// Entries carry one of several tags, so about a sixth of these hit
+	unsigned num_found = 0;
+	seconds = bench_time([&]() {
+		num_found = 0;
+		for (auto const& entry : object::children(root)) {
+			num_found += object::find_tag(entry, "primary") != nullptr;
+		}
+	});
+	TOGO_ASSERTE(num_found > 0);
+	bench_report("find_tag", size, seconds, 0, num_children);
+
+	u64 count = 0;
+	seconds = bench_time([&]() {
+		count = bench_count_objects(root);
+	});
+	TOGO_ASSERTE(count == num_objects);
+	bench_report("walk", size, seconds, 0, num_objects);
+
+	{
+	FrozenObjectDocument frozen;
+	seconds = bench_time([&]() {
+		object::freeze(frozen, root);
+	});
+	bench_report("freeze", size, seconds, object::size(frozen), num_objects);
+
+	FrozenObject const& frozen_root = object::root(frozen);
+	seconds = bench_time([&]() {
+		count = bench_count_objects(frozen_root);
+	});
+	TOGO_ASSERTE(count == num_objects);
+	bench_report("walk (frozen)", size, seconds, 0, num_objects);
+
+	seconds = bench_time([&]() {
+		num_found = 0;
+		for (auto const& entry : object::children(frozen_root)) {
+			num_found += object::find_tag(entry, "primary") != nullptr;
+		}
+	});
+	TOGO_ASSERTE(num_found > 0);
+	bench_report("find_tag (frozen)", size, seconds, 0, num_children);
+	}
+
+	// Clearing consumes the tree, so only the clear itself is timed. The
+	// re-parse dominates a run, so stick to the minimum number of runs
+	ObjectParserInfo pinfo;
+	seconds = bench_time_setup([&]() {
+		TOGO_ASSERTE(object::read_text_string(root, text, pinfo));
+	}, [&]() {
+		object::clear(root);
+	}, 3, 0.0);
+	bench_report("clear", size, seconds, 0, num_objects);
+
+	{
+	ObjectDocument doc;
+	seconds = bench_time_setup([&]() {
+		TOGO_ASSERTE(object::read_text_string(doc, text, pinfo));
+	}, [&]() {
+		object::clear(doc);
+	}, 3, 0.0);
+	bench_report("clear (document)", size, seconds, 0, num_objects);
+	}
+}
+
+signed main() {
+	memory_init();
+
+	for (auto const& size : bench_sizes) {
+		bench_general(size);
+	}
+	return 0;
+}
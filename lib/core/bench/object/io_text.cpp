@@ -0,0 +1,129 @@
+#include <togo/core/error/assert.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/memory/memory.hpp>
+#include <togo/core/collection/array.hpp>
+#include <togo/core/io/io.hpp>
+#include <togo/core/io/memory_stream.hpp>
+#include <togo/core/io/file_stream.hpp>
+
+#include <quanta/core/object/object.hpp>
+
+#include <togo/support/test.hpp>
+
+#include "../common.hpp"
+
+#include <cstdio>
+
+void bench_io_text(BenchSize const& size) {
+	MemoryStream corpus{memory::default_allocator(), size.num_entries * 256};
+	bench_make_corpus(corpus, size.num_entries);
+	StringRef const text = bench_stream_ref(corpus);
+
+	Object root;
+	ObjectParserInfo pinfo;
+	TOGO_ASSERTE(object::read_text_string(root, text, pinfo));
+	u64 const num_objects = bench_count_objects(root);
+
+	f64 seconds;
+	seconds = bench_time([&]() {
+		TOGO_ASSERTE(object::read_text_string(root, text, pinfo));
+	});
+	bench_report("read_text_string", size, seconds, text.size, num_objects);
+
+	{
+	ObjectDocument doc;
+	seconds = bench_time([&]() {
+		TOGO_ASSERTE(object::read_text_string(doc, text, pinfo));
+	});
+	bench_report("read_text_string (document)", size, seconds, text.size, num_objects);
+	}
+
+	seconds = bench_time([&]() {
+		TOGO_ASSERTE(object::read_text_string_parallel(root, text, pinfo));
+	});
+	bench_report("read_text_string_parallel", size, seconds, text.size, num_objects);
+
+	{
+	MemoryReader stream{text};
+	seconds = bench_time([&]() {
+		io::seek_to(stream, 0);
+		TOGO_ASSERTE(object::read_text(root, stream, pinfo));
+	});
+	bench_report("read_text (stream)", size, seconds, text.size, num_objects);
+	}
+
+	StringRef const path{"quanta_bench_corpus.q"};
+	{
+	FileWriter stream{};
+	TOGO_ASSERTE(stream.open(path, false));
+	TOGO_ASSERTE(io::write(stream, text.data, text.size));
+	stream.close();
+	}
+	seconds = bench_time([&]() {
+		TOGO_ASSERTE(object::read_text_file(root, path));
+	});
+	bench_report("read_text_file", size, seconds, text.size, num_objects);
+	std::remove(path.data);
+
+	MemoryStream out{memory::default_allocator(), text.size};
+	seconds = bench_time([&]() {
+		out.clear();
+		TOGO_ASSERTE(object::write_text(root, out));
+	});
+	bench_report("write_text", size, seconds, out.size(), num_objects);
+
+	seconds = bench_time([&]() {
+		out.clear();
+		TOGO_ASSERTE(object::write_text_parallel(root, out));
+	});
+	bench_report("write_text_parallel", size, seconds, out.size(), num_objects);
+
+	seconds = bench_time([&]() {
+		out.clear();
+		TOGO_ASSERTE(object::write_text(root, out, false, ObjectTextFormat::compact));
+	});
+	bench_report("write_text (compact)", size, seconds, out.size(), num_objects);
+
+	{
+	StringRef const compact_text = bench_stream_ref(out);
+	seconds = bench_time([&]() {
+		TOGO_ASSERTE(object::read_text_string(root, compact_text, pinfo));
+	});
+	bench_report("read_text_string (compact)", size, seconds, compact_text.size, num_objects);
+	}
+
+	seconds = bench_time([&]() {
+		out.clear();
+		TOGO_ASSERTE(object::write_binary(root, out));
+	});
+	bench_report("write_binary", size, seconds, out.size(), num_objects);
+
+	{
+	MemoryReader stream{bench_stream_ref(out)};
+	seconds = bench_time([&]() {
+		io::seek_to(stream, 0);
+		TOGO_ASSERTE(object::read_binary(root, stream));
+	});
+	bench_report("read_binary", size, seconds, out.size(), num_objects);
+	}
+
+	StringRef const binary_path{"quanta_bench_corpus.qbin"};
+	TOGO_ASSERTE(object::write_binary_file(root, binary_path));
+	{
+	FrozenObjectDocument doc;
+	seconds = bench_time([&]() {
+		TOGO_ASSERTE(object::read_binary_file(doc, binary_path));
+	});
+	bench_report("read_binary_file (frozen)", size, seconds, out.size(), num_objects);
+	}
+	std::remove(binary_path.data);
+}
+
+signed main() {
+	memory_init();
+
+	for (auto const& size : bench_sizes) {
+		bench_io_text(size);
+	}
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include <togo/core/error/assert.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/memory/memory.hpp>
+#include <togo/core/collection/array.hpp>
+#include <togo/core/io/memory_stream.hpp>
+
+#include <quanta/core/object/object.hpp>
+
+#include <togo/support/test.hpp>
+
+#include "../common.hpp"
+
+#include <cstdio>
+
+// Tracks live bytes as requested by the caller (no allocator overhead)
+class CountingAllocator : public Allocator {
+public:
+	struct Header {
+		u64 size;
+		u64 padding;
+	};
+
+	Allocator& _backing;
+	u32 _num_allocations;
+	u64 _total_size;
+
+	CountingAllocator(Allocator& backing)
+		: _backing(backing)
+		, _num_allocations(0)
+		, _total_size(0)
+	{}
+
+	u32 num_allocations() const override {
+		return _num_allocations;
+	}
+
+	u32 total_size() const override {
+		return static_cast<u32>(_total_size);
+	}
+
+	void* allocate(u32 size, u32 align) override {
+		TOGO_ASSERTE(align <= sizeof(Header));
+		auto header = static_cast<Header*>(_backing.allocate(sizeof(Header) + size, sizeof(Header)));
+		header->size = size;
+		++_num_allocations;
+		_total_size += size;
+		return header + 1;
+	}
+
+	void deallocate(void* p) override {
+		if (!p) {
+			return;
+		}
+		auto header = static_cast<Header*>(p) - 1;
+		--_num_allocations;
+		_total_size -= header->size;
+		_backing.deallocate(header);
+	}
+};
+
+void bench_memory(BenchSize const& size) {
+	MemoryStream corpus{memory::default_allocator(), size.num_entries * 256};
+	bench_make_corpus(corpus, size.num_entries);
+	StringRef const text = bench_stream_ref(corpus);
+	ObjectParserInfo pinfo;
+
+	CountingAllocator counter{memory::default_allocator()};
+	{
+	Object root{counter};
+	TOGO_ASSERTE(object::read_text_string(root, text, pinfo));
+	u64 const num_objects = bench_count_objects(root);
+	std::printf(
+		"%-12s %-6s %8lu objects %10.1f bytes/object %6.2f allocations/object\n",
+		"heap", size.name,
+		static_cast<unsigned long>(num_objects),
+		static_cast<f64>(counter._total_size + sizeof(Object)) / static_cast<f64>(num_objects),
+		static_cast<f64>(counter._num_allocations) / static_cast<f64>(num_objects)
+	);
+	}
+	TOGO_ASSERTE(counter._num_allocations == 0 && counter._total_size == 0);
+
+	{
+	ObjectDocument doc{counter};
+	TOGO_ASSERTE(object::read_text_string(doc, text, pinfo));
+	u64 const num_objects = bench_count_objects(doc.root);
+	std::printf(
+		"%-12s %-6s %8lu objects %10.1f bytes/object %6.2f blocks/object\n",
+		"document", size.name,
+		static_cast<unsigned long>(num_objects),
+		static_cast<f64>(counter._total_size + sizeof(Object)) / static_cast<f64>(num_objects),
+		static_cast<f64>(counter._num_allocations) / static_cast<f64>(num_objects)
+	);
+	}
+}
+
+signed main() {
+	memory_init();
+
+	std::printf("sizeof(Object) = %u\n", static_cast<unsigned>(sizeof(Object)));
+	for (auto const& size : bench_sizes) {
+		bench_memory(size);
+	}
+	return 0;
+}
@@ -0,0 +1,184 @@
+#include <togo/core/error/assert.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/memory/memory.hpp>
+#include <togo/core/collection/array.hpp>
+#include <togo/core/io/memory_stream.hpp>
+
+#include <quanta/core/object/object.hpp>
+#include <quanta/core/object/io/common.ipp>
+
+#include <togo/support/test.hpp>
+
+#include "../common.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+// Numerals are stored back-to-back, separated by NUL so that the strtod
+// path can parse in-place the way the parser buffer used to
+struct NumberSet {
+	Array<char> data;
+	Array<unsigned> offsets;
+	unsigned num_bytes;
+
+	NumberSet()
+		: data(memory::default_allocator())
+		, offsets(memory::default_allocator())
+		, num_bytes(0)
+	{}
+};
+
+static void make_numbers(NumberSet& set, unsigned const count, bool const decimal) {
+	BenchRandom r{7};
+	char text[64];
+	array::clear(set.data);
+	array::clear(set.offsets);
+	set.num_bytes = 0;
+	for (unsigned i = 0; i < count; ++i) {
+		signed length;
+		if (decimal) {
+			length = std::snprintf(
+				text, sizeof(text), "%s%u.%u",
+				r.range(4) == 0 ? "-" : "",
+				r.range(100000), r.next()
+			);
+		} else {
+			length = std::snprintf(
+				text, sizeof(text), "%s%u",
+				r.range(4) == 0 ? "-" : "",
+				r.next() >> r.range(32)
+			);
+		}
+		array::push_back(set.offsets, array::size(set.data));
+		for (signed c = 0; c < length; ++c) {
+			array::push_back(set.data, text[c]);
+		}
+		array::push_back(set.data, '\0');
+		set.num_bytes += static_cast<unsigned>(length);
+	}
+}
+
+// Previous path: buffer the numeral, then convert it with the C library
+static f64 convert_strtod(NumberSet const& set) {
+	f64 sum = 0.0;
+	for (unsigned offset : set.offsets) {
+		sum += std::strtod(array::begin(set.data) + offset, nullptr);
+	}
+	return sum;
+}
+
+static s64 convert_strtoll(NumberSet const& set) {
+	s64 sum = 0;
+	for (unsigned offset : set.offsets) {
+		sum += object::parse_s64(array::begin(set.data) + offset, 10);
+	}
+	return sum;
+}
+
+// Current path: accumulate digits while scanning, then convert directly
+static f64 convert_scan_decimal(NumberSet const& set) {
+	f64 sum = 0.0;
+	for (unsigned offset : set.offsets) {
+		char const* const numeral = array::begin(set.data) + offset;
+		char const* it = numeral;
+		bool const negative = *it == '-';
+		it += negative;
+		u64 mantissa = 0;
+		unsigned num_digits = 0;
+		s32 point_exponent = 0;
+		bool point = false;
+		for (; *it; ++it) {
+			if (*it == '.') {
+				point = true;
+				continue;
+			}
+			unsigned const digit = static_cast<unsigned>(*it - '0');
+			num_digits += mantissa != 0 || digit != 0;
+			if (num_digits <= 19) {
+				mantissa = mantissa * 10 + digit;
+				point_exponent -= point;
+			}
+		}
+		f64 value;
+		if (num_digits > 19 || !object::parse_decimal_exact(mantissa, point_exponent, value)) {
+			value = std::strtod(numeral, nullptr);
+		} else if (negative) {
+			value = -value;
+		}
+		sum += value;
+	}
+	return sum;
+}
+
+static s64 convert_scan_integer(NumberSet const& set) {
+	s64 sum = 0;
+	for (unsigned offset : set.offsets) {
+		char const* it = array::begin(set.data) + offset;
+		bool const negative = *it == '-';
+		it += negative;
+		u64 mantissa = 0;
+		for (; *it; ++it) {
+			mantissa = mantissa * 10 + static_cast<unsigned>(*it - '0');
+		}
+		s64 const value = static_cast<s64>(mantissa);
+		sum += negative ? -value : value;
+	}
+	return sum;
+}
+
+// Whole-parser throughput on a document of number values
+static void bench_read(NumberSet const& set, BenchSize const& size, char const* const name) {
+	MemoryStream stream{memory::default_allocator(), set.num_bytes * 2};
+	for (unsigned offset : set.offsets) {
+		bench_write(stream, "%s\n", array::begin(set.data) + offset);
+	}
+	StringRef const text = bench_stream_ref(stream);
+
+	Object root;
+	ObjectParserInfo pinfo;
+	f64 const seconds = bench_time([&]() {
+		TOGO_ASSERTE(object::read_text_string(root, text, pinfo));
+	});
+	bench_report(name, size, seconds, text.size, array::size(set.offsets));
+}
+
+void bench_number(BenchSize const& size) {
+	unsigned const count = size.num_entries * 10;
+	NumberSet set;
+	f64 seconds;
+	volatile f64 sink_f64;
+	volatile s64 sink_s64;
+
+	make_numbers(set, count, true);
+	seconds = bench_time([&]() { sink_f64 = convert_strtod(set); });
+	bench_report("decimal strtod", size, seconds, set.num_bytes, count);
+	seconds = bench_time([&]() { sink_f64 = convert_scan_decimal(set); });
+	bench_report("decimal scan", size, seconds, set.num_bytes, count);
+	{
+	f64 const a = convert_strtod(set);
+	f64 const b = convert_scan_decimal(set);
+	TOGO_ASSERTE(std::memcmp(&a, &b, sizeof(f64)) == 0);
+	}
+	bench_read(set, size, "decimal read_text_string");
+
+	make_numbers(set, count, false);
+	seconds = bench_time([&]() { sink_s64 = convert_strtoll(set); });
+	bench_report("integer strtoll", size, seconds, set.num_bytes, count);
+	seconds = bench_time([&]() { sink_s64 = convert_scan_integer(set); });
+	bench_report("integer scan", size, seconds, set.num_bytes, count);
+	TOGO_ASSERTE(convert_strtoll(set) == convert_scan_integer(set));
+	bench_read(set, size, "integer read_text_string");
+
+	(void)sink_f64;
+	(void)sink_s64;
+}
+
+signed main() {
+	memory_init();
+
+	for (auto const& size : bench_sizes) {
+		bench_number(size);
+	}
+	return 0;
+}
@@ -35,6 +35,95 @@ static signed const days_before[]{
 	31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30 + 31, // 0001-01 - 0002-01
 };
 
+// Batch dates use the Neri-Schneider computational calendar: years start on
+// March 1 so the leap day is the last day of the year, and day 0 is
+// 0000-03-01 less DATES_ERAS 400-year cycles to keep day numbers unsigned.
+enum : s64 {
+	DATES_ERAS = 3670,
+	// 4 * n + 3 must fit in 32 bits
+	DATES_DAYS_LIMIT = s64{1} << 30,
+	DATES_ABSOLUTE_TO_SHIFTED
+		= QUANTA_TO_ABSOLUTE / SECS_PER_DAY
+		- (31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30 + 31) // 0000-03 - 0001-01
+		- DATES_ERAS * DAYS_PER_400_YEARS
+	,
+};
+
+enum : unsigned {
+	DATES_BATCH_SIZE = 256,
+};
+
+static void dates_impl(
+	ArrayRef<Time const> const& times,
+	bool const utc,
+	s32* const year,
+	s32* const month,
+	s32* const day,
+	s32* const year_day
+) {
+	u64 const to_shifted = static_cast<u64>(DATES_ABSOLUTE_TO_SHIFTED);
+	u64 shifted[DATES_BATCH_SIZE];
+	unsigned const num = times.size();
+	for (unsigned base = 0; base < num; base += DATES_BATCH_SIZE) {
+		Time const* const t = begin(times) + base;
+		unsigned const count = min(num - base, unsigned{DATES_BATCH_SIZE});
+		if (utc) {
+			for (unsigned i = 0; i < count; ++i) {
+				shifted[i] = internal::abs_utc(t[i]) / SECS_PER_DAY - to_shifted;
+			}
+		} else {
+			for (unsigned i = 0; i < count; ++i) {
+				shifted[i] = internal::abs(t[i]) / SECS_PER_DAY - to_shifted;
+			}
+		}
+
+		// NB: divisors are constant (multiply-shift) and selects are branchless,
+		// so this loop vectorizes
+		s32* const c_year = year + base;
+		s32* const c_month = month + base;
+		s32* const c_day = day + base;
+		s32* const c_year_day = year_day + base;
+		for (unsigned i = 0; i < count; ++i) {
+			// century and day of century
+			u32 const n1 = 4 * static_cast<u32>(shifted[i]) + 3;
+			u32 const century = n1 / 146097u;
+			u32 const n2 = (n1 % 146097u) | 3;
+
+			// year of century and day of year
+			u64 const p2 = u64{2939745} * n2;
+			u32 const y = 100 * century + static_cast<u32>(p2 >> 32);
+			u32 const n_y = static_cast<u32>(p2) / 2939745 / 4;
+
+			// month and day from day of year
+			u32 const n3 = 2141 * n_y + 197913;
+			u32 const m = n3 >> 16;
+			u32 const d = (n3 & 0xFFFF) / 2141;
+
+			// January and February belong to the next calendar year
+			u32 const jan_feb = n_y >= 306;
+			// y % 25 == 0 ? y % 16 == 0 : y % 4 == 0
+			u32 const leap = (y & (y * 3264175145u <= 171798691u ? 15 : 3)) == 0;
+			c_year[i] = static_cast<s32>(y + jan_feb) - static_cast<s32>(DATES_ERAS * 400);
+			c_month[i] = static_cast<s32>(jan_feb ? m - 12 : m);
+			c_day[i] = static_cast<s32>(d + 1);
+			c_year_day[i] = static_cast<s32>(jan_feb ? n_y - 305 : n_y + 60 + leap);
+		}
+
+		// out of range of the shifted calendar
+		for (unsigned i = 0; i < count; ++i) {
+			if (shifted[i] >= static_cast<u64>(DATES_DAYS_LIMIT)) {
+				Date const date = gregorian::date_internal(
+					utc ? internal::abs_utc(t[i]) : internal::abs(t[i]), true
+				);
+				c_year[i] = date.year;
+				c_month[i] = date.month;
+				c_day[i] = date.day;
+				c_year_day[i] = date.year_day;
+			}
+		}
+	}
+}
+
 } // anonymous namespace
 
 IGEN_PRIVATE
@@ -105,6 +194,33 @@ Date gregorian::date_internal(u64 abs, bool const full) {
 	return date;
 }
 
+/// Gregorian calendar dates of time points.
+///
+/// year, month, day, and year_day must have room for times.size() values.
+/// This is faster than calling date() for each time point.
+void gregorian::dates(
+	ArrayRef<Time const> const& times,
+	s32* year,
+	s32* month,
+	s32* day,
+	s32* year_day
+) {
+	dates_impl(times, false, year, month, day, year_day);
+}
+
+/// Gregorian calendar dates of time points (UTC).
+///
+/// year, month, day, and year_day must have room for times.size() values.
+void gregorian::dates_utc(
+	ArrayRef<Time const> const& times,
+	s32* year,
+	s32* month,
+	s32* day,
+	s32* year_day
+) {
+	dates_impl(times, true, year, month, day, year_day);
+}
+
 /// Set the Gregorian calendar date (UTC).
 void gregorian::set_utc(Time& t, signed year, signed month, signed day) {
 	--month;
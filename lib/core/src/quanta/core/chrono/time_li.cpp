@@ -421,6 +421,49 @@ TOGO_LI_FUNC_DEF(is_leap_year) {
 	return 1;
 }
 
+// Convert an array of time points to year, month, day, and year_day arrays
+static signed li_dates_impl(lua_State* L, bool const utc) {
+	enum : unsigned { BATCH_SIZE = 256 };
+	Time times[BATCH_SIZE];
+	s32 columns[4][BATCH_SIZE];
+
+	luaL_checktype(L, 1, LUA_TTABLE);
+	lua_settop(L, 1);
+	unsigned const num = static_cast<unsigned>(lua_rawlen(L, 1));
+	for (unsigned c = 0; c < 4; ++c) {
+		lua_createtable(L, signed_cast(num), 0);
+	}
+	for (unsigned base = 0; base < num; base += BATCH_SIZE) {
+		unsigned const count = min(num - base, unsigned{BATCH_SIZE});
+		for (unsigned i = 0; i < count; ++i) {
+			lua_rawgeti(L, 1, signed_cast(base + i + 1));
+			times[i] = *lua::get_pointer<Time const>(L, -1);
+			lua_pop(L, 1);
+		}
+		auto const batch = array_ref(count, static_cast<Time const*>(times));
+		if (utc) {
+			time::gregorian::dates_utc(batch, columns[0], columns[1], columns[2], columns[3]);
+		} else {
+			time::gregorian::dates(batch, columns[0], columns[1], columns[2], columns[3]);
+		}
+		for (unsigned c = 0; c < 4; ++c) {
+			for (unsigned i = 0; i < count; ++i) {
+				lua::push_value(L, columns[c][i]);
+				lua_rawseti(L, 2 + signed_cast(c), signed_cast(base + i + 1));
+			}
+		}
+	}
+	return 4;
+}
+
+TOGO_LI_FUNC_DEF(dates_utc) {
+	return li_dates_impl(L, true);
+}
+
+TOGO_LI_FUNC_DEF(dates) {
+	return li_dates_impl(L, false);
+}
+
 TOGO_LI_FUNC_DEF(set_utc) {
 	auto t = lua::get_pointer<Time>(L, 1);
 	auto year = lua::get_integer(L, 2);
@@ -466,6 +509,9 @@ static LuaModuleFunctionArray const li_funcs{
 	TOGO_LI_FUNC_REF(time::gregorian, day)
 	TOGO_LI_FUNC_REF(time::gregorian, is_leap_year)
 
+	TOGO_LI_FUNC_REF(time::gregorian, dates_utc)
+	TOGO_LI_FUNC_REF(time::gregorian, dates)
+
 	TOGO_LI_FUNC_REF(time::gregorian, set_utc)
 	TOGO_LI_FUNC_REF(time::gregorian, set)
 };
@@ -2,6 +2,7 @@ u8R""__RAW_STRING__(
 
 local U = require "togo.utility"
 local O = require "Quanta.Object"
+local FO = require "Quanta.FrozenObject"
 local Vessel = require "Quanta.Vessel"
 local Match = require "Quanta.Match"
 local Measurement = require "Quanta.Measurement"
@@ -427,8 +428,8 @@ function M.specialize_source_head(source_body, get_lead)
 	return Match.Pattern{
 		vtype = O.Type.integer,
 		children = source_body,
-		acceptor = function(_, p, obj)
-			local i = O.integer(obj)
+		acceptor = function(context, p, obj)
+			local i = context.O.integer(obj)
 			if i < 1 then
 				return Match.Error("source %2d index must be greater than 0", i)
 			elseif get_lead(p).sources[i] then
@@ -554,8 +555,8 @@ Match.Pattern{
 	name = "aliases",
 	children = {Match.Pattern{
 		children = true,
-		acceptor = function(_, cat, obj)
-			if O.num_children(obj) < 2 then
+		acceptor = function(context, cat, obj)
+			if context.O.num_children(obj) < 2 then
 				return Match.Error("alias definition must have at least one source")
 			end
 			-- TODO
@@ -577,8 +578,8 @@ Match.Pattern{
 	vtype = O.Type.identifier,
 	value = "Generic",
 	children = M.t_entity_body_generic,
-	acceptor = function(_, parent, obj)
-		return parent:add(M(O.name(obj)))
+	acceptor = function(context, parent, obj)
+		return parent:add(M(context.O.name(obj)))
 	end
 },
 })
@@ -602,8 +603,8 @@ Match.Pattern{
 	vtype = O.Type.identifier,
 	value = "GenericCategory",
 	children = M.t_category_body_generic,
-	acceptor = function(_, parent, obj)
-		return parent:add(M.Category(O.name(obj)))
+	acceptor = function(context, parent, obj)
+		return parent:add(M.Category(context.O.name(obj)))
 	end
 },
 })
@@ -612,8 +613,8 @@ M.p_include = Match.Pattern{
 	name = "include",
 	collect = {Match.Pattern{
 		vtype = O.Type.string,
-		acceptor = function(_, _, obj)
-			return O.string(obj)
+		acceptor = function(context, _, obj)
+			return context.O.string(obj)
 		end
 	}},
 	collect_post = function(context, cat, obj, collection)
@@ -624,7 +625,14 @@ M.p_include = Match.Pattern{
 			if not O.read_text_file(sub, path) then
 				return Match.Error("failed to load include file: %s", path)
 			end
-			if not context:consume_sub(M.t_root, sub, cat, path) then
+			-- Read the include through the same module as its parent;
+			-- sub_doc keeps the frozen copy alive while it is consumed
+			local sub_root, sub_doc = sub, nil
+			if context.O == FO then
+				sub_doc = FO.freeze(sub)
+				sub_root = FO.root(sub_doc)
+			end
+			if not context:consume_sub(M.t_root, sub_root, cat, path) then
 				return false
 			end
 		end
@@ -648,6 +656,7 @@ M.p_specialization = Match.Pattern{
 	tags = Match.Any,
 	children = Match.Any,
 	acceptor = function(context, parent, obj)
+		local O = context.O
 		local id = O.identifier(obj)
 		local id_hash = O.identifier_hash(obj)
 		local class = context.user.director:find_entity_class(id, id_hash)
@@ -671,8 +680,11 @@ M.t_entity_body_generic:build()
 M.t_category_body_generic:build()
 M.t_root:build()
 
-function M.read_universe(rp, name)
+-- rp is a path or a root object. object_module is the module a root object is
+-- read through: Quanta.Object (default) or Quanta.FrozenObject.
+function M.read_universe(rp, name, object_module)
 	U.type_assert(name, "string", true)
+	U.type_assert(object_module, "table", true)
 
 	local path, root
 	if U.is_type(rp, "string") then
@@ -682,13 +694,14 @@ function M.read_universe(rp, name)
 			U.log("error: failed to read root")
 			return nil
 		end
+		object_module = nil
 	else
 		U.type_assert(rp, "userdata")
 		root = rp
 	end
 
 	local universe = M.Universe(name or "universe")
-	local context = Vessel.new_match_context(nil)
+	local context = Vessel.new_match_context(nil, object_module)
 	if context:consume_sub(M.t_root, root, universe, path) then
 		return universe
 	end
@@ -61,10 +61,10 @@ M.filters.name.init = function(p, r)
 	return f
 end
 
-M.filters.name[false] 		= function(_, _, obj, p) return not O.is_named(obj) end
-M.filters.name[true] 		= function(_, _, obj, p) return O.is_named(obj) end
-M.filters.name["table"] 	= function(_, _, obj, p) return p.names[O.name(obj)] ~= nil end
-M.filters.name["string"] 	= function(_, _, obj, p) return p.name == O.name(obj) end
+M.filters.name[false] 		= function(c, _, obj, p) return not c.O.is_named(obj) end
+M.filters.name[true] 		= function(c, _, obj, p) return c.O.is_named(obj) end
+M.filters.name["table"] 	= function(c, _, obj, p) return p.names[c.O.name(obj)] ~= nil end
+M.filters.name["string"] 	= function(c, _, obj, p) return p.name == c.O.name(obj) end
 
 M.filters.value = {}
 M.filters.value.init = function(p, r)
@@ -100,12 +100,12 @@ M.filters.value.init = function(p, r)
 	end
 end
 
-M.filters.value[false] = function(_, _, obj, p)
-	return O.is_null(obj)
+M.filters.value[false] = function(context, _, obj, p)
+	return context.O.is_null(obj)
 end
 
 M.filters.value.typed = function(context, value, obj, p)
-	if O.is_type_any(obj, p.value_type_mask) then
+	if context.O.is_type_any(obj, p.value_type_mask) then
 		if p.value_func then
 			return p.value_func(context, value, obj, p)
 		else
@@ -116,7 +116,8 @@ M.filters.value.typed = function(context, value, obj, p)
 end
 
 M.filters.value.compare = {}
-M.filters.value.compare["number"] = function(_, _, obj, _, v)
+M.filters.value.compare["number"] = function(context, _, obj, _, v)
+	local O = context.O
 	if O.is_decimal(obj) then
 		return O.decimal(obj) == v
 	elseif O.is_integer(obj) then
@@ -124,17 +125,18 @@ M.filters.value.compare["number"] = function(_, _, obj, _, v)
 	end
 	return false
 end
-M.filters.value.compare["boolean"] = function(_, _, obj, _, v)
-	return O.is_boolean(obj) and O.boolean(obj) == v
+M.filters.value.compare["boolean"] = function(context, _, obj, _, v)
+	return context.O.is_boolean(obj) and context.O.boolean(obj) == v
 end
-M.filters.value.compare["string"] = function(_, _, obj, _, v)
-	return O.is_textual(obj) and O.text(obj) == v
+M.filters.value.compare["string"] = function(context, _, obj, _, v)
+	return context.O.is_textual(obj) and context.O.text(obj) == v
 end
 M.filters.value.compare["function"] = function(context, value, obj, p, v)
 	return v(context, value, obj, p)
 end
 
 M.filters.value.valued = function(context, value, obj, p)
+	local O = context.O
 	if not O.is_type_any(obj, p.value_type_mask) then
 		return false
 	elseif O.is_null(obj) then
@@ -151,9 +153,8 @@ end
 local function make_sub_filter(g, name, name_collect, alt_has_name)
 	local name_post = name_collect .. "_post"
 	local name_num = "num_" .. name
-	local has_func = O["has_" .. (alt_has_name or name)]
-	local num_func = O["num_" .. name]
-	local is_children = has_func == O.has_children
+	local has_name = "has_" .. (alt_has_name or name)
+	local is_children = name == "children"
 
 	g.init = function(p, r)
 		U.assertl(
@@ -189,9 +190,9 @@ local function make_sub_filter(g, name, name_collect, alt_has_name)
 		return g[filter_selector(rule_value)]
 	end
 
-	g[false] 	= function(_, _, obj, p) return not has_func(obj) end
-	g[true] 	= function(_, _, obj, p) return has_func(obj) end
-	g["number"]	= function(_, _, obj, p) return num_func(obj) == p[name_num] end
+	g[false] 	= function(c, _, obj, p) return not c.O[has_name](obj) end
+	g[true] 	= function(c, _, obj, p) return c.O[has_name](obj) end
+	g["number"]	= function(c, _, obj, p) return c.O[name_num](obj) == p[name_num] end
 
 	return g
 end
@@ -219,8 +220,8 @@ M.filters.quantity.init = function(p, r)
 	return M.filters.quantity[filter_selector(r.quantity)]
 end
 
-M.filters.quantity[false] 	= function(_, _, obj, p) return not O.has_quantity(obj) end
-M.filters.quantity[true] 	= function(_, _, obj, p) return O.has_quantity(obj) end
+M.filters.quantity[false] 	= function(c, _, obj, p) return not c.O.has_quantity(obj) end
+M.filters.quantity[true] 	= function(c, _, obj, p) return c.O.has_quantity(obj) end
 
 M.filters_ordered = {}
 
@@ -414,7 +415,7 @@ function M.Tree:build()
 	self.built = true
 end
 
-local function object_debug_info(obj)
+local function object_debug_info(O, obj)
 	local s = O.is_named(obj) and O.name(obj) or "<no-name>"
 	s = s .. " = "
 	if O.is_boolean(obj) then
@@ -455,6 +456,7 @@ end
 local do_pattern, do_object, do_sub
 
 do_pattern = function(context, tree, p, obj, collection, keyed)
+	local O = context.O
 	local function postamble(v)
 		if M.debug_trace then
 			context:trace_pop()
@@ -545,10 +547,11 @@ do_pattern = function(context, tree, p, obj, collection, keyed)
 end
 
 do_object = function(context, tree, keyed, patterns, obj, collection)
+	local O = context.O
 	tree:check_built()
 	if M.debug then
 		U.log("stack level: %d", #context.stack)
-		U.log("object: %s", object_debug_info(obj))
+		U.log("object: %s", object_debug_info(O, obj))
 	end
 	local r
 	local function do_list(list, keyed)
@@ -572,7 +575,7 @@ do_object = function(context, tree, keyed, patterns, obj, collection)
 	if r ~= nil then
 		return r
 	end
-	context:set_error(M.Error("no matching pattern for object: %s", object_debug_info(obj)), obj)
+	context:set_error(M.Error("no matching pattern for object: %s", object_debug_info(O, obj)), obj)
 	return false
 end
 
@@ -607,7 +610,11 @@ end
 
 M.Context = U.class(M.Context)
 
-function M.Context:__init()
+-- object_module is the module objects are read through: Quanta.Object
+-- (default) or Quanta.FrozenObject. Filters and callbacks should use
+-- context.O to read the objects they are given.
+function M.Context:__init(object_module)
+	self.O = object_module or O
 	self.stack = {}
 	self.trace_stack = {}
 	self.error = nil
@@ -616,7 +623,7 @@ end
 function M.Context:set_error(err, obj)
 	self.error = err
 	if not self.error.obj and obj then
-		self.error:set_obj(obj)
+		self.error:set_obj(obj, self.O)
 	end
 	if not self.error.path then
 		local path = self:path()
@@ -699,7 +706,7 @@ function M.Context:consume_sub(tree, obj, root, path)
 	if root ~= nil then
 		self:push(tree, root, path)
 	end
-	local r = do_sub(self, tree, tree.keyed, tree.positional, nil, obj, O.children)
+	local r = do_sub(self, tree, tree.keyed, tree.positional, nil, obj, self.O.children)
 	if root ~= nil then
 		self:pop()
 	end
@@ -713,14 +720,16 @@ function M.Error:__init(msg, ...)
 	self.msg = string.format(msg, ...)
 	self.location = U.get_trace(3)
 	self.obj = nil
+	self.object_module = nil
 	self.source_line = 0
 	self.path = nil
 end
 
-function M.Error:set_obj(obj)
+function M.Error:set_obj(obj, object_module)
 	U.type_assert(obj, "userdata")
 	self.obj = obj
-	self.source_line = O.source_line(self.obj)
+	self.object_module = object_module or O
+	self.source_line = self.object_module.source_line(self.obj)
 end
 
 function M.Error:set_path(path)
@@ -733,11 +742,13 @@ function M.Error:to_string()
 	if self.path then
 		str = str .. string.format("\nin file: %s\n", self.path)
 	end
-	if self.obj then
+	if self.obj and self.object_module.write_text_string then
 		str = str ..
 			string.format("\nat object (line %d): ```\n", self.source_line) ..
-			O.write_text_string(self.obj, true) ..
+			self.object_module.write_text_string(self.obj, true) ..
 			"\n```"
+	elseif self.obj then
+		str = str .. string.format("\nat object (line %d)", self.source_line)
 	end
 	return str
 end
@@ -209,7 +209,7 @@ local function numeric_bool(v)
 	return v and 1 or 0
 end
 
-local function measurement_less(lobj, lunit, robj, runit)
+local function measurement_less(O, lobj, lunit, robj, runit)
 	if
 		lunit.quantity.translation_preference < runit.quantity.translation_preference or
 		math.abs(lunit.magnitude) > math.abs(runit.magnitude) or
@@ -257,8 +257,12 @@ function M:copy(measurement)
 	return self
 end
 
-function M:from_object(obj)
+-- object_module is the module obj is read through: Quanta.Object (default) or
+-- Quanta.FrozenObject.
+function M:from_object(obj, object_module)
 	U.type_assert(obj, "userdata")
+	U.type_assert(object_module, "table", true)
+	local O = object_module or O
 
 	if O.is_numeric(obj) then
 		local unit = M.get_unit(O.unit_hash(obj))
@@ -283,7 +287,7 @@ function M:from_object(obj)
 			U.assert(i == 1 or O.op(sub) == O.Operator.div)
 			if O.is_numeric(sub) then
 				unit = M.get_unit(O.unit_hash(sub))
-				if unit and (not best or measurement_less(best, best_unit, sub, unit)) then
+				if unit and (not best or measurement_less(O, best, best_unit, sub, unit)) then
 					best = sub
 					best_unit = unit
 					if unit.qindex == M.QuantityIndex.dimensionless then
@@ -293,7 +297,7 @@ function M:from_object(obj)
 			end
 		end
 		if best then
-			self:from_object(best)
+			self:from_object(best, O)
 			if of and of ~= best then
 				self.of = O.numeric(of)
 			end
@@ -470,7 +474,8 @@ function M.adapt_struct_list(property_name)
 	local p_element = Match.Pattern{
 		any = true,
 		acceptor = function(context, thing, obj)
-			local m = M(obj)
+			local m = M()
+			m:from_object(obj, context.O)
 			if not m:is_empty() then
 				table.insert(thing[property_name], m)
 			end
@@ -0,0 +1,19 @@
+u8R""__RAW_STRING__(
+
+local U = require "togo.utility"
+local O = require "Quanta.Object"
+local M = U.module(...)
+
+-- Same values as in Quanta.Object
+M.NAME_NULL = O.NAME_NULL
+M.VALUE_NULL = O.VALUE_NULL
+M.Type = O.Type
+M.Operator = O.Operator
+M.TimeType = O.TimeType
+
+M.hash_name = O.hash_name
+M.hash_value = O.hash_value
+
+return M
+
+)"__RAW_STRING__"
@@ -0,0 +1,245 @@
+#line 2 "quanta/core/object/document.cpp"
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+*/
+
+#include <quanta/core/config.hpp>
+#include <quanta/core/object/object.hpp>
+
+#include <togo/core/error/assert.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/memory/memory.hpp>
+
+#include <quanta/core/object/io/mapped_file.ipp>
+
+#include <new>
+#include <cstdint>
+#include <cstring>
+
+namespace quanta {
+
+namespace object {
+namespace {
+
+enum : u32 {
+	// Blocks double in size up to this
+	ARENA_MAX_BLOCK_SIZE = 64 * ObjectArena::BLOCK_SIZE,
+	// Allocations larger than this get their own block
+	ARENA_MAX_SHARED_SIZE = ObjectArena::BLOCK_SIZE / 4,
+};
+
+inline static u8* arena_block_data(ObjectArena::Block* block) {
+	return reinterpret_cast<u8*>(block + 1);
+}
+
+inline static u8* arena_align(u8* p, u32 const align) {
+	auto const value = reinterpret_cast<std::uintptr_t>(p);
+	return p + ((align - (value & (align - 1))) & (align - 1));
+}
+
+static ObjectArena::Block* arena_make_block(ObjectArena& arena, u32 const size) {
+	auto block = static_cast<ObjectArena::Block*>(arena._backing.allocate(
+		sizeof(ObjectArena::Block) + size, alignof(ObjectArena::Block)
+	));
+	block->next = nullptr;
+	block->size = size;
+	arena._total_size += size;
+	return block;
+}
+
+// Unmap the file the tree refers to, if any
+static void document_release_mapping(ObjectDocument& doc) {
+	if (doc._mapping) {
+		MappedFile file{};
+		file.data = doc._mapping;
+		file.size = doc._mapping_size;
+		object::mapped_file_close(file);
+		doc._mapping = nullptr;
+		doc._mapping_size = 0;
+	}
+}
+
+static void arena_free_block(ObjectArena& arena, ObjectArena::Block* block) {
+	arena._total_size -= block->size;
+	arena._backing.deallocate(block);
+}
+
+// Double the string pool table, or create it
+static void arena_grow_strings(ObjectArena& arena) {
+	u32 const capacity = arena._strings_capacity ? arena._strings_capacity * 2 : 256;
+	auto strings = static_cast<ObjectArena::InternedString*>(arena._backing.allocate(
+		capacity * sizeof(ObjectArena::InternedString), alignof(ObjectArena::InternedString)
+	));
+	std::memset(strings, 0, capacity * sizeof(ObjectArena::InternedString));
+	u32 const mask = capacity - 1;
+	for (u32 i = 0; i < arena._strings_capacity; ++i) {
+		auto const& entry = arena._strings[i];
+		if (entry.data) {
+			u32 j = entry.hash & mask;
+			while (strings[j].data) {
+				j = (j + 1) & mask;
+			}
+			strings[j] = entry;
+		}
+	}
+	if (arena._strings) {
+		arena._backing.deallocate(arena._strings);
+	}
+	arena._strings = strings;
+	arena._strings_capacity = capacity;
+}
+
+} // anonymous namespace
+} // namespace object
+
+/// Destruct arena, releasing all blocks.
+ObjectArena::~ObjectArena() {
+	while (_head) {
+		Block* const next = _head->next;
+		object::arena_free_block(*this, _head);
+		_head = next;
+	}
+	if (_strings) {
+		_backing.deallocate(_strings);
+	}
+}
+
+/// Construct arena with backing allocator for blocks.
+ObjectArena::ObjectArena(Allocator& backing)
+	: _backing(backing)
+	, _head(nullptr)
+	, _put(nullptr)
+	, _end(nullptr)
+	, _num_allocations(0)
+	, _total_size(0)
+	, _strings(nullptr)
+	, _strings_capacity(0)
+	, _strings_size(0)
+{}
+
+u32 ObjectArena::num_allocations() const {
+	return _num_allocations;
+}
+
+u32 ObjectArena::total_size() const {
+	return _total_size;
+}
+
+void* ObjectArena::allocate(u32 const size, u32 const align) {
+	TOGO_DEBUG_ASSERTE(align > 0 && (align & (align - 1)) == 0);
+	++_num_allocations;
+	u8* p = object::arena_align(_put, align);
+	if (_head && p + size <= _end) {
+		_put = p + size;
+		return p;
+	}
+	u32 const padded_size = size + align;
+	if (padded_size > object::ARENA_MAX_SHARED_SIZE && _head) {
+		// Own block after the current one, which stays current
+		Block* const block = object::arena_make_block(*this, padded_size);
+		block->next = _head->next;
+		_head->next = block;
+		return object::arena_align(object::arena_block_data(block), align);
+	}
+	u32 block_size = _head ? min(_head->size * 2, u32{object::ARENA_MAX_BLOCK_SIZE}) : u32{BLOCK_SIZE};
+	block_size = max(block_size, padded_size);
+	Block* const block = object::arena_make_block(*this, block_size);
+	block->next = _head;
+	_head = block;
+	_end = object::arena_block_data(block) + block_size;
+	p = object::arena_align(object::arena_block_data(block), align);
+	_put = p + size;
+	return p;
+}
+
+void ObjectArena::deallocate(void* /*p*/) {}
+
+void ObjectArena::reset() {
+	if (_head) {
+		while (_head->next) {
+			Block* const next = _head->next->next;
+			object::arena_free_block(*this, _head->next);
+			_head->next = next;
+		}
+		_put = object::arena_block_data(_head);
+	}
+	if (_strings_size > 0) {
+		std::memset(_strings, 0, _strings_capacity * sizeof(InternedString));
+		_strings_size = 0;
+	}
+	_num_allocations = 0;
+}
+
+/// Destruct document.
+///
+/// The tree is not walked; its memory goes with the arena.
+ObjectDocument::~ObjectDocument() {
+	new (&root) Object(arena);
+	object::document_release_mapping(*this);
+}
+
+/// Construct empty document with blocks from the default allocator.
+ObjectDocument::ObjectDocument()
+	: ObjectDocument(memory::default_allocator())
+{}
+
+/// Construct empty document with backing allocator for blocks.
+ObjectDocument::ObjectDocument(Allocator& backing)
+	: arena(backing)
+	, root(arena)
+	, _mapping(nullptr)
+	, _mapping_size(0)
+{
+	root.interned = true;
+}
+
+/// Clear document.
+///
+/// Drops the whole tree by resetting the arena and releases the file it was
+/// read from, if it is mapped. No object in the tree is visited.
+void object::clear(ObjectDocument& doc) {
+	doc.arena.reset();
+	new (&doc.root) Object(doc.arena);
+	doc.root.interned = true;
+	object::document_release_mapping(doc);
+}
+
+/// Intern a string in an arena.
+///
+/// Returns the arena's copy of value, adding it to the arena's string pool
+/// if it is not there yet. hash must be the hash of value; entries are
+/// matched on hash and content, so any 32-bit hasher works. The copy is
+/// NUL-terminated, must not be modified, and lives until the arena is reset.
+///
+/// Short values are pooled too, so the pool holds every distinct string of
+/// the arena, but objects keep their own copy of those inline (see
+/// object::interned_equal()).
+StringRef object::intern(ObjectArena& arena, StringRef const value, u32 const hash) {
+	if (value.empty()) {
+		return value;
+	}
+	if ((arena._strings_size + 1) * 4 > arena._strings_capacity * 3) {
+		object::arena_grow_strings(arena);
+	}
+	u32 const mask = arena._strings_capacity - 1;
+	for (u32 i = hash & mask;; i = (i + 1) & mask) {
+		auto& entry = arena._strings[i];
+		if (!entry.data) {
+			entry.data = static_cast<char*>(arena.allocate(value.size + 1, 1));
+			std::memcpy(entry.data, value.data, value.size);
+			entry.data[value.size] = '\0';
+			entry.size = value.size;
+			entry.hash = hash;
+			++arena._strings_size;
+			return StringRef{entry.data, entry.size};
+		} else if (
+			entry.hash == hash &&
+			entry.size == value.size &&
+			std::memcmp(entry.data, value.data, value.size) == 0
+		) {
+			return StringRef{entry.data, entry.size};
+		}
+	}
+}
+
+} // namespace quanta
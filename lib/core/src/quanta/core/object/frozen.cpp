@@ -0,0 +1,458 @@
+#line 2 "quanta/core/object/frozen.cpp"
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+*/
+
+#include <quanta/core/config.hpp>
+#include <quanta/core/object/object.hpp>
+
+#include <togo/core/error/assert.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/memory/memory.hpp>
+#include <togo/core/collection/array.hpp>
+#include <togo/core/string/string.hpp>
+#include <togo/core/hash/hash.hpp>
+#include <togo/core/log/log.hpp>
+#include <togo/core/lua/types.hpp>
+
+#include <quanta/core/object/io/mapped_file.ipp>
+
+#include <cstring>
+
+namespace quanta {
+
+namespace object {
+
+TOGO_LUA_MARK_USERDATA_ANCHOR(FrozenObjectDocument);
+
+namespace {
+
+struct FreezeString {
+	u32 offset;
+	u32 size;
+	u32 hash;
+};
+
+struct FreezeState {
+	Allocator& allocator;
+	Array<FrozenObject> objects;
+	Array<char> strings;
+	// Open-addressed; entries with size 0 are empty
+	FreezeString* table;
+	u32 table_capacity;
+	u32 table_size;
+
+	FreezeState(FreezeState&&) = delete;
+	FreezeState(FreezeState const&) = delete;
+	FreezeState& operator=(FreezeState&&) = delete;
+	FreezeState& operator=(FreezeState const&) = delete;
+
+	~FreezeState() {
+		if (table) {
+			allocator.deallocate(table);
+		}
+	}
+
+	FreezeState(Allocator& allocator)
+		: allocator(allocator)
+		, objects(allocator)
+		, strings(allocator)
+		, table(nullptr)
+		, table_capacity(0)
+		, table_size(0)
+	{}
+};
+
+// Double the string table, or create it
+static void freeze_grow_table(FreezeState& state) {
+	u32 const capacity = state.table_capacity ? state.table_capacity * 2 : 256;
+	auto table = static_cast<FreezeString*>(state.allocator.allocate(
+		capacity * sizeof(FreezeString), alignof(FreezeString)
+	));
+	std::memset(table, 0, capacity * sizeof(FreezeString));
+	u32 const mask = capacity - 1;
+	for (u32 i = 0; i < state.table_capacity; ++i) {
+		auto const& entry = state.table[i];
+		if (entry.size > 0) {
+			u32 j = entry.hash & mask;
+			while (table[j].size > 0) {
+				j = (j + 1) & mask;
+			}
+			table[j] = entry;
+		}
+	}
+	if (state.table) {
+		state.allocator.deallocate(state.table);
+	}
+	state.table = table;
+	state.table_capacity = capacity;
+}
+
+// Add a string to the blob if it is not there yet
+// Offsets are relative to the start of the blob until freeze_fixup()
+static FrozenObject::String freeze_string(FreezeState& state, StringRef const value, u32 const hash) {
+	if (value.size == 0) {
+		return {0, 0};
+	}
+	if ((state.table_size + 1) * 4 > state.table_capacity * 3) {
+		object::freeze_grow_table(state);
+	}
+	u32 const mask = state.table_capacity - 1;
+	for (u32 i = hash & mask;; i = (i + 1) & mask) {
+		auto& entry = state.table[i];
+		if (entry.size == 0) {
+			entry.offset = array::size(state.strings);
+			entry.size = value.size;
+			entry.hash = hash;
+			++state.table_size;
+			array::resize(state.strings, entry.offset + value.size);
+			std::memcpy(array::begin(state.strings) + entry.offset, value.data, value.size);
+			return {entry.offset, entry.size};
+		} else if (
+			entry.hash == hash &&
+			entry.size == value.size &&
+			std::memcmp(array::begin(state.strings) + entry.offset, value.data, value.size) == 0
+		) {
+			return {entry.offset, entry.size};
+		}
+	}
+}
+
+template<class H>
+inline FrozenObject::String freeze_string(FreezeState& state, HashedUnmanagedString<H> const& value) {
+	return object::freeze_string(state, value, value.hash);
+}
+
+static void freeze_value(FreezeState& state, FrozenObject& node, Object const& obj) {
+	node.properties = obj.properties;
+	node.source_line = obj.source_line;
+	node.source = obj.source;
+	node.sub_source = obj.sub_source;
+	node.name_hash = obj.name.hash;
+	node.name = object::freeze_string(state, obj.name);
+	node.value_name = {0, 0};
+	node.value_hash = OBJECT_VALUE_NULL;
+	node.subs = 0;
+	node.num_operands = 0;
+	node.num_tags = 0;
+	node.num_children = 0;
+	node.has_quantity = false;
+	std::memset(&node.value, 0, sizeof(node.value));
+
+	switch (object::type(obj)) {
+	case ObjectValueType::null:
+	case ObjectValueType::expression:
+		break;
+
+	case ObjectValueType::boolean:
+		node.value.boolean = obj.value.boolean;
+		break;
+
+	case ObjectValueType::integer:
+	case ObjectValueType::decimal:
+	case ObjectValueType::currency:
+		// integer, decimal and currency share storage
+		node.value.currency = obj.value.numeric.c;
+		node.value_name = object::freeze_string(state, obj.value.numeric.unit);
+		node.value_hash = obj.value.numeric.unit.hash;
+		break;
+
+	case ObjectValueType::time:
+		node.value.time = obj.value.time;
+		break;
+
+	case ObjectValueType::string: {
+		StringRef const value = obj.value.string.value;
+		node.value.string = object::freeze_string(
+			state, value, hash::calc<ObjectValueHasher>(value)
+		);
+		node.value_name = object::freeze_string(state, obj.value.string.type);
+		node.value_hash = obj.value.string.type.hash;
+	}	break;
+
+	case ObjectValueType::identifier:
+		node.value_name = object::freeze_string(state, obj.value.identifier);
+		node.value_hash = obj.value.identifier.hash;
+		break;
+	}
+}
+
+// Add the block of sub-objects of the object at index, then the blocks of
+// each sub-object
+// subs is an object index until freeze_fixup()
+static void freeze_subs(FreezeState& state, u32 const index, Object const& obj) {
+	auto const& expression = object::is_expression(obj)
+		? object::expression(obj)
+		: internal::empty_collection()
+	;
+	auto const& tags = object::tags(obj);
+	auto const& children = object::children(obj);
+	auto const quantity = object::quantity(obj);
+	u32 const num_subs
+		= array::size(expression)
+		+ array::size(tags)
+		+ array::size(children)
+		+ (quantity ? 1 : 0)
+	;
+	if (num_subs == 0) {
+		return;
+	}
+
+	u32 const base = array::size(state.objects);
+	array::resize(state.objects, base + num_subs);
+	{
+		auto& node = state.objects[index];
+		node.subs = base;
+		node.num_operands = array::size(expression);
+		node.num_tags = array::size(tags);
+		node.num_children = array::size(children);
+		node.has_quantity = quantity != nullptr;
+	}
+
+	u32 i = base;
+	for (auto const& sub : expression) {
+		object::freeze_value(state, state.objects[i++], sub);
+	}
+	for (auto const& sub : tags) {
+		object::freeze_value(state, state.objects[i++], sub);
+	}
+	for (auto const& sub : children) {
+		object::freeze_value(state, state.objects[i++], sub);
+	}
+	if (quantity) {
+		object::freeze_value(state, state.objects[i++], *quantity);
+	}
+
+	i = base;
+	for (auto const& sub : expression) {
+		object::freeze_subs(state, i++, sub);
+	}
+	for (auto const& sub : tags) {
+		object::freeze_subs(state, i++, sub);
+	}
+	for (auto const& sub : children) {
+		object::freeze_subs(state, i++, sub);
+	}
+	if (quantity) {
+		object::freeze_subs(state, i++, *quantity);
+	}
+}
+
+// Make offsets relative to each object
+static void freeze_fixup(FrozenObject* const data, u32 const num_objects) {
+	u32 const strings = num_objects * sizeof(FrozenObject);
+	for (u32 i = 0; i < num_objects; ++i) {
+		auto& node = data[i];
+		u32 const position = i * sizeof(FrozenObject);
+		if (node.name.size > 0) {
+			node.name.offset += strings - position;
+		}
+		if (node.value_name.size > 0) {
+			node.value_name.offset += strings - position;
+		}
+		if (object::is_string(node) && node.value.string.size > 0) {
+			node.value.string.offset += strings - position;
+		}
+		if (node.subs > 0) {
+			node.subs = (node.subs - i) * sizeof(FrozenObject);
+		}
+	}
+}
+
+static FrozenObject const* find_frozen(
+	ArrayRef<FrozenObject const> const& collection,
+	StringRef const& name,
+	ObjectNameHash const name_hash
+) {
+	if (name_hash == OBJECT_NAME_NULL) {
+		return nullptr;
+	}
+	for (FrozenObject const& item : collection) {
+		if (name_hash == item.name_hash) {
+			#if defined(QUANTA_DEBUG)
+			if (name.valid() && !string::compare_equal(name, object::name(item))) {
+				TOGO_LOG_DEBUGF(
+					"hashes matched, but names mismatched: '%.*s' != '%.*s' (lookup_name != name)\n",
+					name.size, name.data,
+					item.name.size, object::name(item).data
+				);
+			}
+			#else
+				(void)name;
+			#endif
+			return &item;
+		}
+	}
+	return nullptr;
+}
+
+} // anonymous namespace
+} // namespace object
+
+/// Freeze an object tree.
+///
+/// Replaces the contents of doc with a read-only flat copy of root and all
+/// of its sub-objects.
+void object::freeze(FrozenObjectDocument& doc, Object const& root) {
+	object::clear(doc);
+
+	FreezeState state{*doc._allocator};
+	array::resize(state.objects, 1);
+	object::freeze_value(state, state.objects[0], root);
+	object::freeze_subs(state, 0, root);
+
+	u32 const num_objects = array::size(state.objects);
+	u64 const size
+		= u64{num_objects} * sizeof(FrozenObject)
+		+ array::size(state.strings)
+	;
+	TOGO_ASSERT(size <= 0xFFFFFFFFu, "frozen document is too large");
+
+	doc._data = static_cast<FrozenObject*>(doc._allocator->allocate(
+		static_cast<u32>(size), alignof(FrozenObject)
+	));
+	doc._num_objects = num_objects;
+	doc._size = static_cast<u32>(size);
+	std::memcpy(doc._data, array::begin(state.objects), num_objects * sizeof(FrozenObject));
+	if (array::any(state.strings)) {
+		std::memcpy(
+			doc._data + num_objects,
+			array::begin(state.strings),
+			array::size(state.strings)
+		);
+	}
+	object::freeze_fixup(doc._data, num_objects);
+}
+
+/// Clear a frozen document.
+///
+/// Releases the data or unmaps the file.
+void object::clear(FrozenObjectDocument& doc) {
+	if (doc._mapping) {
+		MappedFile file{};
+		file.data = doc._mapping;
+		file.size = doc._mapping_size;
+		object::mapped_file_close(file);
+		doc._mapping = nullptr;
+		doc._mapping_size = 0;
+	} else if (doc._data) {
+		doc._allocator->deallocate(doc._data);
+	}
+	doc._data = nullptr;
+	doc._num_objects = 0;
+	doc._size = 0;
+}
+
+/// Copy a frozen object.
+///
+/// Unlike object::copy(Object&, Object const&, bool), this also copies the
+/// source line.
+void object::copy(Object& dst, FrozenObject const& src, bool const children IGEN_DEFAULT(true)) {
+	object::clear_value(dst);
+	dst.properties = src.properties;
+	dst.source_line = src.source_line;
+	dst.source = src.source;
+	dst.sub_source = src.sub_source;
+	if (src.name.size > 0) {
+		internal::set_hashed(dst, dst.name, object::name(src), src.name_hash);
+	} else {
+		object::clear_name(dst);
+	}
+	switch (object::type(src)) {
+	case ObjectValueType::null:
+	case ObjectValueType::expression:
+		break;
+	case ObjectValueType::boolean:
+		dst.value.boolean = src.value.boolean;
+		break;
+	case ObjectValueType::integer:
+	case ObjectValueType::decimal:
+	case ObjectValueType::currency:
+		dst.value.numeric.c = src.value.currency;
+		internal::set_hashed(
+			dst, dst.value.numeric.unit,
+			internal::frozen_string(src, src.value_name), src.value_hash
+		);
+		break;
+	case ObjectValueType::time:
+		dst.value.time = src.value.time;
+		break;
+	case ObjectValueType::string:
+		unmanaged_string::set(
+			dst.value.string.value,
+			internal::frozen_string(src, src.value.string),
+			object::allocator(dst)
+		);
+		internal::set_hashed(
+			dst, dst.value.string.type,
+			internal::frozen_string(src, src.value_name), src.value_hash
+		);
+		break;
+	case ObjectValueType::identifier:
+		internal::set_hashed(
+			dst, dst.value.identifier,
+			internal::frozen_string(src, src.value_name), src.value_hash
+		);
+		break;
+	}
+
+	if (object::has_operands(src)) {
+		auto& expression = object::extra(dst).expression;
+		array::reserve(expression, src.num_operands);
+		for (auto const& operand : object::expression(src)) {
+			object::copy(object::push_back_sub(expression, dst), operand);
+		}
+	}
+	object::copy_tags(dst, src);
+	if (children) {
+		object::copy_children(dst, src);
+	}
+	if (object::has_quantity(src)) {
+		object::copy(object::make_quantity(dst), *object::quantity(src));
+	} else {
+		object::release_quantity(dst);
+	}
+}
+
+/// Copy the children of a frozen object.
+void object::copy_children(Object& dst, FrozenObject const& src) {
+	object::clear_children(dst);
+	array::reserve(dst.children, src.num_children);
+	for (auto const& child : object::children(src)) {
+		object::copy(object::push_back_sub(dst.children, dst), child);
+	}
+}
+
+/// Copy the tags of a frozen object.
+void object::copy_tags(Object& dst, FrozenObject const& src) {
+	object::clear_tags(dst);
+	if (object::has_tags(src)) {
+		auto& tags = object::extra(dst).tags;
+		array::reserve(tags, src.num_tags);
+		for (auto const& tag : object::tags(src)) {
+			object::copy(object::push_back_sub(tags, dst), tag);
+		}
+	}
+}
+
+/// Find tag by name.
+FrozenObject const* object::find_tag(FrozenObject const& obj, StringRef const& name) {
+	return object::find_frozen(object::tags(obj), name, object::hash_name(name));
+}
+
+/// Find tag by name hash.
+FrozenObject const* object::find_tag(FrozenObject const& obj, ObjectNameHash const name_hash) {
+	return object::find_frozen(object::tags(obj), StringRef{}, name_hash);
+}
+
+/// Find child by name.
+FrozenObject const* object::find_child(FrozenObject const& obj, StringRef const& name) {
+	return object::find_frozen(object::children(obj), name, object::hash_name(name));
+}
+
+/// Find child by name hash.
+FrozenObject const* object::find_child(FrozenObject const& obj, ObjectNameHash const name_hash) {
+	return object::find_frozen(object::children(obj), StringRef{}, name_hash);
+}
+
+} // namespace quanta
@@ -0,0 +1,707 @@
+#line 2 "quanta/core/object/frozen_li.cpp"
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+*/
+
+#include <quanta/core/config.hpp>
+#include <quanta/core/chrono/time.hpp>
+#include <quanta/core/object/object.hpp>
+#include <quanta/core/lua/lua.hpp>
+
+#include <togo/core/error/assert.hpp>
+#include <togo/core/utility/utility.hpp>
+
+namespace quanta {
+
+namespace object {
+namespace frozen {
+
+// Frozen objects are passed as light userdata; they live as long as their
+// document
+
+inline static FrozenObject const& li_node(lua_State* L, signed narg) {
+	return *lua::get_lightuserdata_typed<FrozenObject>(L, narg);
+}
+
+inline static void li_push_node(lua_State* L, FrozenObject const* obj) {
+	lua::push_lightuserdata(L, const_cast<FrozenObject*>(obj));
+}
+
+static signed li_sub_iter(lua_State* L, ArrayRef<FrozenObject const> const& subs) {
+	// 1-based index
+	auto i = luaL_checkinteger(L, 2);
+	++i;
+	if (i <= signed_cast(subs.size())) {
+		lua::push_value(L, i);
+		li_push_node(L, &subs[i - 1]);
+		return 2;
+	}
+	return 0;
+}
+
+static signed li_sub_at(lua_State* L, ArrayRef<FrozenObject const> const& subs) {
+	auto i = luaL_checkinteger(L, 2);
+	luaL_argcheck(L, i >= 1 && i <= signed_cast(subs.size()), 2, "index out of bounds");
+	li_push_node(L, &subs[i - 1]);
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(__mm_ctor) {
+	lua::new_userdata<FrozenObjectDocument>(L);
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(__mm_destroy) {
+	auto doc = lua::get_userdata<FrozenObjectDocument>(L, 1);
+	doc->~FrozenObjectDocument();
+	return 0;
+}
+
+TOGO_LI_FUNC_DEF(__module_init__) {
+	lua::register_userdata<FrozenObjectDocument>(L, li___mm_destroy);
+	return 0;
+}
+
+// obj, doc = nil
+TOGO_LI_FUNC_DEF(freeze) {
+	auto obj = lua::get_pointer<Object>(L, 1);
+	FrozenObjectDocument* doc;
+	if (lua_isnoneornil(L, 2)) {
+		doc = lua::new_userdata<FrozenObjectDocument>(L);
+	} else {
+		doc = lua::get_pointer<FrozenObjectDocument>(L, 2);
+		lua_pushvalue(L, 2);
+	}
+	object::freeze(*doc, *obj);
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(clear) {
+	auto doc = lua::get_pointer<FrozenObjectDocument>(L, 1);
+	object::clear(*doc);
+	return 0;
+}
+
+TOGO_LI_FUNC_DEF(root) {
+	auto doc = lua::get_pointer<FrozenObjectDocument>(L, 1);
+	li_push_node(L, &object::root(*doc));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(num_objects) {
+	auto doc = lua::get_pointer<FrozenObjectDocument>(L, 1);
+	lua::push_value(L, object::num_objects(*doc));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(size) {
+	auto doc = lua::get_pointer<FrozenObjectDocument>(L, 1);
+	lua::push_value(L, object::size(*doc));
+	return 1;
+}
+
+// dst (Object), src, children = true
+TOGO_LI_FUNC_DEF(copy) {
+	auto dst = lua::get_pointer<Object>(L, 1);
+	auto& src = li_node(L, 2);
+	auto children = luaL_opt(L, lua::get_boolean, 3, true);
+	object::copy(*dst, src, children);
+	return 0;
+}
+
+TOGO_LI_FUNC_DEF(type) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, unsigned_cast(object::type(obj)));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_type) {
+	auto& obj = li_node(L, 1);
+	auto type = static_cast<ObjectValueType>(luaL_checkinteger(L, 2));
+	lua::push_value(L, object::is_type(obj, type));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_type_any) {
+	auto& obj = li_node(L, 1);
+	auto type = static_cast<ObjectValueType>(luaL_checkinteger(L, 2));
+	lua::push_value(L, object::is_type_any(obj, type));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_null) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_null(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_boolean) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_boolean(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_integer) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_integer(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_decimal) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_decimal(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_numeric) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_numeric(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_currency) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_currency(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_time) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_time(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_string) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_string(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_identifier) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_identifier(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_textual) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_textual(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_expression) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_expression(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(source_line) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::source_line(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(name) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::name(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(name_hash) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::name_hash(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_named) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_named(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(op) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, unsigned_cast(object::op(obj)));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(source) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::source(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(marker_source_uncertain) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::marker_source_uncertain(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(sub_source) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::sub_source(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(marker_sub_source_uncertain) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::marker_sub_source_uncertain(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_source) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_source(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_sub_source) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_sub_source(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(source_certain) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::source_certain(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(source_certain_or_unspecified) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::source_certain_or_unspecified(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(marker_value_uncertain) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::marker_value_uncertain(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(marker_value_guess) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::marker_value_guess(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(value_approximation) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::value_approximation(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(value_certain) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::value_certain(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(boolean) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::boolean(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(integer) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::integer(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(decimal) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::decimal(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(numeric) {
+	auto& obj = li_node(L, 1);
+	if (object::is_decimal(obj)) {
+		lua::push_value(L, object::decimal(obj));
+	} else {
+		// type check in integer()
+		lua::push_value(L, object::integer(obj));
+	}
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(unit) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::unit(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(unit_hash) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::unit_hash(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_unit) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_unit(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(currency) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::currency(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(currency_exponent) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::currency_exponent(obj));
+	return 1;
+}
+
+// Copy; the value in the document is not writable
+TOGO_LI_FUNC_DEF(time) {
+	auto& obj = li_node(L, 1);
+	lua::new_userdata<Time>(L, object::time_value(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(time_resolved) {
+	auto& obj = li_node(L, 1);
+	auto t = lua::get_pointer<Time const>(L, 2);
+	lua::new_userdata<Time>(L, object::time_resolved(obj, *t));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(time_type) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, unsigned_cast(object::time_type(obj)));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_date) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_date(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_clock) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_clock(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_zoned) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_zoned(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_year_contextual) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_year_contextual(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_month_contextual) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_month_contextual(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(is_date_contextual) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::is_date_contextual(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(string) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::string(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(string_type) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::string_type(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(string_type_hash) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::string_type_hash(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_string_type) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_string_type(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(identifier) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::identifier(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(identifier_hash) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::identifier_hash(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(text) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::text(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(expression_iter) {
+	return li_sub_iter(L, object::expression(li_node(L, 1)));
+}
+
+TOGO_LI_FUNC_DEF(expression) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, TOGO_LI_FUNC(expression_iter));
+	li_push_node(L, &obj);
+	lua::push_value(L, 0);
+	return 3;
+}
+
+TOGO_LI_FUNC_DEF(num_expression) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::expression(obj).size());
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_operands) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_operands(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(operand_at) {
+	auto& obj = li_node(L, 1);
+	return li_sub_at(L, object::expression(obj));
+}
+
+TOGO_LI_FUNC_DEF(children_iter) {
+	return li_sub_iter(L, object::children(li_node(L, 1)));
+}
+
+TOGO_LI_FUNC_DEF(children) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, TOGO_LI_FUNC(children_iter));
+	li_push_node(L, &obj);
+	lua::push_value(L, 0);
+	return 3;
+}
+
+TOGO_LI_FUNC_DEF(num_children) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::children(obj).size());
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_children) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_children(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(child_at) {
+	auto& obj = li_node(L, 1);
+	return li_sub_at(L, object::children(obj));
+}
+
+TOGO_LI_FUNC_DEF(find_child) {
+	auto& obj = li_node(L, 1);
+	FrozenObject const* result = nullptr;
+	if (lua_type(L, 2) == LUA_TSTRING) {
+		result = object::find_child(obj, lua::get_string(L, 2));
+	} else {
+		result = object::find_child(obj, static_cast<ObjectNameHash>(luaL_checkinteger(L, 2)));
+	}
+	li_push_node(L, result);
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(tags_iter) {
+	return li_sub_iter(L, object::tags(li_node(L, 1)));
+}
+
+TOGO_LI_FUNC_DEF(tags) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, TOGO_LI_FUNC(tags_iter));
+	li_push_node(L, &obj);
+	lua::push_value(L, 0);
+	return 3;
+}
+
+TOGO_LI_FUNC_DEF(num_tags) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::tags(obj).size());
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_tags) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_tags(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(tag_at) {
+	auto& obj = li_node(L, 1);
+	return li_sub_at(L, object::tags(obj));
+}
+
+TOGO_LI_FUNC_DEF(find_tag) {
+	auto& obj = li_node(L, 1);
+	FrozenObject const* result = nullptr;
+	if (lua_type(L, 2) == LUA_TSTRING) {
+		result = object::find_tag(obj, lua::get_string(L, 2));
+	} else {
+		result = object::find_tag(obj, static_cast<ObjectNameHash>(luaL_checkinteger(L, 2)));
+	}
+	li_push_node(L, result);
+	return 1;
+}
+
+// dst (Object), src
+TOGO_LI_FUNC_DEF(copy_children) {
+	auto dst = lua::get_pointer<Object>(L, 1);
+	object::copy_children(*dst, li_node(L, 2));
+	return 0;
+}
+
+// dst (Object), src
+TOGO_LI_FUNC_DEF(copy_tags) {
+	auto dst = lua::get_pointer<Object>(L, 1);
+	object::copy_tags(*dst, li_node(L, 2));
+	return 0;
+}
+
+TOGO_LI_FUNC_DEF(quantity) {
+	auto& obj = li_node(L, 1);
+	li_push_node(L, object::quantity(obj));
+	return 1;
+}
+
+TOGO_LI_FUNC_DEF(has_quantity) {
+	auto& obj = li_node(L, 1);
+	lua::push_value(L, object::has_quantity(obj));
+	return 1;
+}
+
+static LuaModuleFunctionArray const li_funcs{
+	TOGO_LI_FUNC_REF(frozen, __module_init__)
+
+	TOGO_LI_FUNC_REF(frozen, __mm_ctor)
+
+	TOGO_LI_FUNC_REF(frozen, freeze)
+	TOGO_LI_FUNC_REF(frozen, clear)
+	TOGO_LI_FUNC_REF(frozen, root)
+	TOGO_LI_FUNC_REF(frozen, num_objects)
+	TOGO_LI_FUNC_REF(frozen, size)
+	TOGO_LI_FUNC_REF(frozen, copy)
+
+	TOGO_LI_FUNC_REF(frozen, type)
+	TOGO_LI_FUNC_REF(frozen, is_type)
+	TOGO_LI_FUNC_REF(frozen, is_type_any)
+	TOGO_LI_FUNC_REF(frozen, is_null)
+	TOGO_LI_FUNC_REF(frozen, is_boolean)
+	TOGO_LI_FUNC_REF(frozen, is_integer)
+	TOGO_LI_FUNC_REF(frozen, is_decimal)
+	TOGO_LI_FUNC_REF(frozen, is_numeric)
+	TOGO_LI_FUNC_REF(frozen, is_currency)
+	TOGO_LI_FUNC_REF(frozen, is_time)
+	TOGO_LI_FUNC_REF(frozen, is_string)
+	TOGO_LI_FUNC_REF(frozen, is_identifier)
+	TOGO_LI_FUNC_REF(frozen, is_textual)
+	TOGO_LI_FUNC_REF(frozen, is_expression)
+
+	TOGO_LI_FUNC_REF(frozen, source_line)
+	TOGO_LI_FUNC_REF(frozen, name)
+	TOGO_LI_FUNC_REF(frozen, name_hash)
+	TOGO_LI_FUNC_REF(frozen, is_named)
+	TOGO_LI_FUNC_REF(frozen, op)
+
+	TOGO_LI_FUNC_REF(frozen, source)
+	TOGO_LI_FUNC_REF(frozen, marker_source_uncertain)
+	TOGO_LI_FUNC_REF(frozen, sub_source)
+	TOGO_LI_FUNC_REF(frozen, marker_sub_source_uncertain)
+	TOGO_LI_FUNC_REF(frozen, has_source)
+	TOGO_LI_FUNC_REF(frozen, has_sub_source)
+	TOGO_LI_FUNC_REF(frozen, source_certain)
+	TOGO_LI_FUNC_REF(frozen, source_certain_or_unspecified)
+
+	TOGO_LI_FUNC_REF(frozen, marker_value_uncertain)
+	TOGO_LI_FUNC_REF(frozen, marker_value_guess)
+	TOGO_LI_FUNC_REF(frozen, value_approximation)
+	TOGO_LI_FUNC_REF(frozen, value_certain)
+
+	TOGO_LI_FUNC_REF(frozen, boolean)
+	TOGO_LI_FUNC_REF(frozen, integer)
+	TOGO_LI_FUNC_REF(frozen, decimal)
+	TOGO_LI_FUNC_REF(frozen, numeric)
+	TOGO_LI_FUNC_REF(frozen, unit)
+	TOGO_LI_FUNC_REF(frozen, unit_hash)
+	TOGO_LI_FUNC_REF(frozen, has_unit)
+	TOGO_LI_FUNC_REF(frozen, currency)
+	TOGO_LI_FUNC_REF(frozen, currency_exponent)
+
+	TOGO_LI_FUNC_REF(frozen, time)
+	TOGO_LI_FUNC_REF(frozen, time_resolved)
+	TOGO_LI_FUNC_REF(frozen, time_type)
+	TOGO_LI_FUNC_REF(frozen, has_date)
+	TOGO_LI_FUNC_REF(frozen, has_clock)
+	TOGO_LI_FUNC_REF(frozen, is_zoned)
+	TOGO_LI_FUNC_REF(frozen, is_year_contextual)
+	TOGO_LI_FUNC_REF(frozen, is_month_contextual)
+	TOGO_LI_FUNC_REF(frozen, is_date_contextual)
+
+	TOGO_LI_FUNC_REF(frozen, string)
+	TOGO_LI_FUNC_REF(frozen, string_type)
+	TOGO_LI_FUNC_REF(frozen, string_type_hash)
+	TOGO_LI_FUNC_REF(frozen, has_string_type)
+	TOGO_LI_FUNC_REF(frozen, identifier)
+	TOGO_LI_FUNC_REF(frozen, identifier_hash)
+	TOGO_LI_FUNC_REF(frozen, text)
+
+	TOGO_LI_FUNC_REF(frozen, expression)
+	TOGO_LI_FUNC_REF(frozen, num_expression)
+	TOGO_LI_FUNC_REF(frozen, has_operands)
+	TOGO_LI_FUNC_REF(frozen, operand_at)
+
+	TOGO_LI_FUNC_REF(frozen, children)
+	TOGO_LI_FUNC_REF(frozen, num_children)
+	TOGO_LI_FUNC_REF(frozen, has_children)
+	TOGO_LI_FUNC_REF(frozen, child_at)
+	TOGO_LI_FUNC_REF(frozen, find_child)
+	TOGO_LI_FUNC_REF(frozen, copy_children)
+
+	TOGO_LI_FUNC_REF(frozen, tags)
+	TOGO_LI_FUNC_REF(frozen, num_tags)
+	TOGO_LI_FUNC_REF(frozen, has_tags)
+	TOGO_LI_FUNC_REF(frozen, tag_at)
+	TOGO_LI_FUNC_REF(frozen, find_tag)
+	TOGO_LI_FUNC_REF(frozen, copy_tags)
+
+	TOGO_LI_FUNC_REF(frozen, quantity)
+	TOGO_LI_FUNC_REF(frozen, has_quantity)
+};
+
+static LuaModuleRef const li_module{
+	"Quanta.FrozenObject",
+	"quanta/core/object/FrozenObject.lua",
+	li_funcs,
+	#include <quanta/core/object/FrozenObject.lua>
+};
+
+} // namespace frozen
+} // namespace object
+
+/// Register the Lua interface for frozen objects.
+void object::register_frozen_lua_interface(lua_State* L) {
+	lua::preload_module(L, object::frozen::li_module);
+}
+
+} // namespace quanta
@@ -124,6 +124,10 @@ inline unsigned get_property(Object const& obj, unsigned mask, unsigned shift) {
 	return (obj.properties & mask) >> shift;
 }
 
+inline unsigned get_property(FrozenObject const& obj, unsigned mask, unsigned shift) {
+	return (obj.properties & mask) >> shift;
+}
+
 inline void set_property(Object& obj, unsigned mask, unsigned shift, unsigned value) {
 	obj.properties = (obj.properties & ~mask) | (value << shift);
 }
@@ -0,0 +1,247 @@
+#line 2 "quanta/core/object/io/builder.ipp"
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+*/
+
+#include <quanta/core/config.hpp>
+#include <quanta/core/object/object.hpp>
+
+#include <togo/core/error/assert.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/collection/array.hpp>
+
+namespace quanta {
+namespace object {
+
+namespace {
+
+static void builder_move_object_into_child(Object& obj) {
+	auto& children = object::children(obj);
+	{
+	// Move the value, tags, quantity and operands; the name and children
+	// stay with obj
+	auto& last = object::push_back_sub(children, obj);
+	object::clear_indexes(obj);
+	last.properties = obj.properties;
+	last.source = obj.source;
+	last.sub_source = obj.sub_source;
+	last.value = obj.value;
+	last.extra = obj.extra;
+	obj.value = {};
+	obj.extra = nullptr;
+	}
+	// Move children
+	if (array::size(children) > 1) {
+		auto last = end(children) - 1;
+		auto& last_children = object::children(*last);
+		for (auto it = begin(children); it != last; ++it) {
+			array::push_back_inplace(last_children, rvalue_ref(*it));
+		}
+		array::remove_over(children, 0);
+		array::resize(children, 1);
+	}
+	object::set_null(obj);
+	object::clear_value_markers(obj);
+	object::clear_source(obj);
+	object::clear_tags(obj);
+	object::release_quantity(obj);
+}
+
+// Builds the tree of root from visitor events (see read_text())
+struct ObjectBuilder : IObjectVisitor {
+	struct Level {
+		Object* obj;
+		ObjectVisitKind kind;
+	};
+
+	Object& root;
+	bool single_value;
+	Array<Level> stack;
+	Level last;
+	// Input that outlives the tree; strings in it are not copied
+	StringRef shared_input;
+
+	ObjectBuilder(ObjectBuilder&&) = delete;
+	ObjectBuilder(ObjectBuilder const&) = delete;
+	ObjectBuilder& operator=(ObjectBuilder&&) = delete;
+	ObjectBuilder& operator=(ObjectBuilder const&) = delete;
+
+	ObjectBuilder(Object& root, bool single_value, Allocator& allocator)
+		: root(root)
+		, single_value(single_value)
+		, stack(allocator)
+		, last{nullptr, ObjectVisitKind::child}
+		, shared_input()
+	{
+		array::reserve(stack, 32);
+		array::push_back(stack, Level{&root, ObjectVisitKind::child});
+	}
+
+	Object& top() {
+		return *array::back(stack).obj;
+	}
+
+	bool begin_object(ObjectVisitKind const kind, unsigned const line) override {
+		auto& parent = top();
+		Object* obj = nullptr;
+		if (array::size(stack) == 1 && object::source_line(root) == 0) {
+			object::set_source_line(root, line);
+		}
+		switch (kind) {
+		case ObjectVisitKind::child:
+			obj
+				= single_value && array::size(stack) == 1
+				? &root
+				: &object::push_back_sub(object::children(parent), parent)
+			;
+			break;
+
+		case ObjectVisitKind::tag:
+			obj = &object::push_back_sub(object::tags(parent), parent);
+			break;
+
+		case ObjectVisitKind::quantity:
+			obj = &object::make_quantity(parent);
+			break;
+
+		case ObjectVisitKind::operand:
+			obj = &object::push_back_sub(object::expression(parent), parent);
+			break;
+		}
+		if (object::source_line(*obj) == 0) {
+			object::set_source_line(*obj, line);
+		}
+		array::push_back(stack, Level{obj, kind});
+		return true;
+	}
+
+	bool end_object() override {
+		TOGO_DEBUG_ASSERTE(array::size(stack) > 1);
+		last = array::back(stack);
+		array::pop_back(stack);
+		return true;
+	}
+
+	bool wrap(ObjectVisitWrap const wrap, unsigned const line) override {
+		TOGO_DEBUG_ASSERTE(last.obj);
+		Object* obj = last.obj;
+		if (wrap == ObjectVisitWrap::collection) {
+			builder_move_object_into_child(*obj);
+		} else if (last.kind == ObjectVisitKind::child && obj != &root) {
+			// Replace the object in its scope with an expression that
+			// takes its name
+			auto& scope = object::children(top());
+			auto& shim = object::push_back_sub(scope, top());
+			auto lead = end(scope) - 2;
+			object::set_expression(shim);
+			shim.name = lead->name;
+			lead->name = {};
+			object::set_op(*lead, ObjectOperator::none);
+			array::push_back_inplace(object::expression(shim), rvalue_ref(*lead));
+			array::remove_over(scope, lead);
+			obj = &array::back(scope);
+		} else {
+			builder_move_object_into_child(*obj);
+			object::set_expression(*obj);
+			object::expression(*obj) = rvalue_ref(object::children(*obj));
+			object::set_op(array::back(object::expression(*obj)), ObjectOperator::none);
+		}
+		if (object::source_line(*obj) == 0) {
+			object::set_source_line(*obj, line);
+		}
+		array::push_back(stack, Level{obj, last.kind});
+		return true;
+	}
+
+	bool name(StringRef const name) override {
+		object::set_name(top(), name);
+		return true;
+	}
+
+	bool op(ObjectOperator const op) override {
+		object::set_op(top(), op);
+		return true;
+	}
+
+	bool marker(ObjectValueMarker const marker, signed const approximation) override {
+		auto& obj = top();
+		switch (marker) {
+		case ObjectValueMarker::uncertain: object::set_value_certain(obj, false); break;
+		case ObjectValueMarker::guess: object::set_value_guess(obj, true); break;
+		case ObjectValueMarker::approximate: object::set_value_approximation(obj, approximation); break;
+		}
+		return true;
+	}
+
+	bool value(ObjectVisitValue const& value) override {
+		auto& obj = top();
+		switch (value.type) {
+		case ObjectValueType::null: object::set_null(obj); break;
+		case ObjectValueType::boolean: object::set_boolean(obj, value.boolean); break;
+		case ObjectValueType::integer: object::set_integer(obj, value.integer); break;
+		case ObjectValueType::decimal: object::set_decimal(obj, value.decimal); break;
+
+		case ObjectValueType::time:
+			object::set_time_value(obj, {});
+			object::set_zoned(obj, false);
+			if (value.time.month_contextual) {
+				object::set_month_contextual(obj, true);
+			} else if (value.time.year_contextual) {
+				object::set_year_contextual(obj, true);
+			}
+			object::set_time_type(obj, value.time.type);
+			obj.value.time = value.time.value;
+			if (value.time.zoned) {
+				object::set_zoned(obj, true);
+			}
+			break;
+
+		case ObjectValueType::currency:
+			object::set_currency(obj, value.currency.value, value.currency.exponent, "");
+			break;
+
+		case ObjectValueType::string:
+			if (
+				shared_input.data &&
+				value.string.data >= shared_input.data &&
+				value.string.data + value.string.size <= shared_input.data + shared_input.size
+			) {
+				object::set_string_shared(obj, value.string);
+			} else {
+				object::set_string(obj, value.string);
+			}
+			if (!value.string_type.empty()) {
+				object::set_string_type(obj, value.string_type);
+			}
+			break;
+
+		case ObjectValueType::identifier: object::set_identifier(obj, value.string); break;
+		case ObjectValueType::expression: object::set_expression(obj); break;
+		}
+		return true;
+	}
+
+	bool unit(StringRef const unit) override {
+		object::set_unit(top(), unit);
+		return true;
+	}
+
+	bool source(unsigned const source, bool const certain) override {
+		auto& obj = top();
+		object::set_source_certain(obj, certain);
+		obj.source = static_cast<u16>(min(source, 0xFFFFu));
+		return true;
+	}
+
+	bool sub_source(unsigned const sub_source, bool const certain) override {
+		auto& obj = top();
+		object::set_sub_source_certain(obj, certain);
+		obj.sub_source = static_cast<u16>(min(sub_source, 0xFFFFu));
+		return true;
+	}
+};
+
+} // anonymous namespace
+
+} // namespace object
+} // namespace quanta
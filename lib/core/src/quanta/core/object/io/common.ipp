@@ -6,13 +6,15 @@
 #include <quanta/core/config.hpp>
 #include <quanta/core/object/types.hpp>
 
+#include <cfloat>
+
 namespace quanta {
 namespace object {
 
 namespace {
 
 inline u64 pow_int(unsigned base, unsigned exponent) {
-	unsigned value = 1;
+	u64 value = 1;
 	while (exponent--) {
 		value *= base;
 	}
@@ -39,6 +41,35 @@ static u64 parse_integer_unsigned(char const*& it, char const* end) {
 	return negative ? -static_cast<s64>(value) : static_cast<s64>(value);
 }*/
 
+// Exactly representable powers of ten
+static f64 const s_pow10_exact[]{
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+	1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+	1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Convert mantissa * 10^exponent to the nearest f64 if it takes a single
+// rounding (Clinger's fast path): the mantissa fits in the f64 significand
+// and the power of ten is exact. Returns false otherwise.
+inline static bool parse_decimal_exact(u64 const mantissa, s32 const exponent, f64& value) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+	if (mantissa > (u64{1} << 53) || exponent < -22 || exponent > 22) {
+		return false;
+	}
+	value = static_cast<f64>(mantissa);
+	if (exponent < 0) {
+		value /= s_pow10_exact[-exponent];
+	} else {
+		value *= s_pow10_exact[exponent];
+	}
+	return true;
+#else
+	// Extended intermediate precision would round twice
+	(void)mantissa; (void)exponent; (void)value;
+	return false;
+#endif
+}
+
 template<bool>
 struct parse_s64_adaptor;
 
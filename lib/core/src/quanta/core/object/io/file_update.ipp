@@ -0,0 +1,239 @@
+#line 2 "quanta/core/object/io/file_update.ipp"
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+*/
+
+#include <quanta/core/config.hpp>
+
+#include <togo/core/collection/array.hpp>
+#include <togo/core/string/types.hpp>
+#include <togo/core/io/io.hpp>
+#include <togo/core/io/file_stream.hpp>
+
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <cstdio>
+
+namespace quanta {
+namespace object {
+
+namespace {
+
+enum : unsigned {
+	FILE_PATH_MAX = 4096,
+};
+
+static bool file_path_cstr(char* const buffer, StringRef const& path, StringRef const& suffix) {
+	if (path.size + suffix.size >= FILE_PATH_MAX) {
+		return false;
+	}
+	std::memcpy(buffer, path.data, path.size);
+	if (suffix.size > 0) {
+		std::memcpy(buffer + path.size, suffix.data, suffix.size);
+	}
+	buffer[path.size + suffix.size] = '\0';
+	return true;
+}
+
+#if defined(TOGO_PLATFORM_IS_POSIX)
+// Modification time of a file in nanoseconds
+static u64 file_stat_mtime(struct stat const& st) {
+#if defined(TOGO_PLATFORM_LINUX)
+	return
+		static_cast<u64>(st.st_mtim.tv_sec) * 1000000000u +
+		static_cast<u64>(st.st_mtim.tv_nsec)
+	;
+#else
+	return static_cast<u64>(st.st_mtime) * 1000000000u;
+#endif
+}
+#endif
+
+// Overwrite a file from offset with data, cutting it after the data if
+// truncate is true. Returns false without writing if the file does not have
+// the expected size and modification time or the platform does not support
+// it. mtime is set to the new modification time. A failed write leaves the
+// file partially written; the caller should replace it.
+static bool file_patch(
+	StringRef const& path,
+	u64 const expected_size,
+	u64 const expected_mtime,
+	u64 const offset,
+	u8 const* data,
+	unsigned size,
+	bool const truncate,
+	u64& mtime
+) {
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	char cpath[FILE_PATH_MAX];
+	if (!file_path_cstr(cpath, path, {})) {
+		return false;
+	}
+	signed const fd = ::open(cpath, O_WRONLY);
+	if (fd == -1) {
+		return false;
+	}
+	struct stat st;
+	bool success
+		= ::fstat(fd, &st) == 0
+		&& S_ISREG(st.st_mode)
+		&& static_cast<u64>(st.st_size) == expected_size
+		&& object::file_stat_mtime(st) == expected_mtime
+	;
+	u64 position = offset;
+	while (success && size > 0) {
+		ssize_t const written = ::pwrite(fd, data, size, static_cast<off_t>(position));
+		if (written <= 0) {
+			success = false;
+			break;
+		}
+		data += written;
+		size -= static_cast<unsigned>(written);
+		position += static_cast<u64>(written);
+	}
+	success
+		= success
+		&& (!truncate || ::ftruncate(fd, static_cast<off_t>(position)) == 0)
+		&& ::fstat(fd, &st) == 0
+	;
+	mtime = object::file_stat_mtime(st);
+	::close(fd);
+	return success;
+#else
+	(void)path; (void)expected_size; (void)expected_mtime;
+	(void)offset; (void)data; (void)size; (void)truncate;
+	mtime = 0;
+	return false;
+#endif
+}
+
+// Write data to a temporary file and rename it over path.
+// mtime is set to the new modification time.
+static bool file_replace(
+	StringRef const& path,
+	u8 const* const data,
+	unsigned const size,
+	u64& mtime
+) {
+	char cpath[FILE_PATH_MAX];
+	char temp_path[FILE_PATH_MAX];
+	if (
+		!file_path_cstr(cpath, path, {}) ||
+		!file_path_cstr(temp_path, path, ".tmp")
+	) {
+		return false;
+	}
+	FileWriter stream{};
+	if (!stream.open(StringRef{temp_path, cstr_tag{}}, false)) {
+		return false;
+	}
+	bool success = io::write(stream, data, size);
+	stream.close();
+	success = success && std::rename(temp_path, cpath) == 0;
+	if (!success) {
+		std::remove(temp_path);
+	}
+	mtime = 0;
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	struct stat st;
+	if (success && ::stat(cpath, &st) == 0) {
+		mtime = object::file_stat_mtime(st);
+	}
+#endif
+	return success;
+}
+
+enum : u32 {
+	// "QTL1"
+	TEXT_LAYOUT_MAGIC = 0x314C5451,
+};
+
+struct TextLayoutFileHeader {
+	u32 magic;
+	u32 num_records;
+	u64 size;
+	u64 mtime;
+	ObjectTextLayout::Part head;
+	ObjectTextLayout::Part tail;
+};
+
+static StringRef const s_text_layout_suffix{".layout", cstr_tag{}};
+
+// Load the layout saved next to path by text_layout_save().
+// layout is left empty if there is none or it cannot be read.
+static void text_layout_load(ObjectTextLayout& layout, StringRef const& path) {
+	char cpath[FILE_PATH_MAX];
+	if (!file_path_cstr(cpath, path, s_text_layout_suffix)) {
+		return;
+	}
+	FileReader stream{};
+	if (!stream.open(StringRef{cpath, cstr_tag{}})) {
+		return;
+	}
+	TextLayoutFileHeader header;
+	bool success
+		= io::read(stream, &header, sizeof(header))
+		&& header.magic == TEXT_LAYOUT_MAGIC
+	;
+	array::clear(layout.records);
+	// The count is only trusted as far as there is data for it
+	for (u32 i = 0; success && i < header.num_records; ++i) {
+		ObjectTextLayout::Part part;
+		success = io::read(stream, &part, sizeof(part));
+		if (success) {
+			array::push_back(layout.records, part);
+		}
+	}
+	stream.close();
+	if (success) {
+		layout.head = header.head;
+		layout.tail = header.tail;
+		layout.size = header.size;
+		layout.mtime = header.mtime;
+	} else {
+		array::clear(layout.records);
+	}
+}
+
+// Save layout next to path. A layout file that fails to save is removed,
+// since it is only a cache.
+static void text_layout_save(ObjectTextLayout const& layout, StringRef const& path) {
+	char cpath[FILE_PATH_MAX];
+	if (!file_path_cstr(cpath, path, s_text_layout_suffix)) {
+		return;
+	}
+	TextLayoutFileHeader const header{
+		TEXT_LAYOUT_MAGIC,
+		array::size(layout.records),
+		layout.size,
+		layout.mtime,
+		layout.head,
+		layout.tail,
+	};
+	FileWriter stream{};
+	if (!stream.open(StringRef{cpath, cstr_tag{}}, false)) {
+		return;
+	}
+	bool const success
+		= io::write(stream, &header, sizeof(header))
+		&& (array::empty(layout.records) || io::write(
+			stream, array::begin(layout.records),
+			array::size(layout.records) * sizeof(ObjectTextLayout::Part)
+		))
+	;
+	stream.close();
+	if (!success) {
+		std::remove(cpath);
+	}
+}
+
+} // anonymous namespace
+
+} // namespace object
+} // namespace quanta
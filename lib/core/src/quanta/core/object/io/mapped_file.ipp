@@ -0,0 +1,103 @@
+#line 2 "quanta/core/object/io/mapped_file.ipp"
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+*/
+
+#include <quanta/core/config.hpp>
+
+#include <togo/core/string/types.hpp>
+
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <climits>
+#endif
+
+#include <cstring>
+
+namespace quanta {
+namespace object {
+
+namespace {
+
+struct MappedFile {
+	void* data;
+	unsigned size;
+
+	~MappedFile();
+	MappedFile() : data(nullptr), size(0) {}
+
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+};
+
+inline StringRef mapped_file_ref(MappedFile const& file) {
+	return StringRef{static_cast<char const*>(file.data), file.size};
+}
+
+static void mapped_file_close(MappedFile& file) {
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	if (file.data && file.size > 0) {
+		::munmap(file.data, file.size);
+	}
+#endif
+	file.data = nullptr;
+	file.size = 0;
+}
+
+inline MappedFile::~MappedFile() {
+	mapped_file_close(*this);
+}
+
+// Map a whole regular file read-only.
+// Returns false if the platform or file does not support mapping, in which
+// case the caller should fall back to reading it through a stream.
+static bool mapped_file_open(MappedFile& file, StringRef const& path) {
+	mapped_file_close(file);
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	char cpath[PATH_MAX];
+	if (path.size >= PATH_MAX) {
+		return false;
+	}
+	std::memcpy(cpath, path.data, path.size);
+	cpath[path.size] = '\0';
+
+	signed const fd = ::open(cpath, O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > 0x7FFFFFFF) {
+		::close(fd);
+		return false;
+	}
+	if (st.st_size == 0) {
+		// Nothing to map; an empty buffer is still valid input
+		static char const s_empty = '\0';
+		file.data = const_cast<char*>(&s_empty);
+		file.size = 0;
+		::close(fd);
+		return true;
+	}
+	void* const data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	::madvise(data, st.st_size, MADV_SEQUENTIAL);
+	file.data = data;
+	file.size = static_cast<unsigned>(st.st_size);
+	return true;
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+} // anonymous namespace
+
+} // namespace object
+} // namespace quanta
@@ -9,9 +9,11 @@
 #include <togo/core/error/assert.hpp>
 #include <togo/core/utility/utility.hpp>
 #include <togo/core/collection/array.hpp>
+#include <togo/core/string/string.hpp>
 #include <togo/core/io/types.hpp>
 #include <togo/core/io/io.hpp>
 
+#include <limits>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
@@ -26,10 +28,15 @@ enum : unsigned {
 	PC_PEEK_EMPTY = PC_EOF - 1u,
 };
 
+enum : unsigned {
+	INPUT_BLOCK_SIZE = 16384,
+};
+
 enum : unsigned {
 	PF_NONE				= 0,
 	PF_ERROR			= 1 << 0, // error met
 	PF_CARRY			= 1 << 1, // carry the current parser char forward
+	PF_IDENTIFIER		= 1 << 2, // identifier value in buffer (might type a string)
 };
 
 enum ParserBufferType : unsigned {
@@ -139,8 +146,24 @@ enum : unsigned {
 };
 
 enum : unsigned {
-	OF_NONE		= 0,
-	OF_TAG		= 1 << 0,
+	OF_NONE					= 0,
+	OF_TAG					= 1 << 0,
+
+	// Visitor event to send when the branch is first executed
+	OF_BEGIN				= 1 << 1,
+	OF_WRAP_EXPRESSION		= 1 << 2,
+	OF_WRAP_COLLECTION		= 1 << 3,
+
+	// Parts met (in place of querying the object)
+	OF_VALUE				= 1 << 4, // non-null value
+	OF_VALUE_UNCERTAIN		= 1 << 5,
+	OF_CURRENCY				= 1 << 6,
+
+	OF_M_EVENT
+		= OF_BEGIN
+		| OF_WRAP_EXPRESSION
+		| OF_WRAP_COLLECTION
+	,
 };
 
 enum class Response {
@@ -171,16 +194,29 @@ struct Stage {
 
 struct ObjectParser {
 	struct Branch {
-		Object* obj;
 		Stage const** sequence_pos;
 		bool any_part;
 		unsigned flags;
+		ObjectVisitKind kind;
+		ObjectOperator op;
 	};
 
-	IReader& stream;
+	IReader* stream;
 	ObjectParserInfo& info;
+	IObjectVisitor& visitor;
+	ObjectTextCheckpoint* checkpoint;
 	Array<Branch> stack;
 	Array<char> buffer;
+	// Type of a typed string (the identifier read before it)
+	Array<char> string_type;
+	// The string in buffer as it lies in contiguous input, if it does
+	StringRef string_span;
+	u8 const* input_begin;
+	u8 const* input_pos;
+	u8 const* input_end;
+	u64 input_offset;
+	bool input_eof;
+	u8 input_last;
 	unsigned line;
 	unsigned column;
 	unsigned c;
@@ -190,15 +226,81 @@ struct ObjectParser {
 	unsigned hop_count;
 	unsigned time_parts;
 	struct {
-		unsigned point;
-	} currency_parts;
+		bool converted;
+		Date date;
+		signed h, m, s;
+		signed zone_h, zone_m;
+		bool zone_negative;
+	} time_values;
+	struct {
+		u64 mantissa;
+		unsigned num_digits;
+		s32 point_exponent;
+		unsigned exponent;
+		bool negative;
+		bool exponent_negative;
+	} number_parts;
 	Branch* branch;
+	// Top-level objects begun
+	unsigned num_objects;
+	// Block buffer for stream input; null when scanning contiguous input
+	u8* input;
+	Allocator& input_allocator;
+
+	ObjectParser(ObjectParser&&) = delete;
+	ObjectParser(ObjectParser const&) = delete;
+	ObjectParser& operator=(ObjectParser&&) = delete;
+	ObjectParser& operator=(ObjectParser const&) = delete;
+
+	~ObjectParser() {
+		if (input) {
+			input_allocator.deallocate(input);
+		}
+	}
+
+	ObjectParser(IReader& stream, IObjectVisitor& visitor, ObjectParserInfo& info, Allocator& allocator)
+		: stream(&stream)
+		, info(info)
+		, visitor(visitor)
+		, checkpoint(nullptr)
+		, stack(allocator)
+		, buffer(allocator)
+		, string_type(allocator)
+		, string_span()
+		, input_begin(nullptr)
+		, input_pos(nullptr)
+		, input_end(nullptr)
+		, input_offset(0)
+		, input_eof(false)
+		, input_last('\0')
+		, num_objects(0)
+		, input(static_cast<u8*>(allocator.allocate(INPUT_BLOCK_SIZE, 1)))
+		, input_allocator(allocator)
+	{
+		input_begin = input;
+		input_pos = input;
+		input_end = input;
+	}
 
-	ObjectParser(IReader& stream, ObjectParserInfo& info, Allocator& allocator)
-		: stream(stream)
+	// Scan contiguous input directly (no stream)
+	ObjectParser(StringRef data, IObjectVisitor& visitor, ObjectParserInfo& info, Allocator& allocator)
+		: stream(nullptr)
 		, info(info)
+		, visitor(visitor)
+		, checkpoint(nullptr)
 		, stack(allocator)
 		, buffer(allocator)
+		, string_type(allocator)
+		, string_span()
+		, input_begin(reinterpret_cast<u8 const*>(data.data))
+		, input_pos(input_begin)
+		, input_end(input_begin + data.size)
+		, input_offset(0)
+		, input_eof(true)
+		, input_last('\0')
+		, num_objects(0)
+		, input(nullptr)
+		, input_allocator(allocator)
 	{}
 };
 
@@ -236,6 +338,10 @@ static bool parser_error(
 #define PARSER_ERROR_STREAM(p, what) \
 	PARSER_ERRORF(p, "%s: stream read failure", what)
 
+// Send an event to the visitor
+#define PARSER_VISIT(p, event) \
+	((p).visitor.event || PARSER_ERROR(p, "stopped by visitor"))
+
 inline static void parser_buffer_add(ObjectParser& p) {
 	TOGO_DEBUG_ASSERTE(p.c != PC_EOF);
 	array::push_back(p.buffer, static_cast<char>(p.c));
@@ -244,6 +350,7 @@ inline static void parser_buffer_add(ObjectParser& p) {
 inline static void parser_buffer_clear(ObjectParser& p) {
 	array::clear(p.buffer);
 	p.buffer_type = PB_NONE;
+	p.string_span = {};
 }
 
 inline static unsigned parser_buffer_size(ObjectParser const& p) {
@@ -254,16 +361,70 @@ inline static StringRef parser_buffer_ref(ObjectParser const& p) {
 	return StringRef{array::begin(p.buffer), parser_buffer_size(p)};
 }
 
-inline static void parser_push(ObjectParser& p, Object& obj, Stage const** sequence_pos, unsigned const flags = OF_NONE) {
-	p.branch = &array::push_back(p.stack, {&obj, sequence_pos, false, flags});
+// Start of the next character in contiguous input, or null
+inline static u8 const* parser_input_mark(ObjectParser const& p) {
+	return !p.input && p.nc == PC_PEEK_EMPTY && ~p.flags & PF_CARRY ? p.input_pos : nullptr;
+}
+
+// Record the string just read into buffer as the input between begin and
+// end. Escapes and dropped CRs only remove characters, so the two are the
+// same if their sizes are.
+inline static void parser_set_string_span(ObjectParser& p, u8 const* const begin, u8 const* const end) {
+	unsigned const size = parser_buffer_size(p);
+	if (begin && end && static_cast<unsigned>(end - begin) == size) {
+		p.string_span = StringRef{reinterpret_cast<char const*>(begin), size};
+		TOGO_DEBUG_ASSERTE(string::compare_equal(p.string_span, parser_buffer_ref(p)));
+	} else {
+		p.string_span = {};
+	}
+}
+
+inline static void parser_push(
+	ObjectParser& p,
+	Stage const** sequence_pos,
+	unsigned const flags = OF_NONE,
+	ObjectVisitKind const kind = ObjectVisitKind::child,
+	ObjectOperator const op = ObjectOperator::none
+) {
+	p.branch = &array::push_back(p.stack, {sequence_pos, false, flags, kind, op});
 	// TOGO_LOGF("push: %2lu %s\n", array::size(p.stack), (*sequence_pos)->name.data);
 }
 
-inline static void parser_pop(ObjectParser& p) {
+// Push a branch for a new object
+inline static void parser_push_object(
+	ObjectParser& p,
+	Stage const** sequence_pos,
+	ObjectVisitKind const kind,
+	unsigned const flags = OF_NONE,
+	ObjectOperator const op = ObjectOperator::none
+) {
+	parser_push(p, sequence_pos, flags | OF_BEGIN, kind, op);
+}
+
+// Pop the branch of an object
+inline static bool parser_pop(ObjectParser& p) {
 	TOGO_DEBUG_ASSERTE(array::any(p.stack));
 	// TOGO_LOGF("pop : %2lu %s\n", array::size(p.stack), (*p.branch->sequence_pos)->name.data);
 	array::pop_back(p.stack);
 	p.branch = array::any(p.stack) ? &array::back(p.stack) : nullptr;
+	return PARSER_VISIT(p, end_object());
+}
+
+// Send the event of a branch that was pushed since the last stage
+static bool parser_send_branch_event(ObjectParser& p) {
+	auto& branch = *p.branch;
+	unsigned const flags = branch.flags;
+	branch.flags &= ~OF_M_EVENT;
+	if (flags & OF_BEGIN) {
+		return
+			PARSER_VISIT(p, begin_object(branch.kind, p.line)) &&
+			(branch.kind != ObjectVisitKind::operand || PARSER_VISIT(p, op(branch.op)))
+		;
+	} else if (flags & OF_WRAP_EXPRESSION) {
+		return PARSER_VISIT(p, wrap(ObjectVisitWrap::expression, p.line));
+	} else {
+		return PARSER_VISIT(p, wrap(ObjectVisitWrap::collection, p.line));
+	}
 }
 
 inline static unsigned parser_parent_flags(ObjectParser const& p) {
@@ -271,30 +432,43 @@ inline static unsigned parser_parent_flags(ObjectParser const& p) {
 	return (*p.stack[array::size(p.stack) - 2].sequence_pos)->flags;
 }
 
-static void parser_move_object_into_child(Object& obj) {
-	auto& children = object::children(obj);
-	{
-	auto& last = array::push_back_inplace(children);
-	auto name = obj.name;
-	obj.name = {};
-	object::copy(last, obj, false);
-	obj.name = name;
-	}
-	// Copy children
-	if (array::size(children) > 1) {
-		auto last = end(children) - 1;
-		auto& last_children = object::children(*last);
-		for (auto it = begin(children); it != last; ++it) {
-			array::push_back_inplace(last_children, rvalue_ref(*it));
+static bool parser_input_fill(ObjectParser& p) {
+	if (p.input_eof) {
+		return true;
+	}
+	if (p.input_end != p.input_begin) {
+		p.input_offset += static_cast<u64>(p.input_end - p.input_begin);
+		p.input_last = p.input_end[-1];
+	}
+	p.input_begin = p.input;
+	p.input_pos = p.input;
+	p.input_end = p.input;
+	unsigned read_size = 0;
+	io::read(*p.stream, p.input, INPUT_BLOCK_SIZE, &read_size);
+	IOStatus const& status = io::status(*p.stream);
+	if (status.eof()) {
+		p.input_eof = true;
+	} else if (status.fail()) {
+		return false;
+	}
+	p.input_end = p.input + read_size;
+	return true;
+}
+
+// Take the next input byte, skipping '\r'
+static bool parser_input_next(ObjectParser& p, unsigned& c) {
+	do {
+		if (p.input_pos == p.input_end) {
+			if (!parser_input_fill(p)) {
+				return false;
+			} else if (p.input_pos == p.input_end) {
+				c = PC_EOF;
+				return true;
+			}
 		}
-		array::remove_over(children, 0);
-		array::resize(children, 1);
-	}
-	object::set_null(obj);
-	object::clear_value_markers(obj);
-	object::clear_source(obj);
-	object::clear_tags(obj);
-	object::release_quantity(obj);
+		c = *p.input_pos++;
+	} while (c == '\r');
+	return true;
 }
 
 static bool parser_next(ObjectParser& p) {
@@ -304,20 +478,12 @@ static bool parser_next(ObjectParser& p) {
 	} else if (p.nc != PC_PEEK_EMPTY) {
 		p.c = p.nc;
 		p.nc = PC_PEEK_EMPTY;
-		goto l_return;
-	}
-
-	{u8 c = '\0';
-	do {} while (io::read_value(p.stream, c) && c == '\r');
-	p.c = c;
-	IOStatus const& status = io::status(p.stream);
-	if (status.eof()) {
-		p.c = PC_EOF;
-	} else if (status.fail()) {
+	} else if (p.input_pos != p.input_end && *p.input_pos != '\r') {
+		p.c = *p.input_pos++;
+	} else if (!parser_input_next(p, p.c)) {
 		return PARSER_ERROR_STREAM(p, "parser_next()");
-	}}
+	}
 
-l_return:
 	if (p.c == '\n') {
 		++p.line;
 		p.column = 0;
@@ -327,17 +493,70 @@ l_return:
 	return true;
 }
 
+// Stream offset of the current character (or of EOF)
+inline static u64 parser_offset(ObjectParser const& p) {
+	TOGO_DEBUG_ASSERTE(p.nc == PC_PEEK_EMPTY);
+	return
+		p.input_offset
+		+ static_cast<u64>(p.input_pos - p.input_begin)
+		- (p.c == PC_EOF ? 0 : 1)
+	;
+}
+
+// Last byte of the input before EOF
+inline static unsigned parser_input_last(ObjectParser const& p) {
+	return p.input_pos != p.input_begin ? p.input_pos[-1] : p.input_last;
+}
+
+// Record the position after the last complete top-level object.
+// Called at the root before reading the next object (or at EOF).
+static void parser_checkpoint(ObjectParser& p) {
+	auto& checkpoint = *p.checkpoint;
+	if (p.c == PC_EOF) {
+		switch (parser_input_last(p)) {
+		case '\n':
+		case ',': case ';':
+			break;
+
+		default:
+			// The last object might continue in appended input
+			return;
+		}
+	} else if (p.nc != PC_PEEK_EMPTY) {
+		return;
+	}
+	checkpoint.offset = parser_offset(p);
+	checkpoint.line = p.line;
+	checkpoint.column = p.column - 1;
+	checkpoint.num_children = p.num_objects;
+}
+
+// Consume the run of input bytes following the current character.
+// The run only extends to the end of the input block; the byte ending it is
+// left for parser_next().
+template<class S>
+inline static void parser_scan_run(ObjectParser& p, bool const add) {
+	if (p.flags & PF_CARRY || p.nc != PC_PEEK_EMPTY) {
+		return;
+	}
+	u8 const* const run_end = scan_run<S>(p.input_pos, p.input_end);
+	unsigned const size = static_cast<unsigned>(run_end - p.input_pos);
+	if (size == 0) {
+		return;
+	}
+	if (add) {
+		unsigned const buffer_size = parser_buffer_size(p);
+		array::resize(p.buffer, buffer_size + size);
+		std::memcpy(array::begin(p.buffer) + buffer_size, p.input_pos, size);
+	}
+	p.input_pos = run_end;
+	p.column += size;
+}
+
 static bool parser_peek(ObjectParser& p) {
 	if (p.nc != PC_PEEK_EMPTY) {
 		return p.nc;
-	}
-	u8 c = '\0';
-	do {} while (io::read_value(p.stream, c) && c == '\r');
-	p.nc = c;
-	IOStatus const& status = io::status(p.stream);
-	if (status.eof()) {
-		p.nc = PC_EOF;
-	} else if (status.fail()) {
+	} else if (!parser_input_next(p, p.nc)) {
 		return PARSER_ERROR_STREAM(p, "parser_peek()");
 	}
 	return true;
@@ -409,9 +628,12 @@ static bool parser_skip_junk(ObjectParser& p, bool stage_exit) {
 		if (!filter_newline) {
 			return true;
 		}
+		parser_scan_run<ScanBlank>(p, false);
+		break;
 
 	case '\t':
 	case ' ':
+		parser_scan_run<ScanBlank>(p, false);
 		break;
 
 	case ',': case ';':
@@ -428,10 +650,12 @@ static bool parser_skip_junk(ObjectParser& p, bool stage_exit) {
 			return false;
 		}
 		if (p.c == '\\') {
+			parser_scan_run<ScanLineComment>(p, false);
 			while (parser_next(p)) {
 				if (p.c == '\n' || p.c == PC_EOF) {
 					goto l_continue;
 				}
+				parser_scan_run<ScanLineComment>(p, false);
 			}
 			return false;
 		} else if (p.c == '*') {
@@ -467,6 +691,7 @@ static bool parser_skip_junk(ObjectParser& p, bool stage_exit) {
 				default:
 					head = false;
 					tail = false;
+					parser_scan_run<ScanBlockComment>(p, false);
 					break;
 				}
 			}
@@ -485,7 +710,241 @@ static bool parser_skip_junk(ObjectParser& p, bool stage_exit) {
 	return false;
 }
 
+// Fixed-width time literals
+//
+// Patterns use '0' for a digit and any other byte for itself. Up to 8 bytes
+// are matched at once as a little-endian word.
+
+constexpr u64 time_pattern_word(char const* const pattern, unsigned const size, bool const digits, unsigned const i = 0) {
+	return i == size ? 0 : (
+		(u64{static_cast<u8>(
+			digits
+			? (pattern[i] == '0' ? 0xFF : 0x00)
+			: (pattern[i] == '0' ? 0x00 : pattern[i])
+		)} << (8 * i)) |
+		time_pattern_word(pattern, size, digits, i + 1)
+	);
+}
+
+constexpr u64 time_pattern_literal_mask(char const* const pattern, unsigned const size, unsigned const i = 0) {
+	return i == size ? 0 : (
+		(u64{pattern[i] == '0' ? 0x00u : 0xFFu} << (8 * i)) |
+		time_pattern_literal_mask(pattern, size, i + 1)
+	);
+}
+
+inline static bool time_match_word(u8 const* const s, char const* const pattern, unsigned const size) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if (size == 8) {
+		u64 word;
+		std::memcpy(&word, s, 8);
+		u64 const digit_mask = time_pattern_word(pattern, 8, true);
+		u64 const literal_mask = time_pattern_literal_mask(pattern, 8);
+		u64 const digit_bytes = word & digit_mask;
+		return
+			(word & literal_mask) == time_pattern_word(pattern, 8, false) &&
+			// High nibble 3 and low nibble <= 9 ('0'..'9')
+			(digit_bytes & (0xF0F0F0F0F0F0F0F0 & digit_mask)) == (0x3030303030303030 & digit_mask) &&
+			((digit_bytes + (0x0606060606060606 & digit_mask)) & (0xF0F0F0F0F0F0F0F0 & digit_mask))
+				== (0x3030303030303030 & digit_mask)
+		;
+	}
+#endif
+	for (unsigned i = 0; i < size; ++i) {
+		if (pattern[i] == '0' ? (s[i] < '0' || s[i] > '9') : s[i] != static_cast<u8>(pattern[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Match size bytes (<= 16) against pattern
+template<unsigned N>
+inline static bool time_match(u8 const* const s, char const (&pattern)[N]) {
+	enum : unsigned { size = N - 1 };
+	static_assert(size <= 16, "");
+	if (size < 8) {
+		return time_match_word(s, pattern, size);
+	}
+	// Overlapping words
+	return
+		time_match_word(s, pattern, 8) &&
+		time_match_word(s + (size - 8), pattern + (size - 8), 8)
+	;
+}
+
+inline static signed time_digits(u8 const* const s, unsigned const size) {
+	signed value = 0;
+	for (unsigned i = 0; i < size; ++i) {
+		value = value * 10 + (s[i] - '0');
+	}
+	return value;
+}
+
+inline static bool parser_is_time_terminator(unsigned const c) {
+	switch (c) {
+	case PC_EOF:
+	case '\t':
+	case '\n':
+	case ' ':
+	case ',': case ';':
+	case '=': case '$':
+	case '}': case ']': case ')':
+	case '{': case '[': case '(':
+	case '*': case '/':
+	case '\\':
+		return true;
+	}
+	return false;
+}
+
+// Whether the input at s (size bytes available) ends a time literal
+inline static bool parser_time_terminated(ObjectParser const& p, u8 const* const s, unsigned const available) {
+	if (available == 0) {
+		return p.input_eof;
+	} else if (*s == '\r') {
+		return available > 1 && s[1] == '\n';
+	}
+	return parser_is_time_terminator(*s);
+}
+
+// Read the common complete time shapes in place:
+//
+//   YYYY-MM-DD[Z]
+//   YYYY-MM-DDTHH:MM[:SS][Z|(+|-)HH:MM]
+//   HH:MM[:SS][Z|(+|-)HH:MM]
+//
+// p.c is the separator following YYYY or HH in the buffer. On success, the
+// literal is consumed up to its terminator (or 'Z'), which is made the current
+// character. Returns false without consuming anything if the input does not
+// have one of the shapes within the current input block; the general path
+// handles it instead.
+static bool parser_read_time_fixed(ObjectParser& p) {
+	if (p.flags & PF_CARRY || p.nc != PC_PEEK_EMPTY) {
+		return false;
+	}
+	auto const& buffer = p.buffer;
+	u8 const* const s = p.input_pos;
+	unsigned const available = static_cast<unsigned>(p.input_end - s);
+	auto& tv = p.time_values;
+	unsigned parts;
+	unsigned size;
+	bool zone_offset = true;
+	if (p.c == '-' && array::size(buffer) == 4) {
+		if (available >= 14 && time_match(s, "00-00T00:00:00")) {
+			parts = TSP_D_ELEMENTS | TSP_T_MARKER | TSP_T_ELEMENTS;
+			size = 14;
+		} else if (available >= 11 && time_match(s, "00-00T00:00")) {
+			parts = TSP_D_ELEMENTS | TSP_T_MARKER | TSP_T_HH | TSP_T_MM;
+			size = 11;
+		} else if (available >= 5 && time_match(s, "00-00")) {
+			parts = TSP_D_ELEMENTS;
+			size = 5;
+			zone_offset = false;
+		} else {
+			return false;
+		}
+		tv.date.year = time_digits(reinterpret_cast<u8 const*>(array::begin(buffer)), 4);
+		tv.date.month = time_digits(s, 2);
+		tv.date.day = time_digits(s + 3, 2);
+		if (parts & TSP_T_ELEMENTS) {
+			tv.h = time_digits(s + 6, 2);
+			tv.m = time_digits(s + 9, 2);
+			tv.s = parts & TSP_T_SS ? time_digits(s + 12, 2) : 0;
+		}
+	} else if (p.c == ':' && array::size(buffer) == 2) {
+		if (available >= 5 && time_match(s, "00:00")) {
+			parts = TSP_T_ELEMENTS;
+			size = 5;
+		} else if (available >= 2 && time_match(s, "00")) {
+			parts = TSP_T_HH | TSP_T_MM;
+			size = 2;
+		} else {
+			return false;
+		}
+		tv.date = {};
+		tv.h = time_digits(reinterpret_cast<u8 const*>(array::begin(buffer)), 2);
+		tv.m = time_digits(s, 2);
+		tv.s = parts & TSP_T_SS ? time_digits(s + 3, 2) : 0;
+	} else {
+		return false;
+	}
+
+	tv.zone_h = 0;
+	tv.zone_m = 0;
+	tv.zone_negative = false;
+	u8 const* const zone = s + size;
+	unsigned const zone_available = available - size;
+	if (zone_available > 0 && *zone == 'Z') {
+		parts |= TSP_Z_UTC;
+		size += 1;
+	} else if (
+		zone_offset &&
+		zone_available >= 6 &&
+		(*zone == '+' || *zone == '-') &&
+		time_match(zone + 1, "00:00") &&
+		parser_time_terminated(p, zone + 6, zone_available - 6)
+	) {
+		parts |= TSP_Z_SIGN | TSP_Z_ELEMENTS;
+		tv.zone_negative = *zone == '-';
+		tv.zone_h = time_digits(zone + 1, 2);
+		tv.zone_m = time_digits(zone + 4, 2);
+		size += 6;
+	} else if (!parser_time_terminated(p, zone, zone_available)) {
+		return false;
+	}
+
+	// The literal has no newlines; the terminator goes through parser_next()
+	p.input_pos += size;
+	p.column += size;
+	p.c = p.input_pos[-1];
+	parser_buffer_clear(p);
+	tv.converted = true;
+	p.time_parts = parts;
+	p.buffer_type = PB_TIME;
+	return true;
+}
+
+// Convert time parts read by the general path from the buffer
+static void parser_convert_time(ObjectParser& p) {
+	auto& tv = p.time_values;
+	tv = {};
+	auto it = begin(parser_buffer_ref(p));
+	switch (p.time_parts & TSP_D_ELEMENTS) {
+	case TSP_D_YYYY | TSP_D_MM | TSP_D_DD:
+		tv.date.year = parse_integer_unsigned(it, it + 4);
+	case TSP_D_MM | TSP_D_DD:
+		tv.date.month = parse_integer_unsigned(it, it + 2);
+	case TSP_D_DD:
+		tv.date.day = parse_integer_unsigned(it, it + 2);
+	}
+	if (p.time_parts & TSP_T_ELEMENTS) {
+		tv.h = parse_integer_unsigned(it, it + 2);
+		tv.m = parse_integer_unsigned(it, it + 2);
+		if (p.time_parts & TSP_T_SS) {
+			tv.s = parse_integer_unsigned(it, it + 2);
+		}
+	}
+	if (~p.time_parts & TSP_Z_UTC && p.time_parts & TSP_Z_ELEMENTS) {
+		if (p.time_parts & TSP_Z_SIGN) {
+			tv.zone_negative = *it++ == '-';
+		}
+		tv.zone_h = parse_integer_unsigned(it, it + 2);
+		if (p.time_parts & TSP_Z_MM) {
+			tv.zone_m = parse_integer_unsigned(it, it + 2);
+		}
+	}
+	TOGO_DEBUG_ASSERTE(it == end(parser_buffer_ref(p)));
+	tv.converted = true;
+}
+
 static bool parser_read_time(ObjectParser& p) {
+	p.time_values.converted = false;
+	if (parser_read_time_fixed(p)) {
+		// Consume Z or the last byte of the literal like the general path
+		return parser_next(p);
+	}
+
 	// day:
 	//   DD
 	// date:
@@ -731,6 +1190,17 @@ static bool parser_read_time(ObjectParser& p) {
 #undef SET_PART
 }
 
+// Accumulate a mantissa digit; the value is exact while num_digits <= 19
+inline static void parser_number_add_digit(ObjectParser& p, unsigned const digit) {
+	auto& n = p.number_parts;
+	if (n.mantissa != 0 || digit != 0) {
+		++n.num_digits;
+	}
+	if (n.num_digits <= 19) {
+		n.mantissa = n.mantissa * 10 + digit;
+	}
+}
+
 static bool parser_read_number(ObjectParser& p) {
 	enum : unsigned {
 		PART_SIGN				= 1 << 0,
@@ -742,6 +1212,7 @@ static bool parser_read_number(ObjectParser& p) {
 		PART_EXPONENT_NUMERAL	= 1 << 6,
 	};
 	unsigned parts = 0;
+	p.number_parts = {};
 	do {
 		switch (p.c) {
 		// Completers
@@ -773,8 +1244,10 @@ static bool parser_read_number(ObjectParser& p) {
 			}
 			if (parts & PART_EXPONENT) {
 				parts |= PART_EXPONENT_SIGN;
+				p.number_parts.exponent_negative = p.c == '-';
 			} else if (parts == 0) {
 				parts |= PART_SIGN;
+				p.number_parts.negative = p.c == '-';
 			} else {
 				return PARSER_ERROR_UNEXPECTED(p, "non-leading sign in number");
 			}
@@ -819,10 +1292,17 @@ static bool parser_read_number(ObjectParser& p) {
 			if (p.c >= '0' && p.c <= '9') {
 				if (parts & PART_EXPONENT) {
 					parts |= PART_EXPONENT_NUMERAL;
+					// Anything larger is out of range for f64 anyway
+					if (p.number_parts.exponent < 100000) {
+						p.number_parts.exponent = p.number_parts.exponent * 10 + (p.c - '0');
+					}
 				} else if (parts & PART_DECIMAL) {
 					parts |= PART_NUMERAL | PART_DECIMAL_NUMERAL;
+					parser_number_add_digit(p, p.c - '0');
+					--p.number_parts.point_exponent;
 				} else {
 					parts |= PART_NUMERAL;
+					parser_number_add_digit(p, p.c - '0');
 				}
 			} else {
 				goto l_complete;
@@ -872,6 +1352,7 @@ static bool parser_read_identifier(
 			return true;
 		}
 		parser_buffer_add(p);
+		parser_scan_run<ScanIdentifier>(p, true);
 	} while (parser_next(p));
 	return false;
 }
@@ -888,6 +1369,7 @@ static bool parser_read_currency(ObjectParser& p) {
 		return false;
 	}
 	unsigned parts = 0;
+	p.number_parts = {};
 	do {
 		switch (p.c) {
 		// Completers
@@ -911,6 +1393,7 @@ static bool parser_read_currency(ObjectParser& p) {
 				return PARSER_ERROR_UNEXPECTED(p, "non-leading sign in currency value");
 			}
 			parts |= PART_SIGN;
+			p.number_parts.negative = p.c == '-';
 			break;
 
 		case '.':
@@ -918,15 +1401,17 @@ static bool parser_read_currency(ObjectParser& p) {
 				return PARSER_ERROR(p, "decimal point already specified for currency value");
 			}
 			parts |= PART_DECIMAL;
-			p.currency_parts.point = parser_buffer_size(p);
 			break;
 
 		default:
 			if (p.c >= '0' && p.c <= '9') {
-				parts |= (parts & PART_DECIMAL)
-					? PART_DECIMAL_NUMERAL
-					: PART_NUMERAL
-				;
+				if (parts & PART_DECIMAL) {
+					parts |= PART_DECIMAL_NUMERAL;
+					--p.number_parts.point_exponent;
+				} else {
+					parts |= PART_NUMERAL;
+				}
+				parser_number_add_digit(p, p.c - '0');
 			} else {
 				goto l_complete;
 			}
@@ -942,8 +1427,9 @@ l_complete:
 	} else if (parts & PART_DECIMAL && ~parts & PART_DECIMAL_NUMERAL) {
 		return PARSER_ERROR(p, "missing numeral part after decimal in currency value");
 	}
-	if (~parts & PART_DECIMAL) {
-		p.currency_parts.point = parser_buffer_size(p);
+	auto const& n = p.number_parts;
+	if (n.num_digits > 19 || n.mantissa > static_cast<u64>(std::numeric_limits<s64>::max())) {
+		return PARSER_ERROR(p, "currency value out of range");
 	}
 	p.buffer_type = PB_CURRENCY;
 	return true;
@@ -951,6 +1437,7 @@ l_complete:
 
 static bool parser_read_string_quote(ObjectParser& p) {
 	bool escaped = false;
+	u8 const* const begin = parser_input_mark(p);
 	while (parser_next(p)) {
 		switch (p.c) {
 		case PC_EOF:
@@ -961,10 +1448,12 @@ static bool parser_read_string_quote(ObjectParser& p) {
 
 		case '"':
 			if (!escaped) {
+				u8 const* const end = parser_input_mark(p);
 				if (!parser_next(p)) {
 					return false;
 				}
 				p.buffer_type = PB_STRING;
+				parser_set_string_span(p, begin, end ? end - 1 : nullptr);
 				return true;
 			}
 			break;
@@ -981,6 +1470,7 @@ static bool parser_read_string_quote(ObjectParser& p) {
 			escaped = false;
 		}
 		parser_buffer_add(p);
+		parser_scan_run<ScanStringQuote>(p, true);
 	}
 	return false;
 }
@@ -1000,6 +1490,7 @@ static bool parser_read_string_block(ObjectParser& p) {
 
 l_parse:
 	count = 0;
+	u8 const* const begin = parser_input_mark(p);
 	while (parser_next(p)) {
 		switch (p.c) {
 		case PC_EOF:
@@ -1007,11 +1498,13 @@ l_parse:
 
 		case '`':
 			if (++count == 3) {
+				u8 const* const end = parser_input_mark(p);
 				if (!parser_next(p)) {
 					return false;
 				}
 				p.buffer_type = PB_STRING;
 				array::resize(p.buffer, array::size(p.buffer) - 2);
+				parser_set_string_span(p, begin, end ? end - 3 : nullptr);
 				return true;
 			}
 			break;
@@ -1021,6 +1514,9 @@ l_parse:
 			break;
 		}
 		parser_buffer_add(p);
+		if (count == 0) {
+			parser_scan_run<ScanStringBlock>(p, true);
+		}
 	}
 	return false;
 }
@@ -1095,7 +1591,7 @@ static bool parser_read_source(ObjectParser& p) {
 	return false;
 }
 
-static void parser_apply(ObjectParser& p, ApplyBufferAs const apply_as = ApplyBufferAs::value) {
+static bool parser_apply(ObjectParser& p, ApplyBufferAs const apply_as = ApplyBufferAs::value) {
 	/*TOGO_LOGF(
 		"apply %u, [%.*s]\n",
 		unsigned_cast(p.buffer_type),
@@ -1103,7 +1599,8 @@ static void parser_apply(ObjectParser& p, ApplyBufferAs const apply_as = ApplyBu
 		array::begin(p.buffer)
 	);*/
 	TOGO_DEBUG_ASSERTE(p.buffer_type != PB_NONE);
-	auto& obj = *p.branch->obj;
+	bool sent = false;
+	ObjectVisitValue value{};
 	switch (apply_as) {
 	case ApplyBufferAs::value:
 		switch (p.buffer_type) {
@@ -1113,171 +1610,154 @@ static void parser_apply(ObjectParser& p, ApplyBufferAs const apply_as = ApplyBu
 			break;
 
 		case PB_MARKER_UNCERTAINTY:
-			object::set_value_certain(obj, false);
+			sent = PARSER_VISIT(p, marker(ObjectValueMarker::uncertain, 0));
+			p.branch->flags |= OF_VALUE_UNCERTAIN;
 			break;
 
 		case PB_MARKER_GUESS:
-			object::set_value_guess(obj, true);
+			sent = PARSER_VISIT(p, marker(ObjectValueMarker::guess, 0));
 			break;
 
 		case PB_MARKER_APPROXIMATION: {
-			signed value = signed_cast(array::size(p.buffer));
-			value = p.buffer[0] == '~' ? -value : value;
-			object::set_value_approximation(obj, value);
+			signed approximation = signed_cast(array::size(p.buffer));
+			approximation = p.buffer[0] == '~' ? -approximation : approximation;
+			sent = PARSER_VISIT(p, marker(ObjectValueMarker::approximate, approximation));
 		}	break;
 
 		case PB_NULL:
-			object::set_null(obj);
+			value.type = ObjectValueType::null;
 			break;
 
 		case PB_FALSE:
-			object::set_boolean(obj, false);
-			break;
-
 		case PB_TRUE:
-			object::set_boolean(obj, true);
+			value.type = ObjectValueType::boolean;
+			value.boolean = p.buffer_type == PB_TRUE;
 			break;
 
-		case PB_INTEGER:
-			array::push_back(p.buffer, '\0');
-			object::set_integer(obj, parse_s64(array::begin(p.buffer), 10));
-			break;
+		case PB_INTEGER: {
+			auto const& n = p.number_parts;
+			value.type = ObjectValueType::integer;
+			if (n.num_digits <= 19 && n.mantissa <= static_cast<u64>(std::numeric_limits<s64>::max())) {
+				s64 const integer = static_cast<s64>(n.mantissa);
+				value.integer = n.negative ? -integer : integer;
+			} else {
+				// Out of range; saturate like strtoll()
+				array::push_back(p.buffer, '\0');
+				value.integer = parse_s64(array::begin(p.buffer), 10);
+			}
+		}	break;
 
-		case PB_DECIMAL:
-			array::push_back(p.buffer, '\0');
-			object::set_decimal(obj, parse_f64(array::begin(p.buffer)));
-			break;
+		case PB_DECIMAL: {
+			auto const& n = p.number_parts;
+			s32 const exponent = n.point_exponent + (n.exponent_negative
+				? -signed_cast(n.exponent)
+				:  signed_cast(n.exponent)
+			);
+			value.type = ObjectValueType::decimal;
+			if (n.num_digits <= 19 && parse_decimal_exact(n.mantissa, exponent, value.decimal)) {
+				value.decimal = n.negative ? -value.decimal : value.decimal;
+			} else {
+				array::push_back(p.buffer, '\0');
+				value.decimal = parse_f64(array::begin(p.buffer));
+			}
+		}	break;
 
 		case PB_STRING:
-			object::set_string(obj, parser_buffer_ref(p));
+			value.type = ObjectValueType::string;
+			value.string = p.string_span.data ? p.string_span : parser_buffer_ref(p);
+			if (array::any(p.string_type)) {
+				value.string_type = StringRef{array::begin(p.string_type), static_cast<unsigned>(array::size(p.string_type))};
+			}
 			break;
 
 		case PB_IDENTIFIER:
-			object::set_identifier(obj, parser_buffer_ref(p));
-			break;
+			// Sent by stage_typed_string, which reads the string if the
+			// identifier is its type
+			p.flags |= PF_IDENTIFIER;
+			p.branch->flags |= OF_VALUE;
+			p.branch->any_part = true;
+			return true;
 
 		case PB_TIME: {
-			bool has_date = false;
-			bool has_clock = false;
-			Date date{};
-			signed h, m, s;
-			h = m = s = 0;
-
-			object::set_time_value(obj, {});
-			object::set_zoned(obj, false);
-			auto it = begin(parser_buffer_ref(p));
-			switch (p.time_parts & TSP_D_ELEMENTS) {
-			case TSP_D_YYYY | TSP_D_MM | TSP_D_DD:
-				date.year = parse_integer_unsigned(it, it + 4);
-			case TSP_D_MM | TSP_D_DD:
-				date.month = parse_integer_unsigned(it, it + 2);
-			case TSP_D_DD:
-				date.day = parse_integer_unsigned(it, it + 2);
-				has_date = true;
-			}
-			if (~p.time_parts & TSP_D_MM) {
-				object::set_month_contextual(obj, true);
-			} else if (~p.time_parts & TSP_D_YYYY) {
-				object::set_year_contextual(obj, true);
-			}
-			if (p.time_parts & TSP_T_ELEMENTS) {
-				h = parse_integer_unsigned(it, it + 2);
-				m = parse_integer_unsigned(it, it + 2);
-				if (p.time_parts & TSP_T_SS) {
-					s = parse_integer_unsigned(it, it + 2);
-				}
-				has_clock = true;
+			if (!p.time_values.converted) {
+				parser_convert_time(p);
 			}
+			auto const& tv = p.time_values;
+			bool const has_date = p.time_parts & TSP_D_DD;
+			bool const has_clock = p.time_parts & TSP_T_ELEMENTS;
+			auto& time = value.time;
+			value.type = ObjectValueType::time;
+			time.month_contextual = ~p.time_parts & TSP_D_MM;
+			time.year_contextual = !time.month_contextual && (~p.time_parts & TSP_D_YYYY);
 			if (has_date && has_clock) {
-				object::set_time_type(obj, ObjectTimeType::date_and_clock);
-				time::gregorian::set_utc(object::time_value(obj), date, h, m, s);
+				time.type = ObjectTimeType::date_and_clock;
+				time::gregorian::set_utc(time.value, tv.date, tv.h, tv.m, tv.s);
 			} else if (has_date) {
-				object::set_time_type(obj, ObjectTimeType::date);
-				time::gregorian::set_utc(object::time_value(obj), date);
+				time.type = ObjectTimeType::date;
+				time::gregorian::set_utc(time.value, tv.date);
 			} else if (has_clock) {
-				object::set_time_type(obj, ObjectTimeType::clock);
-				time::set_utc(object::time_value(obj), h, m, s);
+				time.type = ObjectTimeType::clock;
+				time::set_utc(time.value, tv.h, tv.m, tv.s);
 			}
 			if (p.time_parts & TSP_Z_UTC) {
-				object::set_zoned(obj, true);
+				time.zoned = true;
 			} else if (p.time_parts & TSP_Z_ELEMENTS) {
-				bool is_negative = false;
-				if (p.time_parts & TSP_Z_SIGN) {
-					is_negative = *it++ == '-';
-				}
-				object::set_zoned(obj, true);
-				h = parse_integer_unsigned(it, it + 2);
-				if (p.time_parts & TSP_Z_MM) {
-					m = parse_integer_unsigned(it, it + 2);
-				} else {
-					m = 0;
-				}
-				time::adjust_zone_clock(object::time_value(obj), is_negative ? -h : h, m);
+				time.zoned = true;
+				time::adjust_zone_clock(
+					time.value,
+					tv.zone_negative ? -tv.zone_h : tv.zone_h,
+					tv.zone_m
+				);
 			}
-			TOGO_DEBUG_ASSERTE(it == end(parser_buffer_ref(p)));
 		}	break;
 
 		case PB_CURRENCY: {
-			auto head = begin(parser_buffer_ref(p));
-			auto it = head;
-			bool negative = *it == '-';
-			if (negative || *it == '+') {
-				++it;
-			}
-			u64 value = parse_integer_unsigned(it, head + p.currency_parts.point);
-			s32 exponent = parser_buffer_size(p) - p.currency_parts.point;
-			if (exponent > 0) {
-				if (--exponent > 0) {
-					if (value > 0) {
-						value *= pow_int(10, exponent);
-					}
-					++it;
-					value += parse_integer_unsigned(it, it + exponent);
-				}
-			}
-			object::set_currency(
-				obj,
-				negative ? -static_cast<s64>(value) : static_cast<s64>(value),
-				exponent,
-				""
-			);
+			// NB: the reader rejects mantissas that do not fit
+			auto const& n = p.number_parts;
+			s64 const currency = static_cast<s64>(n.mantissa);
+			value.type = ObjectValueType::currency;
+			value.currency.value = n.negative ? -currency : currency;
+			value.currency.exponent = -n.point_exponent;
+			p.branch->flags |= OF_CURRENCY;
 		}	break;
 		}
+		if (p.buffer_type >= PB_NULL) {
+			// Value (not a marker)
+			sent = PARSER_VISIT(p, value(value));
+			if (value.type != ObjectValueType::null) {
+				p.branch->flags |= OF_VALUE;
+			}
+		}
 		break;
 
 	case ApplyBufferAs::name:
-		object::set_name(obj, parser_buffer_ref(p));
+		sent = PARSER_VISIT(p, name(parser_buffer_ref(p)));
 		break;
 
 	case ApplyBufferAs::unit:
-		object::set_unit(obj, parser_buffer_ref(p));
+		sent = PARSER_VISIT(p, unit(parser_buffer_ref(p)));
 		break;
 
 	// FIXME: ugh
-	case ApplyBufferAs::source: {
-		TOGO_DEBUG_ASSERTE(p.buffer_type == PB_SOURCE);
-		bool uncertain = p.buffer[0] == '?';
-		object::set_source_certain(obj, !uncertain);
-		if (!uncertain || array::size(p.buffer) > 1) {
-			array::push_back(p.buffer, '\0');
-			auto id = static_cast<unsigned>(parse_s64(array::begin(p.buffer) + uncertain, 10));
-			obj.source = static_cast<u16>(min(id, 0xFFFFu));
-		}
-	}	break;
-
+	case ApplyBufferAs::source:
 	case ApplyBufferAs::sub_source: {
 		TOGO_DEBUG_ASSERTE(p.buffer_type == PB_SOURCE);
 		bool uncertain = p.buffer[0] == '?';
-		object::set_sub_source_certain(obj, !uncertain);
+		unsigned id = 0;
 		if (!uncertain || array::size(p.buffer) > 1) {
 			array::push_back(p.buffer, '\0');
-			auto id = static_cast<unsigned>(parse_s64(array::begin(p.buffer) + uncertain, 10));
-			obj.sub_source = static_cast<u16>(min(id, 0xFFFFu));
+			id = static_cast<unsigned>(parse_s64(array::begin(p.buffer) + uncertain, 10));
 		}
+		sent
+			= apply_as == ApplyBufferAs::source
+			? PARSER_VISIT(p, source(id, !uncertain))
+			: PARSER_VISIT(p, sub_source(id, !uncertain))
+		;
 	}	break;
 	}
 	parser_buffer_clear(p);
 	p.branch->any_part = true;
+	return sent;
 }
 
 extern Stage const
@@ -1321,10 +1801,14 @@ extern Stage const
 STAGE(stage_root, BF_S_ROOT,
 nullptr,
 [](ObjectParser& p) -> Response {
+	if (p.checkpoint) {
+		parser_checkpoint(p);
+	}
 	if (p.c == PC_EOF) {
 		RESP(eof);
 	} else {
-		parser_push(p, array::push_back_inplace(object::children(*p.branch->obj)), sequence_base);
+		++p.num_objects;
+		parser_push_object(p, sequence_base, ObjectVisitKind::child);
 		RESP(jump);
 	}
 });
@@ -1340,7 +1824,7 @@ STAGE(stage_sv, BF_S_ROOT | BF_SINGLE_VALUE,
 [](ObjectParser& p) -> Response {
 	RESP_IF(p.c == PC_EOF, eof)
 	else {
-		parser_push(p, *p.branch->obj, sequence_base);
+		parser_push_object(p, sequence_base, ObjectVisitKind::child);
 		RESP(jump);
 	}
 },
@@ -1363,7 +1847,7 @@ STAGE(stage_lead, BF_NONE,
 		// might be a guess marker
 		RESP_IF(!parser_read_guess_marker(p), error)
 		if (p.buffer_type == PB_MARKER_GUESS) {
-			parser_apply(p);
+			RESP_IF(!parser_apply(p), error)
 			RESP_SEQ(jump, jump_base_after_marker_guess);
 		}
 		break;
@@ -1381,7 +1865,7 @@ STAGE(stage_lead, BF_NONE,
 		// expecting assignment or some right-hand part
 		RESP_SEQ(jump_sub, &sub_assign);
 	} else { // null, true, false
-		parser_apply(p);
+		RESP_IF(!parser_apply(p), error)
 		RESP_SEQ(jump, jump_base_after_value);
 	}
 },
@@ -1391,11 +1875,11 @@ nullptr
 STAGE(stage_assign, BF_NONE,
 [](ObjectParser& p) -> Response {
 	if (p.c == '=') {
-		parser_apply(p, ApplyBufferAs::name);
+		RESP_IF(!parser_apply(p, ApplyBufferAs::name), error)
 		// expecting right-hand part, but might not get it!
 		RESP(exit_sub);
 	} else {
-		parser_apply(p);
+		RESP_IF(!parser_apply(p), error)
 		RESP_SEQ(jump, jump_base_after_value);
 	}
 },
@@ -1435,9 +1919,8 @@ STAGE(stage_tag_assign, BF_NONE,
 STAGE(stage_marker_uncertainty, BF_NONE,
 [](ObjectParser& p) -> Response {
 	if (p.c == '?') {
-		RESP_IF(!parser_read_uncertainty_marker(p), error)
+		RESP_IF(!parser_read_uncertainty_marker(p) || !parser_apply(p), error)
 		else {
-			parser_apply(p);
 			RESP(next);
 		}
 	}
@@ -1450,15 +1933,14 @@ STAGE(stage_marker_guess, BF_NONE,
 [](ObjectParser& p) -> Response {
 	RESP_IF(p.c != 'G', pass)
 	else RESP_IF(!parser_read_guess_marker(p), error)
-	else if (!object::value_certain(*p.branch->obj)) {
+	else if (p.branch->flags & OF_VALUE_UNCERTAIN) {
 		PARSER_ERROR(p, "lead marker '?' was already met; guess marker invalid here");
 		RESP(error);
 	} else if (p.buffer_type != PB_MARKER_GUESS) {
-		parser_apply(p);
+		RESP_IF(!parser_apply(p), error)
 		RESP_SEQ(jump, jump_base_after_value);
 	} else {
-		parser_apply(p);
-		RESP(next);
+		RESP_IF_ELSE(!parser_apply(p), error, next)
 	}
 },
 nullptr
@@ -1468,14 +1950,13 @@ STAGE(stage_tag_marker_guess, BF_NONE,
 [](ObjectParser& p) -> Response {
 	RESP_IF(p.c != 'G', pass)
 	else RESP_IF(!parser_read_guess_marker(p), error)
-	else if (!object::value_certain(*p.branch->obj)) {
+	else if (p.branch->flags & OF_VALUE_UNCERTAIN) {
 		PARSER_ERROR(p, "lead marker '?' was already met; guess marker invalid here");
 		RESP(error);
 	} else if (p.buffer_type == PB_MARKER_GUESS) {
-		parser_apply(p);
-		RESP(next);
+		RESP_IF_ELSE(!parser_apply(p), error, next)
 	} else {
-		parser_apply(p, ApplyBufferAs::name);
+		RESP_IF(!parser_apply(p, ApplyBufferAs::name), error)
 		RESP_SEQ(jump, jump_tag_after_name);
 	}
 },
@@ -1485,9 +1966,8 @@ nullptr
 STAGE(stage_marker_approximation, BF_NONE,
 [](ObjectParser& p) -> Response {
 	if (p.c == '~' || p.c == '^') {
-		RESP_IF(!parser_read_approximation_marker(p, p.c), error)
+		RESP_IF(!parser_read_approximation_marker(p, p.c) || !parser_apply(p), error)
 		else {
-			parser_apply(p);
 			RESP(next);
 		}
 	}
@@ -1516,9 +1996,8 @@ STAGE(stage_value, BF_NONE,
 	} else {
 		RESP(pass);
 	}
-	RESP_IF(p.flags & PF_ERROR, error)
+	RESP_IF((p.flags & PF_ERROR) || !parser_apply(p), error)
 	else {
-		parser_apply(p);
 		RESP_SEQ_IF(is_unit_carrier, jump_sub, &sub_unit)
 		else RESP(next);
 	}
@@ -1529,12 +2008,11 @@ nullptr
 STAGE(stage_unit, BF_NONE,
 [](ObjectParser& p) -> Response {
 	if (parser_is_identifier_lead(p)) {
-		RESP_IF(!parser_read_identifier(p, false), error)
+		RESP_IF(!parser_read_identifier(p, false) || !parser_apply(p, ApplyBufferAs::unit), error)
 		else {
-			parser_apply(p, ApplyBufferAs::unit);
 			RESP(next);
 		}
-	} else if (object::is_currency(*p.branch->obj)) {
+	} else if (p.branch->flags & OF_CURRENCY) {
 		PARSER_ERROR_EXPECTED(p, "unit following currency value");
 		RESP(error);
 	}
@@ -1545,21 +2023,28 @@ nullptr
 
 STAGE(stage_typed_string, BF_NONE,
 [](ObjectParser& p) -> Response {
-	auto& obj = *p.branch->obj;
-	RESP_IF(!object::is_identifier(obj), pass)
-	else if (p.c == '\"') {
+	RESP_IF(~p.flags & PF_IDENTIFIER, pass)
+	p.flags &= ~PF_IDENTIFIER;
+	if (p.c != '\"' && p.c != '`') {
+		ObjectVisitValue value{};
+		value.type = ObjectValueType::identifier;
+		value.string = parser_buffer_ref(p);
+		RESP_IF(!PARSER_VISIT(p, value(value)), error)
+		parser_buffer_clear(p);
+		RESP(pass);
+	}
+	// The identifier is the type of the string
+	array::resize(p.string_type, parser_buffer_size(p));
+	std::memcpy(array::begin(p.string_type), array::begin(p.buffer), parser_buffer_size(p));
+	parser_buffer_clear(p);
+	if (p.c == '\"') {
 		parser_read_string_quote(p);
-	} else if (p.c == '`') {
-		parser_read_string_block(p);
 	} else {
-		RESP(pass);
+		parser_read_string_block(p);
 	}
-	RESP_IF(p.flags & PF_ERROR, error)
+	RESP_IF((p.flags & PF_ERROR) || !parser_apply(p), error)
 	else {
-		auto type = obj.value.identifier;
-		obj.value.identifier = {};
-		parser_apply(p);
-		obj.value.string.type = type;
+		array::clear(p.string_type);
 		RESP(next);
 	}
 },
@@ -1572,11 +2057,14 @@ STAGE(stage_expression_scope, BF_S_EXPRESSION_SCOPE,
 [](ObjectParser& p) -> Response {
 	RESP_IF(p.c != '(', pass);
 
-	if (!object::is_null(*p.branch->obj)) {
+	if (p.branch->flags & OF_VALUE) {
 		PARSER_ERROR(p, "scoped expression is a value (must not have preceding value)");
 		RESP(error);
 	}
-	object::set_expression(*p.branch->obj);
+	ObjectVisitValue value{};
+	value.type = ObjectValueType::expression;
+	RESP_IF(!PARSER_VISIT(p, value(value)), error)
+	p.branch->flags |= OF_VALUE;
 	RESP_SEQ(exit_sub, &sub_expression_scope_lead);
 },
 [](ObjectParser& p) -> Response {
@@ -1604,9 +2092,7 @@ STAGE(stage_expression_scope, BF_S_EXPRESSION_SCOPE,
 	l_op:
 		RESP_IF(!parser_next(p), error)
 		else {
-			auto& obj = array::push_back_inplace(object::expression(*p.branch->obj));
-			object::set_op(obj, op);
-			parser_push(p, obj, jump_base_unnamed);
+			parser_push_object(p, jump_base_unnamed, ObjectVisitKind::operand, OF_NONE, op);
 			RESP(jump);
 		}
 	}
@@ -1625,9 +2111,7 @@ nullptr,
 	else {
 		// hack: return to stage_expression_scope on Response::complete
 		p.branch->sequence_pos = jump_back;
-		auto& lead = array::push_back_inplace(object::expression(*p.branch->obj));
-		object::set_op(lead, ObjectOperator::none);
-		parser_push(p, lead, jump_base_unnamed);
+		parser_push_object(p, jump_base_unnamed, ObjectVisitKind::operand);
 		RESP(jump);
 	}
 });
@@ -1637,9 +2121,8 @@ STAGE(stage_source, BF_NONE,
 	RESP_IF_ELSE(p.c == '$', exit, pass)
 },
 [](ObjectParser& p) -> Response {
-	RESP_IF(!parser_read_source(p), error)
+	RESP_IF(!parser_read_source(p) || !parser_apply(p, ApplyBufferAs::source), error)
 	else {
-		parser_apply(p, ApplyBufferAs::source);
 		RESP_SEQ(jump_sub, &sub_sub_source);
 	}
 });
@@ -1649,9 +2132,8 @@ STAGE(stage_sub_source, BF_NONE,
 	RESP_IF_ELSE(p.c == '$', exit_sub, next)
 },
 [](ObjectParser& p) -> Response {
-	RESP_IF(!parser_read_source(p), error)
+	RESP_IF(!parser_read_source(p) || !parser_apply(p, ApplyBufferAs::sub_source), error)
 	else {
-		parser_apply(p, ApplyBufferAs::sub_source);
 		// resume sequence_base
 		RESP(next);
 	}
@@ -1671,7 +2153,7 @@ STAGE(stage_tags, BF_TAGS,
 
 	RESP_IF(!parser_next(p), error)
 	else {
-		parser_push(p, array::push_back_inplace(object::tags(*p.branch->obj)), sequence_tag, OF_TAG);
+		parser_push_object(p, sequence_tag, ObjectVisitKind::tag, OF_TAG);
 		RESP(jump);
 	}
 });
@@ -1694,7 +2176,7 @@ STAGE(stage_children, BF_S_CHILDREN,
 		RESP(error);
 
 	default:
-		parser_push(p, array::push_back_inplace(object::children(*p.branch->obj)), sequence_base);
+		parser_push_object(p, sequence_base, ObjectVisitKind::child);
 		RESP(jump);
 	}
 });
@@ -1703,9 +2185,8 @@ STAGE(stage_tag_name, BF_NONE,
 [](ObjectParser& p) -> Response {
 	RESP_IF(!parser_is_identifier_lead(p), pass)
 	else {
-		RESP_IF(!parser_read_identifier(p), error)
+		RESP_IF(!parser_read_identifier(p) || !parser_apply(p, ApplyBufferAs::name), error)
 		else {
-			parser_apply(p, ApplyBufferAs::name);
 			RESP(next);
 		}
 	}
@@ -1731,7 +2212,7 @@ STAGE(stage_tag_children, BF_S_TAG_CHILDREN,
 		RESP(error);
 
 	default:
-		parser_push(p, array::push_back_inplace(object::children(*p.branch->obj)), sequence_base);
+		parser_push_object(p, sequence_base, ObjectVisitKind::child);
 		RESP(jump);
 	}
 });
@@ -1745,7 +2226,7 @@ STAGE(stage_quantity, BF_QUANTITY,
 	else {
 		// hack: nothing keeps track of the current position since we haven't reached exit
 		p.branch->sequence_pos = jump_base_quantity;
-		parser_push(p, object::make_quantity(*p.branch->obj), sequence_base);
+		parser_push_object(p, sequence_base, ObjectVisitKind::quantity);
 		RESP(jump);
 	}
 },
@@ -1763,7 +2244,7 @@ STAGE(stage_quantity, BF_QUANTITY,
 		RESP(next_gobble);
 
 	case ',': case ';': case '\n':
-		parser_push(p, *object::quantity(*p.branch->obj), &sub_quantity_children);
+		parser_push(p, &sub_quantity_children, OF_WRAP_COLLECTION, ObjectVisitKind::quantity);
 		RESP(jump);
 	}
 	// FIXME: Can this ever be reached?
@@ -1776,7 +2257,6 @@ STAGE(stage_quantity_children, BF_S_QUANTITY_COLLECTION,
 		PARSER_ERROR_EXPECTED(p, "sub-object");
 		RESP(error);
 	}
-	parser_move_object_into_child(*p.branch->obj);
 	p.flags |= PF_CARRY;
 	RESP(exit);
 },
@@ -1795,7 +2275,7 @@ STAGE(stage_quantity_children, BF_S_QUANTITY_COLLECTION,
 		RESP(complete);
 
 	default:
-		parser_push(p, array::push_back_inplace(object::children(*p.branch->obj)), sequence_base);
+		parser_push_object(p, sequence_base, ObjectVisitKind::child);
 		RESP(jump);
 	}
 });
@@ -1824,27 +2304,12 @@ STAGE(stage_complete, BF_NONE,
 		auto flags = parser_parent_flags(p);
 		if (flags & BF_M_EXPRESSION) {
 			// do nothing (common case)
-		} else if (flags & (BF_SINGLE_VALUE | BF_QUANTITY)) {
-			parser_pop(p);
-			auto& obj = *((flags & BF_QUANTITY) ? object::quantity(*p.branch->obj) : p.branch->obj);
-			parser_move_object_into_child(obj);
-			object::set_expression(obj);
-			object::expression(obj) = rvalue_ref(object::children(obj));
-			object::set_op(array::back(object::expression(obj)), ObjectOperator::none);
-			parser_push(p, obj, &sub_expression);
-			RESP(jump);
 		} else {
-			parser_pop(p);
-			auto& scope = object::children(*p.branch->obj);
-			auto& shim = array::push_back_inplace(scope);
-			auto lead = end(scope) - 2;
-			object::set_expression(shim);
-			shim.name = lead->name;
-			lead->name = {};
-			object::set_op(*lead, ObjectOperator::none);
-			array::push_back_inplace(object::expression(shim), rvalue_ref(*lead));
-			array::remove_over(scope, lead);
-			parser_push(p, array::back(scope), &sub_expression);
+			// The object is the lead operand of an expression that takes
+			// its place
+			auto const kind = p.branch->kind;
+			RESP_IF(!parser_pop(p), error)
+			parser_push(p, &sub_expression, OF_WRAP_EXPRESSION, kind);
 			RESP(jump);
 		}
 	}
@@ -1893,9 +2358,7 @@ STAGE(stage_expression, BF_EXPRESSION,
 	l_op:
 		RESP_IF(!parser_next(p), error)
 		else {
-			auto& obj = array::push_back_inplace(object::expression(*p.branch->obj));
-			object::set_op(obj, op);
-			parser_push(p, obj, jump_base_unnamed);
+			parser_push_object(p, jump_base_unnamed, ObjectVisitKind::operand, OF_NONE, op);
 			RESP(jump);
 		}
 	}
@@ -2010,7 +2473,7 @@ Stage const
 * sub_expression_scope_lead = &stage_expression_scope_lead
 ;
 
-static void parser_init(ObjectParser& p, Object& root, bool single_value) {
+static void parser_init(ObjectParser& p, bool single_value) {
 	p.info.line = 0;
 	p.info.column = 0;
 	p.info.message[0] = '\0';
@@ -2023,11 +2486,12 @@ static void parser_init(ObjectParser& p, Object& root, bool single_value) {
 	p.buffer_type  = PB_NONE;
 	p.hop_count = 0;
 	p.time_parts = 0;
-	p.currency_parts = {};
+	p.number_parts = {};
 	p.branch = nullptr;
 	array::clear(p.stack);
 	array::clear(p.buffer);
-	parser_push(p, root, single_value ? sequence_root_single_value : sequence_root);
+	array::clear(p.string_type);
+	parser_push(p, single_value ? sequence_root_single_value : sequence_root);
 }
 
 static bool parser_read(ObjectParser& p) {
@@ -2049,8 +2513,8 @@ l_exec:
 	if (!parser_skip_junk(p, stage_part == StagePart::exit)) {
 		return false;
 	}
-	if (object::source_line(*p.branch->obj) == 0) {
-		object::set_source_line(*p.branch->obj, p.line);
+	if ((p.branch->flags & OF_M_EVENT) && !parser_send_branch_event(p)) {
+		return false;
 	}
 
 	switch (stage_part) {
@@ -2076,7 +2540,9 @@ l_exec:
 		return false;
 
 	case Response::complete:
-		parser_pop(p);
+		if (!parser_pop(p)) {
+			return false;
+		}
 		base_pos = p.branch->sequence_pos;
 		stage_part = StagePart::exit;
 		goto l_exec;
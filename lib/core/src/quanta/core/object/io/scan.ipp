@@ -0,0 +1,378 @@
+#line 2 "quanta/core/object/io/scan.ipp"
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+*/
+
+#include <quanta/core/config.hpp>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+namespace quanta {
+namespace object {
+
+namespace {
+
+// Run scanners.
+//
+// Each class defines the bytes that end a run, both for a single byte and
+// for a vector of bytes (as a byte mask). scan_run() returns the first byte
+// in [it, end) that ends the run, or end. '\r' always ends a run so that the
+// parser can strip it.
+
+#if defined(__SSE2__)
+
+inline __m128i scan_splat(__m128i, u8 const c) {
+	return _mm_set1_epi8(static_cast<char>(c));
+}
+
+inline __m128i scan_eq(__m128i const v, u8 const c) {
+	return _mm_cmpeq_epi8(v, scan_splat(v, c));
+}
+
+inline __m128i scan_or(__m128i const a, __m128i const b) {
+	return _mm_or_si128(a, b);
+}
+
+inline __m128i scan_not(__m128i const v) {
+	return _mm_xor_si128(v, _mm_set1_epi8(-1));
+}
+
+// lo <= v <= hi (unsigned)
+inline __m128i scan_in_range(__m128i const v, u8 const lo, u8 const hi) {
+	return _mm_cmpeq_epi8(
+		_mm_subs_epu8(_mm_sub_epi8(v, scan_splat(v, lo)), scan_splat(v, hi - lo)),
+		_mm_setzero_si128()
+	);
+}
+
+// v >= 0x80
+inline __m128i scan_high(__m128i const v) {
+	return _mm_cmplt_epi8(v, _mm_setzero_si128());
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+inline __m256i scan_splat(__m256i, u8 const c) {
+	return _mm256_set1_epi8(static_cast<char>(c));
+}
+
+inline __m256i scan_eq(__m256i const v, u8 const c) {
+	return _mm256_cmpeq_epi8(v, scan_splat(v, c));
+}
+
+inline __m256i scan_or(__m256i const a, __m256i const b) {
+	return _mm256_or_si256(a, b);
+}
+
+inline __m256i scan_not(__m256i const v) {
+	return _mm256_xor_si256(v, _mm256_set1_epi8(-1));
+}
+
+inline __m256i scan_in_range(__m256i const v, u8 const lo, u8 const hi) {
+	return _mm256_cmpeq_epi8(
+		_mm256_subs_epu8(_mm256_sub_epi8(v, scan_splat(v, lo)), scan_splat(v, hi - lo)),
+		_mm256_setzero_si256()
+	);
+}
+
+inline __m256i scan_high(__m256i const v) {
+	return _mm256_cmpgt_epi8(_mm256_setzero_si256(), v);
+}
+
+#endif
+
+// Indentation and spacing
+struct ScanBlank {
+	static bool stop(unsigned const c) {
+		return c != ' ' && c != '\t';
+	}
+
+	template<class V>
+	static V stop(V const v) {
+		return scan_not(scan_or(scan_eq(v, ' '), scan_eq(v, '\t')));
+	}
+};
+
+// Body of a line comment
+struct ScanLineComment {
+	static bool stop(unsigned const c) {
+		return c == '\n' || c == '\r';
+	}
+
+	template<class V>
+	static V stop(V const v) {
+		return scan_or(scan_eq(v, '\n'), scan_eq(v, '\r'));
+	}
+};
+
+// Body of a block comment (between nesting markers)
+struct ScanBlockComment {
+	static bool stop(unsigned const c) {
+		return c == '*' || c == '\\' || c == '\n' || c == '\r';
+	}
+
+	template<class V>
+	static V stop(V const v) {
+		return scan_or(
+			scan_or(scan_eq(v, '*'), scan_eq(v, '\\')),
+			scan_or(scan_eq(v, '\n'), scan_eq(v, '\r'))
+		);
+	}
+};
+
+// Common identifier bytes; anything else goes through the full terminator
+// check in parser_read_identifier()
+struct ScanIdentifier {
+	static bool stop(unsigned const c) {
+		return !(false
+			|| (c >= 'a' && c <= 'z')
+			|| (c >= 'A' && c <= 'Z')
+			|| (c >= '0' && c <= '9')
+			||  c == '_' || c == '-' || c == '.'
+			||  c >= 0x80
+		);
+	}
+
+	template<class V>
+	static V stop(V const v) {
+		return scan_not(scan_or(
+			scan_or(
+				scan_or(scan_in_range(v, 'a', 'z'), scan_in_range(v, 'A', 'Z')),
+				scan_or(scan_in_range(v, '0', '9'), scan_high(v))
+			),
+			scan_or(
+				scan_eq(v, '_'),
+				scan_or(scan_eq(v, '-'), scan_eq(v, '.'))
+			)
+		));
+	}
+};
+
+// Body of a double-quote bounded string
+struct ScanStringQuote {
+	static bool stop(unsigned const c) {
+		return c == '\"' || c == '\\' || c == '\n' || c == '\r';
+	}
+
+	template<class V>
+	static V stop(V const v) {
+		return scan_or(
+			scan_or(scan_eq(v, '\"'), scan_eq(v, '\\')),
+			scan_or(scan_eq(v, '\n'), scan_eq(v, '\r'))
+		);
+	}
+};
+
+// Body of a block-quote bounded string
+struct ScanStringBlock {
+	static bool stop(unsigned const c) {
+		return c == '`' || c == '\n' || c == '\r';
+	}
+
+	template<class V>
+	static V stop(V const v) {
+		return scan_or(
+			scan_eq(v, '`'),
+			scan_or(scan_eq(v, '\n'), scan_eq(v, '\r'))
+		);
+	}
+};
+
+template<class S>
+static u8 const* scan_run(u8 const* it, u8 const* const end) {
+#if defined(__AVX2__)
+	for (; end - it >= 32; it += 32) {
+		__m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+		unsigned const mask = static_cast<unsigned>(_mm256_movemask_epi8(S::stop(v)));
+		if (mask) {
+			return it + __builtin_ctz(mask);
+		}
+	}
+#endif
+#if defined(__SSE2__)
+	for (; end - it >= 16; it += 16) {
+		__m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+		unsigned const mask = static_cast<unsigned>(_mm_movemask_epi8(S::stop(v)));
+		if (mask) {
+			return it + __builtin_ctz(mask);
+		}
+	}
+#endif
+	for (; it != end && !S::stop(unsigned{*it}); ++it) {}
+	return it;
+}
+
+// Structural bytes of the top level of a document
+struct ScanStructure {
+	static bool stop(unsigned const c) {
+		switch (c) {
+		case '\n':
+		case '{': case '}':
+		case '[': case ']':
+		case '(': case ')':
+		case '\"': case '`':
+		case '\\':
+			return true;
+		}
+		return false;
+	}
+
+	template<class V>
+	static V stop(V const v) {
+		return scan_or(
+			scan_or(
+				scan_or(scan_eq(v, '\n'), scan_eq(v, '\\')),
+				scan_or(scan_eq(v, '\"'), scan_eq(v, '`'))
+			),
+			scan_or(
+				scan_or(
+					scan_or(scan_eq(v, '{'), scan_eq(v, '}')),
+					scan_or(scan_eq(v, '['), scan_eq(v, ']'))
+				),
+				scan_or(scan_eq(v, '('), scan_eq(v, ')'))
+			)
+		);
+	}
+};
+
+struct ScanSplit {
+	u8 const* pos;
+	unsigned line;
+};
+
+// Find the starts of lines at the top level of a document (outside of
+// scopes, strings and comments), at least interval bytes apart.
+// Returns the number of splits written.
+static unsigned scan_split(
+	u8 const* const begin,
+	u8 const* const end,
+	unsigned const interval,
+	ScanSplit* const splits,
+	unsigned const max_splits
+) {
+	unsigned num_splits = 0;
+	unsigned line = 1;
+	unsigned depth = 0;
+	unsigned next_split = interval;
+	u8 const* it = begin;
+	while (num_splits < max_splits) {
+		it = scan_run<ScanStructure>(it, end);
+		if (it == end) {
+			break;
+		}
+		switch (*it++) {
+		case '\n':
+			++line;
+			if (depth == 0 && it != end) {
+				unsigned const offset = static_cast<unsigned>(it - begin);
+				if (offset >= next_split) {
+					splits[num_splits++] = {it, line};
+					next_split = offset + interval;
+				}
+			}
+			break;
+
+		case '{': case '[': case '(':
+			++depth;
+			break;
+
+		case '}': case ']': case ')':
+			depth -= depth > 0;
+			break;
+
+		case '\"':
+			while ((it = scan_run<ScanStringQuote>(it, end)) != end) {
+				unsigned const c = *it++;
+				if (c == '\"') {
+					break;
+				} else if (c == '\n') {
+					++line;
+					break;
+				} else if (c == '\\' && it != end) {
+					line += *it == '\n';
+					++it;
+				}
+			}
+			break;
+
+		case '`': {
+			if (end - it < 2 || it[0] != '`' || it[1] != '`') {
+				break;
+			}
+			it += 2;
+			unsigned count = 0;
+			while ((it = scan_run<ScanStringBlock>(it, end)) != end) {
+				unsigned const c = *it++;
+				if (c == '`') {
+					if (++count == 3) {
+						break;
+					}
+					continue;
+				}
+				line += c == '\n';
+				count = 0;
+			}
+		}	break;
+
+		case '\\':
+			if (it == end) {
+				break;
+			} else if (*it == '\\') {
+				it = scan_run<ScanLineComment>(it, end);
+				// '\r' stops the run, but does not end the comment
+				while (it != end && *it == '\r') {
+					it = scan_run<ScanLineComment>(it + 1, end);
+				}
+			} else if (*it == '*') {
+				++it;
+				bool head = false;
+				bool tail = false;
+				unsigned count = 1;
+				while (count > 0 && (it = scan_run<ScanBlockComment>(it, end)) != end) {
+					switch (*it++) {
+					case '*':
+						if (head) {
+							++count;
+							head = false;
+						} else {
+							tail = true;
+						}
+						break;
+
+					case '\\':
+						if (tail) {
+							--count;
+							tail = false;
+						} else {
+							head = true;
+						}
+						break;
+
+					case '\n':
+						++line;
+						// fall-through
+
+					default:
+						head = false;
+						tail = false;
+						break;
+					}
+				}
+			}
+			break;
+		}
+	}
+	return num_splits;
+}
+
+} // anonymous namespace
+
+} // namespace object
+} // namespace quanta
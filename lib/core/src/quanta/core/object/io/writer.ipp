@@ -12,6 +12,7 @@
 #include <togo/core/io/types.hpp>
 #include <togo/core/io/io.hpp>
 
+#include <cstring>
 #include <cstdio>
 
 namespace quanta {
@@ -25,94 +26,237 @@ static constexpr char const TABS[]{
 
 #define RETURN_ERROR(x) if (!(x)) { return false; }
 
-static bool write_tabs(IWriter& stream, unsigned tabs) {
-	while (tabs > 0) {
-		unsigned const amount = min(tabs, array_extent(TABS));
-		if (!io::write(stream, TABS, amount)) {
-			return false;
-		}
-		tabs -= amount;
+// Buffered text output
+//
+// Text is rendered into a fixed buffer that is written to the stream in
+// large blocks. Numbers and times are formatted in place.
+//
+// compact selects ObjectTextFormat::compact.
+//
+// If marks is set, the output position of each child of marked is pushed
+// to it, followed by the position after the last child.
+struct TextWriter {
+	enum : unsigned {
+		BUFFER_SIZE = 32 * 1024,
+	};
+
+	IWriter& stream;
+	u64 flushed;
+	Object const* marked;
+	Array<u64>* marks;
+	bool compact;
+	unsigned size;
+	char buffer[BUFFER_SIZE];
+
+	TextWriter(IWriter& stream)
+		: stream(stream)
+		, flushed(0)
+		, marked(nullptr)
+		, marks(nullptr)
+		, compact(false)
+		, size(0)
+	{}
+};
+
+static bool writer_flush(TextWriter& out) {
+	if (out.size > 0) {
+		unsigned const size = out.size;
+		out.flushed += size;
+		out.size = 0;
+		return io::write(out.stream, out.buffer, size);
 	}
 	return true;
 }
 
-#if defined(TOGO_COMPILER_CLANG) || \
-	defined(TOGO_COMPILER_GCC)
-	__attribute__((__format__ (__printf__, 2, 3)))
-#endif
-static bool writef(IWriter& stream, char const* const format, ...) {
-	char buffer[256];
-	va_list va;
-	va_start(va, format);
-	signed const size = std::vsnprintf(buffer, array_extent(buffer), format, va);
-	va_end(va);
-	if (size < 0) {
-		return false;
+inline static void writer_mark(TextWriter& out, Object const& parent) {
+	if (&parent == out.marked) {
+		array::push_back(*out.marks, out.flushed + out.size);
 	}
-	return io::write(stream, buffer, static_cast<unsigned>(size));
 }
 
-inline static unsigned quote_level(StringRef const& str) {
-	auto const it_end = end(str);
-	for (auto it = begin(str); it != it_end; ++it) {
-		switch (*it) {
-		case '\\':
-		case '\"':
-		case '\n':
-			return 1;
-		}
+// Space for size more bytes
+inline static char* writer_reserve(TextWriter& out, unsigned const size) {
+	TOGO_DEBUG_ASSERTE(size <= TextWriter::BUFFER_SIZE);
+	if (out.size + size > TextWriter::BUFFER_SIZE && !writer_flush(out)) {
+		return nullptr;
 	}
-	return 0;
+	return out.buffer + out.size;
 }
 
-inline static bool write_quote(IWriter& stream, unsigned level) {
-	switch (level) {
-	case 0: RETURN_ERROR(io::write_value(stream, '\"')); break;
-	case 1: RETURN_ERROR(io::write(stream, "```", 3)); break;
+inline static bool write_raw(TextWriter& out, char const* const data, unsigned const size) {
+	if (out.size + size <= TextWriter::BUFFER_SIZE) {
+		std::memcpy(out.buffer + out.size, data, size);
+		out.size += size;
+		return true;
 	}
+	RETURN_ERROR(writer_flush(out));
+	if (size >= TextWriter::BUFFER_SIZE) {
+		out.flushed += size;
+		return io::write(out.stream, data, size);
+	}
+	std::memcpy(out.buffer, data, size);
+	out.size = size;
 	return true;
 }
 
-inline static bool write_identifier(IWriter& stream, StringRef const& str) {
-	RETURN_ERROR(io::write(stream, str.data, str.size));
+inline static bool write_char(TextWriter& out, char const c) {
+	if (out.size == TextWriter::BUFFER_SIZE) {
+		RETURN_ERROR(writer_flush(out));
+	}
+	out.buffer[out.size++] = c;
 	return true;
 }
 
-inline static bool write_string(IWriter& stream, StringRef const& str) {
-	unsigned const level = quote_level(str);
-	RETURN_ERROR(
-		write_quote(stream, level) &&
-		io::write(stream, str.data, str.size) &&
-		write_quote(stream, level)
-	);
+static char const s_digit_pairs[]{
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899"
+};
+
+// Equivalent to printf's "%0*lu" with width
+static bool write_unsigned(TextWriter& out, u64 value, unsigned width = 0) {
+	char digits[20];
+	char* it = digits + array_extent(digits);
+	while (value >= 100) {
+		unsigned const pair = static_cast<unsigned>(value % 100) * 2;
+		value /= 100;
+		*--it = s_digit_pairs[pair + 1];
+		*--it = s_digit_pairs[pair];
+	}
+	if (value >= 10) {
+		unsigned const pair = static_cast<unsigned>(value) * 2;
+		*--it = s_digit_pairs[pair + 1];
+		*--it = s_digit_pairs[pair];
+	} else {
+		*--it = static_cast<char>('0' + value);
+	}
+	unsigned const size = static_cast<unsigned>(digits + array_extent(digits) - it);
+	for (; width > size; --width) {
+		RETURN_ERROR(write_char(out, '0'));
+	}
+	return write_raw(out, it, size);
+}
+
+// Equivalent to printf's "%0*ld" with width (which includes the sign)
+static bool write_signed(TextWriter& out, s64 const value, unsigned const width = 0) {
+	if (value < 0) {
+		RETURN_ERROR(write_char(out, '-'));
+		return write_unsigned(
+			out,
+			u64{0} - static_cast<u64>(value),
+			width > 0 ? width - 1 : 0
+		);
+	}
+	return write_unsigned(out, static_cast<u64>(value), width);
+}
+
+static bool write_decimal(TextWriter& out, f64 const value) {
+	// Longest is "-d.ddddde-ddd"
+	unsigned const capacity = 32;
+	char* const put = writer_reserve(out, capacity);
+	RETURN_ERROR(put);
+	signed const size = std::snprintf(put, capacity, "%.6lg", value);
+	if (size < 0 || static_cast<unsigned>(size) >= capacity) {
+		return false;
+	}
+	out.size += static_cast<unsigned>(size);
 	return true;
 }
 
-inline static bool write_source(IWriter& stream, unsigned source, bool uncertain) {
+inline static bool write_separator(TextWriter& out) {
+	return out.compact ? write_char(out, ',') : write_raw(out, ", ", 2);
+}
+
+static bool write_tabs(TextWriter& out, unsigned tabs) {
+	while (tabs > 0) {
+		unsigned const amount = min(tabs, array_extent(TABS));
+		RETURN_ERROR(write_raw(out, TABS, amount));
+		tabs -= amount;
+	}
+	return true;
+}
+
+// Strings with any of these bytes are block-quoted
+struct ScanStringNeedsBlock {
+	static bool stop(unsigned const c) {
+		return c == '\"' || c == '\\' || c == '\n';
+	}
+
+	template<class V>
+	static V stop(V const v) {
+		return scan_or(
+			scan_eq(v, '\"'),
+			scan_or(scan_eq(v, '\\'), scan_eq(v, '\n'))
+		);
+	}
+};
+
+inline static unsigned quote_level(StringRef const& str) {
+	u8 const* const it = reinterpret_cast<u8 const*>(str.data);
+	u8 const* const it_end = it + str.size;
+	return scan_run<ScanStringNeedsBlock>(it, it_end) != it_end;
+}
+
+inline static bool write_identifier(TextWriter& out, StringRef const& str) {
+	RETURN_ERROR(write_raw(out, str.data, str.size));
+	return true;
+}
+
+inline static bool write_string(TextWriter& out, StringRef const& str) {
+	StringRef const quote = quote_level(str) == 0 ? StringRef{"\"", 1} : StringRef{"```", 3};
+	unsigned const size = str.size + 2 * quote.size;
+	if (size > TextWriter::BUFFER_SIZE) {
+		return
+			write_raw(out, quote.data, quote.size) &&
+			write_raw(out, str.data, str.size) &&
+			write_raw(out, quote.data, quote.size)
+		;
+	}
+	char* put = writer_reserve(out, size);
+	RETURN_ERROR(put);
+	std::memcpy(put, quote.data, quote.size);
+	put += quote.size;
+	if (str.size > 0) {
+		std::memcpy(put, str.data, str.size);
+		put += str.size;
+	}
+	std::memcpy(put, quote.data, quote.size);
+	out.size += size;
+	return true;
+}
+
+inline static bool write_source(TextWriter& out, unsigned source, bool uncertain) {
 	RETURN_ERROR(
-		io::write(stream, "$?", 1 + uncertain) &&
-		(source == 0 || writef(stream, "%u", source))
+		write_raw(out, "$?", 1 + uncertain) &&
+		(source == 0 || write_unsigned(out, source))
 	);
 	return true;
 }
 
-inline static bool write_markers(IWriter& stream, Object const& obj) {
+inline static bool write_markers(TextWriter& out, Object const& obj) {
 	if (object::marker_value_uncertain(obj)) {
-		RETURN_ERROR(io::write_value(stream, '?'));
+		RETURN_ERROR(write_char(out, '?'));
 	} else if (object::marker_value_guess(obj)) {
-		RETURN_ERROR(io::write(stream, "G~", 2));
+		RETURN_ERROR(write_raw(out, "G~", 2));
 	}
 	auto approximation = object::value_approximation(obj);
 	if (approximation < 0) {
-		RETURN_ERROR(io::write(stream, "~~~", unsigned_cast(-approximation)));
+		RETURN_ERROR(write_raw(out, "~~~", unsigned_cast(-approximation)));
 	} else if (approximation > 0) {
-		RETURN_ERROR(io::write(stream, "^^^", unsigned_cast(approximation)));
+		RETURN_ERROR(write_raw(out, "^^^", unsigned_cast(approximation)));
 	}
 	return true;
 }
 
 static bool write_object(
-	IWriter& stream,
+	TextWriter& out,
 	Object const& obj,
 	unsigned tabs,
 	bool named = true
@@ -128,29 +272,29 @@ inline char const* op_string(ObjectOperator const op) {
 }
 
 static bool write_expression(
-	IWriter& stream,
+	TextWriter& out,
 	Object const& obj,
 	unsigned tabs,
 	bool scoped
 ) {
 	scoped |= array::size(object::expression(obj)) <= 1;
 	if (scoped) {
-		RETURN_ERROR(io::write_value(stream, '('));
+		RETURN_ERROR(write_char(out, '('));
 	}
 	if (object::has_operands(obj)) {
 		auto& operands = object::expression(obj);
 		auto it = begin(operands);
 		auto end = array::end(operands);
-		RETURN_ERROR(write_object(stream, *it, tabs, true));
+		RETURN_ERROR(write_object(out, *it, tabs, true));
 		for (++it; it != end; ++it) {
 			RETURN_ERROR(
-				io::write(stream, op_string(object::op(*it)), 3) &&
-				write_object(stream, *it, tabs, false)
+				write_raw(out, op_string(object::op(*it)), 3) &&
+				write_object(out, *it, tabs, false)
 			);
 		}
 	}
 	if (scoped) {
-		RETURN_ERROR(io::write_value(stream, ')'));
+		RETURN_ERROR(write_char(out, ')'));
 	}
 	return true;
 }
@@ -165,7 +309,7 @@ inline bool would_write_value(Object const& obj, bool const is_tag) {
 }
 
 static bool write_value(
-	IWriter& stream,
+	TextWriter& out,
 	Object const& obj,
 	unsigned tabs,
 	bool would_write,
@@ -173,67 +317,77 @@ static bool write_value(
 ) {
 	if (would_write) {
 		if (is_tag) {
-			RETURN_ERROR(io::write_value(stream, '='));
+			RETURN_ERROR(write_char(out, '='));
 		} else if (object::is_named(obj)) {
-			RETURN_ERROR(io::write(stream, " = ", 3));
+			RETURN_ERROR(out.compact ? write_char(out, '=') : write_raw(out, " = ", 3));
 		}
-		RETURN_ERROR(write_markers(stream, obj));
+		RETURN_ERROR(write_markers(out, obj));
 	} else if (!is_tag) {
-		RETURN_ERROR(write_markers(stream, obj));
+		RETURN_ERROR(write_markers(out, obj));
 	}
 
 	switch (object::type(obj)) {
 	case ObjectValueType::null:
 		if (would_write) {
-			RETURN_ERROR(io::write(stream, "null", 4));
+			RETURN_ERROR(write_raw(out, "null", 4));
 		}
 		break;
 
 	case ObjectValueType::boolean:
 		if (obj.value.boolean) {
-			RETURN_ERROR(io::write(stream, "true", 4));
+			RETURN_ERROR(write_raw(out, "true", 4));
 		} else {
-			RETURN_ERROR(io::write(stream, "false", 5));
+			RETURN_ERROR(write_raw(out, "false", 5));
 		}
 		break;
 
 	case ObjectValueType::integer:
-		RETURN_ERROR(writef(stream, "%ld", obj.value.numeric.integer));
+		RETURN_ERROR(write_signed(out, obj.value.numeric.integer));
 		goto l_write_unit;
 
 	case ObjectValueType::decimal:
-		RETURN_ERROR(writef(stream, "%.6lg", obj.value.numeric.decimal));
+		RETURN_ERROR(write_decimal(out, obj.value.numeric.decimal));
 		goto l_write_unit;
 
 	case ObjectValueType::currency: {
-		RETURN_ERROR(io::write(stream, "\xC2\xA4", 2)); // ¤ in UTF-8
-		s64 value = 0;
+		RETURN_ERROR(write_raw(out, "\xC2\xA4", 2)); // ¤ in UTF-8
+		u64 value = 0;
 		if (obj.value.numeric.c.value < 0) {
-			RETURN_ERROR(io::write_value(stream, '-'));
-			value = -obj.value.numeric.c.value;
+			RETURN_ERROR(write_char(out, '-'));
+			value = u64{0} - static_cast<u64>(obj.value.numeric.c.value);
 		} else {
-			value = obj.value.numeric.c.value;
+			value = static_cast<u64>(obj.value.numeric.c.value);
 		}
 		if (obj.value.numeric.c.exponent == 0) {
-			RETURN_ERROR(writef(stream, "%li", value));
+			RETURN_ERROR(write_unsigned(out, value));
 		} else if (obj.value.numeric.c.exponent < 0) {
-			RETURN_ERROR(writef(stream, "0.%0*li", -obj.value.numeric.c.exponent, value));
+			RETURN_ERROR(
+				write_raw(out, "0.", 2) &&
+				write_unsigned(out, value, unsigned_cast(-obj.value.numeric.c.exponent))
+			);
 		} else {
-			u64 scale = object::pow_int(10, obj.value.numeric.c.exponent);
-			s64 minor = value % scale;
-			RETURN_ERROR(writef(
-				stream, "%li.%0*li",
-				(value - minor) / scale,
-				obj.value.numeric.c.exponent, minor
-			));
+			// 10^20 exceeds u64, so every value is fractional past 19 digits
+			unsigned const exponent = unsigned_cast(obj.value.numeric.c.exponent);
+			u64 major = 0;
+			u64 minor = value;
+			if (exponent <= 19) {
+				u64 const scale = object::pow_int(10, exponent);
+				major = value / scale;
+				minor = value % scale;
+			}
+			RETURN_ERROR(
+				write_unsigned(out, major) &&
+				write_char(out, '.') &&
+				write_unsigned(out, minor, exponent)
+			);
 		}
 	}	goto l_write_unit;
 
 	l_write_unit:
 		if (object::has_unit(obj)) {
-			RETURN_ERROR(write_identifier(stream, object::unit(obj)));
+			RETURN_ERROR(write_identifier(out, object::unit(obj)));
 		} else if (object::is_currency(obj)) {
-			RETURN_ERROR(io::write(stream, "unknown", 7));
+			RETURN_ERROR(write_raw(out, "unknown", 7));
 		}
 		break;
 
@@ -243,12 +397,12 @@ static bool write_value(
 		if (object::has_date(obj)) {
 			Date date = time::gregorian::date(t);
 			if (!object::is_year_contextual(obj)) {
-				RETURN_ERROR(writef(stream, "%04d-", date.year));
+				RETURN_ERROR(write_signed(out, date.year, 4) && write_char(out, '-'));
 			}
 			if (!object::is_month_contextual(obj)) {
-				RETURN_ERROR(writef(stream, "%02d-", date.month));
+				RETURN_ERROR(write_signed(out, date.month, 2) && write_char(out, '-'));
 			}
-			RETURN_ERROR(writef(stream, "%02d", date.day));
+			RETURN_ERROR(write_signed(out, date.day, 2));
 			if (
 				object::has_clock(obj) || (
 					object::is_zoned(obj)
@@ -256,23 +410,29 @@ static bool write_value(
 					: object::is_month_contextual(obj)
 				)
 			) {
-				RETURN_ERROR(io::write_value(stream, 'T'));
+				RETURN_ERROR(write_char(out, 'T'));
 			}
 		}
 		if (object::has_clock(obj)) {
 			time::clock(t, h, m, s);
-			RETURN_ERROR(writef(stream, "%02d:%02d:%02d", h, m, s));
+			RETURN_ERROR(
+				write_signed(out, h, 2) && write_char(out, ':') &&
+				write_signed(out, m, 2) && write_char(out, ':') &&
+				write_signed(out, s, 2)
+			);
 		}
 		if (object::is_zoned(obj)) {
 			if (t.zone_offset == 0) {
-				RETURN_ERROR(io::write(stream, "Z", 1));
+				RETURN_ERROR(write_raw(out, "Z", 1));
 			} else {
 				bool negative = t.zone_offset < 0;
 				time::clock(Time{negative ? -t.zone_offset : t.zone_offset, 0}, h, m, s);
-				if (m == 0) {
-					RETURN_ERROR(writef(stream, "%c%02d", negative ? '-' : '+', h));
-				} else {
-					RETURN_ERROR(writef(stream, "%c%02d:%02d", negative ? '-' : '+', h, m));
+				RETURN_ERROR(
+					write_char(out, negative ? '-' : '+') &&
+					write_signed(out, h, 2)
+				);
+				if (m != 0) {
+					RETURN_ERROR(write_char(out, ':') && write_signed(out, m, 2));
 				}
 			}
 		}
@@ -280,18 +440,18 @@ static bool write_value(
 
 	case ObjectValueType::string:
 		if (object::has_string_type(obj)) {
-			RETURN_ERROR(write_identifier(stream, object::string_type(obj)));
+			RETURN_ERROR(write_identifier(out, object::string_type(obj)));
 		}
-		RETURN_ERROR(write_string(stream, object::string(obj)));
+		RETURN_ERROR(write_string(out, object::string(obj)));
 		break;
 
 	case ObjectValueType::identifier:
-		RETURN_ERROR(write_identifier(stream, object::identifier(obj)));
+		RETURN_ERROR(write_identifier(out, object::identifier(obj)));
 		break;
 
 	case ObjectValueType::expression:
 		RETURN_ERROR(write_expression(
-			stream, obj, tabs,
+			out, obj, tabs,
 			is_tag ||
 			(obj.properties & object::M_VALUE_MARKERS) ||
 			object::has_source(obj) ||
@@ -305,95 +465,109 @@ static bool write_value(
 }
 
 static bool write_tag(
-	IWriter& stream,
+	TextWriter& out,
 	Object const& obj,
 	unsigned tabs,
 	bool scope_childless
 ) {
 	bool const would_write = would_write_value(obj, true);
 
-	RETURN_ERROR(io::write_value(stream, ':'));
+	RETURN_ERROR(write_char(out, ':'));
 	if (!would_write) {
-		RETURN_ERROR(write_markers(stream, obj));
+		RETURN_ERROR(write_markers(out, obj));
 	}
 	if (object::is_named(obj)) {
-		RETURN_ERROR(write_identifier(stream, object::name(obj)));
+		RETURN_ERROR(write_identifier(out, object::name(obj)));
 	}
-	RETURN_ERROR(write_value(stream, obj, tabs, would_write, true));
+	RETURN_ERROR(write_value(out, obj, tabs, would_write, true));
 
 	if (object::has_children(obj)) {
-		RETURN_ERROR(io::write_value(stream, '('));
+		RETURN_ERROR(write_char(out, '('));
 		auto& last_child = array::back(object::children(obj));
 		for (auto& child : object::children(obj)) {
 			RETURN_ERROR(
-				write_object(stream, child, tabs) &&
-				(&child == &last_child || io::write(stream, ", ", 2))
+				write_object(out, child, tabs) &&
+				(&child == &last_child || write_separator(out))
 			);
 		}
-		RETURN_ERROR(io::write_value(stream, ')'));
+		RETURN_ERROR(write_char(out, ')'));
 	} else if (scope_childless || (
 		!would_write &&
 		!object::is_named(obj) &&
 		!(obj.properties & object::M_VALUE_MARKERS)
 	)) {
-		RETURN_ERROR(io::write(stream, "()", 2));
+		RETURN_ERROR(write_raw(out, "()", 2));
 	}
 	return true;
 }
 
 static bool write_object(
-	IWriter& stream,
+	TextWriter& out,
 	Object const& obj,
 	unsigned tabs,
 	bool named
 ) {
 	if (named && object::is_named(obj)) {
-		RETURN_ERROR(write_identifier(stream, object::name(obj)));
+		RETURN_ERROR(write_identifier(out, object::name(obj)));
 	}
-	RETURN_ERROR(write_value(stream, obj, tabs, would_write_value(obj, false), false));
+	RETURN_ERROR(write_value(out, obj, tabs, would_write_value(obj, false), false));
 
 	if (object::has_source(obj) || object::marker_source_uncertain(obj)) {
-		RETURN_ERROR(write_source(stream, object::source(obj), object::marker_source_uncertain(obj)));
+		RETURN_ERROR(write_source(out, object::source(obj), object::marker_source_uncertain(obj)));
 		if (object::has_sub_source(obj) || object::marker_sub_source_uncertain(obj)) {
-			RETURN_ERROR(write_source(stream, object::sub_source(obj), object::marker_sub_source_uncertain(obj)));
+			RETURN_ERROR(write_source(out, object::sub_source(obj), object::marker_sub_source_uncertain(obj)));
 		}
 	}
 
 	// TODO: split pre- and post-tags
 	for (auto& tag : object::tags(obj)) {
-		RETURN_ERROR(write_tag(stream, tag, tabs, false));
+		RETURN_ERROR(write_tag(out, tag, tabs, false));
 	}
-	if (object::has_children(obj)) {
-		RETURN_ERROR(io::write(stream, "{\n", 2));
+	if (object::has_children(obj) && out.compact) {
+		RETURN_ERROR(write_char(out, '{'));
+		auto& last_child = array::back(object::children(obj));
+		for (auto& child : object::children(obj)) {
+			writer_mark(out, obj);
+			RETURN_ERROR(
+				write_object(out, child, tabs) &&
+				(&child == &last_child || write_char(out, ','))
+			);
+		}
+		writer_mark(out, obj);
+		RETURN_ERROR(write_char(out, '}'));
+	} else if (object::has_children(obj)) {
+		RETURN_ERROR(write_raw(out, "{\n", 2));
 		++tabs;
 		for (auto& child : object::children(obj)) {
+			writer_mark(out, obj);
 			RETURN_ERROR(
-				write_tabs(stream, tabs) &&
-				write_object(stream, child, tabs) &&
-				io::write_value(stream, '\n')
+				write_tabs(out, tabs) &&
+				write_object(out, child, tabs) &&
+				write_char(out, '\n')
 			);
 		}
+		writer_mark(out, obj);
 		--tabs;
 		RETURN_ERROR(
-			write_tabs(stream, tabs) &&
-			io::write_value(stream, '}')
+			write_tabs(out, tabs) &&
+			write_char(out, '}')
 		);
 	}
 	if (object::has_quantity(obj)) {
 		auto& quantity = *object::quantity(obj);
-		RETURN_ERROR(io::write_value(stream, '['));
+		RETURN_ERROR(write_char(out, '['));
 		if (object::is_null(quantity) && object::has_children(quantity)) {
 			auto& last_child = array::back(object::children(quantity));
 			for (auto& child : object::children(quantity)) {
 				RETURN_ERROR(
-					write_object(stream, child, tabs) &&
-					(&child == &last_child || io::write(stream, ", ", 2))
+					write_object(out, child, tabs) &&
+					(&child == &last_child || write_separator(out))
 				);
 			}
 		} else {
-			RETURN_ERROR(write_object(stream, quantity, tabs));
+			RETURN_ERROR(write_object(out, quantity, tabs));
 		}
-		RETURN_ERROR(io::write_value(stream, ']'));
+		RETURN_ERROR(write_char(out, ']'));
 	}
 	return true;
 }
@@ -0,0 +1,299 @@
+#line 2 "quanta/core/object/io_binary.cpp"
+/**
+@copyright MIT license; see @ref index or the accompanying LICENSE file.
+*/
+
+#include <quanta/core/config.hpp>
+#include <quanta/core/object/object.hpp>
+
+#include <togo/core/error/assert.hpp>
+#include <togo/core/log/log.hpp>
+#include <togo/core/memory/memory.hpp>
+#include <togo/core/string/string.hpp>
+#include <togo/core/io/types.hpp>
+#include <togo/core/io/io.hpp>
+#include <togo/core/io/file_stream.hpp>
+
+#include <quanta/core/object/io/mapped_file.ipp>
+
+#include <cstring>
+
+namespace quanta {
+
+namespace object {
+namespace {
+
+// Binary format
+//
+// A header followed by the data of a FrozenObjectDocument, which is
+// position-independent and is used in place when the file is mapped.
+// Values are in host byte order; a file from a host with a different byte
+// order or FrozenObject layout fails the header check.
+
+enum : u32 {
+	BINARY_VERSION = 1,
+};
+
+static char const BINARY_MAGIC[4]{'Q', 'O', 'B', 'J'};
+
+struct BinaryHeader {
+	char magic[4];
+	u32 version;
+	u32 object_size;
+	u32 num_objects;
+	u32 size;
+	u32 reserved[3];
+};
+
+static_assert(
+	sizeof(BinaryHeader) % alignof(FrozenObject) == 0,
+	"binary header must keep document data aligned"
+);
+
+static bool binary_check_header(BinaryHeader const& header, u64 const available) {
+	return
+		std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0 &&
+		header.version == BINARY_VERSION &&
+		header.object_size == sizeof(FrozenObject) &&
+		header.num_objects > 0 &&
+		u64{header.num_objects} * sizeof(FrozenObject) <= header.size &&
+		header.size <= available
+	;
+}
+
+static bool binary_check_string(u64 const position, FrozenObject::String const s, u32 const size) {
+	return s.size == 0 || position + s.offset + s.size <= size;
+}
+
+// Check that all offsets of the document stay in bounds and that
+// sub-object blocks only refer forward, so the data can be traversed
+// safely. This does not decode anything.
+static bool binary_check_data(FrozenObject const* const data, u32 const num_objects, u32 const size) {
+	unsigned const type_mask = (unsigned_cast(ObjectValueType::expression) << 1) - 1;
+	u64 const objects_size = u64{num_objects} * sizeof(FrozenObject);
+	for (u32 i = 0; i < num_objects; ++i) {
+		auto const& node = data[i];
+		u64 const position = u64{i} * sizeof(FrozenObject);
+		unsigned const type = node.properties & type_mask;
+		if (type == 0 || (type & (type - 1)) != 0) {
+			return false;
+		}
+		u64 const num_subs
+			= u64{node.num_operands}
+			+ node.num_tags
+			+ node.num_children
+			+ (node.has_quantity ? 1 : 0)
+		;
+		if (num_subs > 0 && (
+			node.subs == 0 ||
+			node.subs % sizeof(FrozenObject) != 0 ||
+			position + node.subs + num_subs * sizeof(FrozenObject) > objects_size
+		)) {
+			return false;
+		}
+		if (!(
+			binary_check_string(position, node.name, size) &&
+			binary_check_string(position, node.value_name, size) &&
+			(!object::is_string(node) || binary_check_string(position, node.value.string, size))
+		)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+enum : u32 {
+	BINARY_READ_CHUNK_SIZE = 1024 * 1024,
+};
+
+// Read size bytes of document data. The buffer grows as data arrives
+// instead of being allocated up front, so a header with a bogus size
+// cannot force a large allocation.
+static FrozenObject* binary_read_chunked(Allocator& allocator, IReader& stream, u32 const size) {
+	u32 capacity = min(size, u32{BINARY_READ_CHUNK_SIZE});
+	u8* data = static_cast<u8*>(allocator.allocate(capacity, alignof(FrozenObject)));
+	u32 filled = 0;
+	while (filled < size) {
+		if (filled == capacity) {
+			u32 const new_capacity = static_cast<u32>(min(u64{capacity} * 2, u64{size}));
+			u8* const new_data = static_cast<u8*>(allocator.allocate(new_capacity, alignof(FrozenObject)));
+			std::memcpy(new_data, data, filled);
+			allocator.deallocate(data);
+			data = new_data;
+			capacity = new_capacity;
+		}
+		unsigned read_size = 0;
+		io::read(stream, data + filled, capacity - filled, &read_size);
+		if (read_size == 0) {
+			allocator.deallocate(data);
+			return nullptr;
+		}
+		filled += read_size;
+	}
+	return reinterpret_cast<FrozenObject*>(data);
+}
+
+static bool binary_read_data(FrozenObjectDocument& doc, IReader& stream) {
+	BinaryHeader header;
+	if (!io::read(stream, &header, sizeof(header))) {
+		return false;
+	}
+	if (!binary_check_header(header, 0xFFFFFFFFu)) {
+		return false;
+	}
+	doc._data = binary_read_chunked(*doc._allocator, stream, header.size);
+	if (!doc._data) {
+		return false;
+	}
+	doc._num_objects = header.num_objects;
+	doc._size = header.size;
+	return binary_check_data(doc._data, doc._num_objects, doc._size);
+}
+
+static void binary_log_error(StringRef const& path, char const* const message) {
+	TOGO_LOG_ERRORF(
+		"failed to read object from '%.*s': %s\n",
+		path.size, path.data, message
+	);
+}
+
+} // anonymous namespace
+} // namespace object
+
+/// Read binary-format object from stream into frozen document.
+///
+/// The document is cleared first. Returns false if the data is not a
+/// valid binary object, in which case the document is left empty.
+bool object::read_binary(FrozenObjectDocument& doc, IReader& stream) {
+	object::clear(doc);
+	if (!object::binary_read_data(doc, stream)) {
+		object::clear(doc);
+		return false;
+	}
+	return true;
+}
+
+/// Read binary-format object from stream.
+///
+/// root is replaced by the object that was written.
+bool object::read_binary(Object& root, IReader& stream) {
+	FrozenObjectDocument doc{};
+	if (!object::read_binary(doc, stream)) {
+		return false;
+	}
+	object::copy(root, object::root(doc));
+	return true;
+}
+
+/// Read binary-format object from file into frozen document.
+///
+/// The file is memory-mapped and used in place if possible, otherwise it
+/// is read through a stream. Mapped data is only checked for bounds; it is
+/// not decoded or copied.
+bool object::read_binary_file(FrozenObjectDocument& doc, StringRef const& path) {
+	object::clear(doc);
+	MappedFile file{};
+	if (object::mapped_file_open(file, path)) {
+		if (file.size < sizeof(BinaryHeader)) {
+			object::binary_log_error(path, "invalid header");
+			return false;
+		}
+		auto const& header = *static_cast<BinaryHeader const*>(file.data);
+		if (!object::binary_check_header(header, file.size - sizeof(BinaryHeader))) {
+			object::binary_log_error(path, "invalid header");
+			return false;
+		}
+		auto const data = reinterpret_cast<FrozenObject*>(
+			static_cast<u8*>(file.data) + sizeof(BinaryHeader)
+		);
+		if (!object::binary_check_data(data, header.num_objects, header.size)) {
+			object::binary_log_error(path, "invalid data");
+			return false;
+		}
+		doc._data = data;
+		doc._num_objects = header.num_objects;
+		doc._size = header.size;
+		doc._mapping = file.data;
+		doc._mapping_size = file.size;
+		// Owned by the document now
+		file.data = nullptr;
+		file.size = 0;
+		return true;
+	}
+
+	FileReader stream{};
+	if (!stream.open(path)) {
+		object::binary_log_error(path, "failed to open file");
+		return false;
+	}
+	bool const success = object::read_binary(doc, stream);
+	stream.close();
+	if (!success) {
+		object::binary_log_error(path, "invalid data");
+	}
+	return success;
+}
+
+/// Read binary-format object from file.
+///
+/// root is replaced by the object that was written.
+bool object::read_binary_file(Object& root, StringRef const& path) {
+	FrozenObjectDocument doc{};
+	if (!object::read_binary_file(doc, path)) {
+		return false;
+	}
+	object::copy(root, object::root(doc));
+	return true;
+}
+
+/// Write frozen document to stream in binary format.
+bool object::write_binary(FrozenObjectDocument const& doc, IWriter& stream) {
+	BinaryHeader header{};
+	std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	header.version = BINARY_VERSION;
+	header.object_size = sizeof(FrozenObject);
+	if (doc._data) {
+		header.num_objects = doc._num_objects;
+		header.size = doc._size;
+		return
+			io::write(stream, &header, sizeof(header)) &&
+			io::write(stream, doc._data, doc._size)
+		;
+	} else {
+		// Empty document; write a null root
+		header.num_objects = 1;
+		header.size = sizeof(FrozenObject);
+		return
+			io::write(stream, &header, sizeof(header)) &&
+			io::write(stream, &object::root(doc), sizeof(FrozenObject))
+		;
+	}
+}
+
+/// Write object to stream in binary format.
+///
+/// The whole tree of obj is written: its value, properties, source,
+/// name, expression operands, tags, children and quantity. Reading it back
+/// gives an object that is equal to obj, including its source lines.
+bool object::write_binary(Object const& obj, IWriter& stream) {
+	FrozenObjectDocument doc{};
+	object::freeze(doc, obj);
+	return object::write_binary(doc, stream);
+}
+
+/// Write object to file in binary format.
+bool object::write_binary_file(Object const& obj, StringRef const& path) {
+	FileWriter stream{};
+	if (!stream.open(path, false)) {
+		TOGO_LOG_ERRORF(
+			"failed to write object to '%.*s': failed to open file\n",
+			path.size, path.data
+		);
+		return false;
+	}
+	bool const success = object::write_binary(obj, stream);
+	stream.close();
+	return success;
+}
+
+} // namespace quanta
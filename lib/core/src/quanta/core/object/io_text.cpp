@@ -13,19 +13,264 @@
 #include <togo/core/memory/temp_allocator.hpp>
 #include <togo/core/collection/array.hpp>
 #include <togo/core/string/string.hpp>
+#include <togo/core/system/system.hpp>
 #include <togo/core/io/types.hpp>
 #include <togo/core/io/io.hpp>
 #include <togo/core/io/memory_stream.hpp>
 #include <togo/core/io/file_stream.hpp>
+#include <togo/core/lua/types.hpp>
 
 #include <quanta/core/object/io/common.ipp>
+#include <quanta/core/object/io/mapped_file.ipp>
+#include <quanta/core/object/io/scan.ipp>
 #include <quanta/core/object/io/parser.ipp>
+#include <quanta/core/object/io/builder.ipp>
 #include <quanta/core/object/io/writer.ipp>
+#include <quanta/core/object/io/file_update.ipp>
 
+#include <atomic>
+#include <thread>
 #include <cstdio>
 
 namespace quanta {
 
+namespace object {
+
+TOGO_LUA_MARK_USERDATA_ANCHOR(ObjectTextLayout);
+
+namespace {
+
+static void read_text_init(ObjectParser& p, bool single_value) {
+	array::reserve(p.stack, 32);
+	array::reserve(p.buffer,
+		4096 - (1 * sizeof(void*))
+		- (32 * sizeof(ObjectParser::Branch))
+		- (32 * sizeof(ObjectBuilder::Level))
+	);
+	parser_init(p, single_value);
+}
+
+// The builder sets the line of root from its first object
+static void read_text_root_line(ObjectParser const& p, Object& root) {
+	if (object::source_line(root) == 0) {
+		object::set_source_line(root, p.line);
+	}
+}
+
+// Read into root through the builder of p
+static bool read_text_impl(ObjectParser& p, Object& root, bool single_value) {
+	object::clear(root);
+	read_text_init(p, single_value);
+	if (!parser_read(p)) {
+		return false;
+	}
+	read_text_root_line(p, root);
+	return true;
+}
+
+static bool read_text_resume_impl(ObjectParser& p, Object& root, ObjectTextCheckpoint& checkpoint) {
+	auto& children = object::children(root);
+	if (checkpoint.offset == 0) {
+		object::clear(root);
+		checkpoint = {0, 1, 0, 0};
+	} else {
+		TOGO_ASSERTE(array::size(children) >= checkpoint.num_children);
+		array::resize(children, checkpoint.num_children);
+		// The incomplete last object may be read again with another name
+		object::clear_indexes(root);
+	}
+	read_text_init(p, false);
+	p.line = checkpoint.line;
+	p.column = checkpoint.column;
+	p.input_offset = checkpoint.offset;
+	p.checkpoint = &checkpoint;
+	p.num_objects = checkpoint.num_children;
+	if (parser_read(p)) {
+		// Drop the last object if it might continue in appended input
+		array::resize(children, checkpoint.num_children);
+		read_text_root_line(p, root);
+		return true;
+	} else if (p.c == PC_EOF) {
+		// Incomplete object at the end of the input; it will be read again
+		// from the checkpoint once more input is available
+		array::resize(children, checkpoint.num_children);
+		p.info.line = 0;
+		p.info.column = 0;
+		p.info.message[0] = '\0';
+		return true;
+	}
+	return false;
+}
+
+// Resume from stream positioned at checkpoint.offset
+static bool read_text_resume_stream(
+	Object& root,
+	IReader& stream,
+	ObjectTextCheckpoint& checkpoint,
+	ObjectParserInfo& pinfo
+) {
+	TempAllocator<4096> allocator{};
+	ObjectBuilder builder{root, false, allocator};
+	ObjectParser p{stream, builder, pinfo, allocator};
+	return read_text_resume_impl(p, root, checkpoint);
+}
+
+enum : unsigned {
+	PARALLEL_MIN_RANGE_SIZE = 64 * 1024,
+	PARALLEL_MAX_WORKERS = 32,
+	PARALLEL_RANGES_PER_WORKER = 4,
+};
+
+struct ParallelRead {
+	Array<ScanSplit> ranges;
+	Array<Object> roots;
+	Array<ObjectParserInfo> infos;
+	Array<bool> results;
+	u8 const* end;
+	std::atomic<unsigned> next;
+
+	ParallelRead(Allocator& allocator)
+		: ranges(allocator)
+		, roots(allocator)
+		, infos(allocator)
+		, results(allocator)
+		, end(nullptr)
+		, next(0)
+	{}
+};
+
+static void read_text_parallel_worker(ParallelRead& state) {
+	// NB: TempAllocator falls back to the scratch allocator, which is not
+	// thread-safe; each worker has its own arena for parser state instead
+	ObjectArena allocator{memory::default_allocator()};
+	unsigned const num_ranges = array::size(state.ranges);
+	unsigned index;
+	while ((index = state.next++) < num_ranges) {
+		auto const& range = state.ranges[index];
+		u8 const* const range_end
+			= index + 1 < num_ranges
+			? state.ranges[index + 1].pos
+			: state.end
+		;
+		{
+		ObjectBuilder builder{state.roots[index], false, allocator};
+		ObjectParser p{
+			StringRef{
+				reinterpret_cast<char const*>(range.pos),
+				static_cast<unsigned>(range_end - range.pos)
+			},
+			builder, state.infos[index], allocator
+		};
+		read_text_init(p, false);
+		p.line = range.line;
+		state.results[index] = parser_read(p);
+		}
+		allocator.reset();
+	}
+}
+
+enum : unsigned {
+	PARALLEL_MIN_WRITE_CHILDREN = 1024,
+};
+
+// Write children [begin, end) of root; each is followed by a newline unless
+// it is the last child
+static bool write_text_children(
+	TextWriter& out,
+	Object const& root,
+	unsigned const begin,
+	unsigned const end
+) {
+	auto const& children = object::children(root);
+	for (unsigned i = begin; i < end; ++i) {
+		writer_mark(out, root);
+		if (!(
+			write_object(out, children[i], 0) &&
+			(i + 1 == array::size(children) || write_char(out, '\n'))
+		)) {
+			return false;
+		}
+	}
+	if (end == array::size(children)) {
+		writer_mark(out, root);
+	}
+	return true;
+}
+
+static bool write_text_impl(TextWriter& out, Object const& obj, bool const single_value) {
+	if (single_value) {
+		return write_object(out, obj, 0);
+	}
+	return write_text_children(out, obj, 0, array::size(object::children(obj)));
+}
+
+struct ParallelWrite {
+	Object const* root;
+	unsigned num_children;
+	unsigned num_ranges;
+	bool compact;
+	Array<MemoryStream*> outputs;
+	Array<bool> results;
+	std::atomic<unsigned> next;
+
+	ParallelWrite(Allocator& allocator)
+		: root(nullptr)
+		, num_children(0)
+		, num_ranges(0)
+		, compact(false)
+		, outputs(allocator)
+		, results(allocator)
+		, next(0)
+	{}
+};
+
+static void write_text_parallel_worker(ParallelWrite& state) {
+	unsigned index;
+	while ((index = state.next++) < state.num_ranges) {
+		unsigned const begin = u64{state.num_children} * index / state.num_ranges;
+		unsigned const end = u64{state.num_children} * (index + 1) / state.num_ranges;
+		auto& output = *state.outputs[index];
+		TextWriter out{output};
+		out.compact = state.compact;
+		state.results[index]
+			= write_text_children(out, *state.root, begin, end)
+			&& writer_flush(out)
+			&& io::status(output).ok()
+		;
+	}
+}
+
+inline ObjectTextLayout::Part text_layout_part(u8 const* const data, u64 const begin, u64 const end) {
+	return {
+		hash::calc<hash::Default64>(
+			reinterpret_cast<char const*>(data + begin),
+			static_cast<unsigned>(end - begin)
+		),
+		end - begin
+	};
+}
+
+inline bool text_layout_part_equal(ObjectTextLayout::Part const& a, ObjectTextLayout::Part const& b) {
+	return a.hash == b.hash && a.size == b.size;
+}
+
+} // anonymous namespace
+} // namespace object
+
+/// Construct empty layout with the default allocator.
+ObjectTextLayout::ObjectTextLayout()
+	: ObjectTextLayout(memory::default_allocator())
+{}
+
+/// Construct empty layout with allocator for records.
+ObjectTextLayout::ObjectTextLayout(Allocator& allocator)
+	: head{}
+	, records(allocator)
+	, tail{}
+	, size(0)
+	, mtime(0)
+{}
+
 /// Read text-format object from stream.
 ///
 /// If single_value is true, reads directly into root. If there are multiple
@@ -34,13 +279,9 @@ namespace quanta {
 /// error message of the parser.
 bool object::read_text(Object& root, IReader& stream, ObjectParserInfo& pinfo, bool single_value IGEN_DEFAULT(false)) {
 	TempAllocator<4096> allocator{};
-	ObjectParser p{stream, pinfo, allocator};
-	array::reserve(p.stack, 32);
-	array::reserve(p.buffer, 4096 - (1 * sizeof(void*)) - (32 * sizeof(ObjectParser::Branch)));
-
-	object::clear(root);
-	parser_init(p, root, single_value);
-	return parser_read(p);
+	ObjectBuilder builder{root, single_value, allocator};
+	ObjectParser p{stream, builder, pinfo, allocator};
+	return read_text_impl(p, root, single_value);
 }
 
 /// Read text-format object from stream (sans parser info).
@@ -57,10 +298,19 @@ bool object::read_text(Object& root, IReader& stream, bool single_value IGEN_DEF
 }
 
 /// Read text-format object from string.
+///
+/// The string is scanned in place. See read_text() for details.
+bool object::read_text_string(Object& root, StringRef text, ObjectParserInfo& pinfo, bool single_value IGEN_DEFAULT(false)) {
+	TempAllocator<4096> allocator{};
+	ObjectBuilder builder{root, single_value, allocator};
+	ObjectParser p{text, builder, pinfo, allocator};
+	return read_text_impl(p, root, single_value);
+}
+
+/// Read text-format object from string (sans parser info).
 bool object::read_text_string(Object& root, StringRef text, bool single_value IGEN_DEFAULT(false)) {
 	ObjectParserInfo pinfo{};
-	MemoryReader stream{text};
-	if (!object::read_text(root, stream, pinfo, single_value)) {
+	if (!object::read_text_string(root, text, pinfo, single_value)) {
 		TOGO_LOG_ERRORF(
 			"failed to read object: [%2u,%2u]: %s\n",
 			pinfo.line, pinfo.column, pinfo.message
@@ -70,19 +320,342 @@ bool object::read_text_string(Object& root, StringRef text, bool single_value IG
 	return true;
 }
 
+/// Read text-format objects from string in parallel.
+///
+/// The top level of the document is split at line boundaries into ranges
+/// that are read on up to num_workers threads (the number of cores if 0) and
+/// spliced into root in order. Small documents and roots that do not use
+/// the default allocator (such as the root of an ObjectDocument) are read on
+/// the calling thread.
+/// Returns false if a parser error occurred. pinfo will have the position and
+/// error message of the first error in the document.
+bool object::read_text_string_parallel(
+	Object& root,
+	StringRef text,
+	ObjectParserInfo& pinfo,
+	unsigned num_workers IGEN_DEFAULT(0)
+) {
+	if (num_workers == 0) {
+		num_workers = system::num_cores();
+	}
+	num_workers = min(num_workers, unsigned{PARALLEL_MAX_WORKERS});
+	if (
+		num_workers <= 1 ||
+		text.size < 2 * PARALLEL_MIN_RANGE_SIZE ||
+		&object::allocator(root) != &memory::default_allocator()
+	) {
+		return object::read_text_string(root, text, pinfo, false);
+	}
+
+	u8 const* const begin = reinterpret_cast<u8 const*>(text.data);
+	unsigned const max_ranges = num_workers * PARALLEL_RANGES_PER_WORKER;
+	ParallelRead state{memory::default_allocator()};
+	state.end = begin + text.size;
+	array::resize(state.ranges, max_ranges);
+	state.ranges[0] = {begin, 1};
+	unsigned const num_ranges = 1 + scan_split(
+		begin, state.end,
+		max(text.size / max_ranges, unsigned{PARALLEL_MIN_RANGE_SIZE}),
+		array::begin(state.ranges) + 1,
+		max_ranges - 1
+	);
+	if (num_ranges == 1) {
+		return object::read_text_string(root, text, pinfo, false);
+	}
+	array::resize(state.ranges, num_ranges);
+	array::resize(state.roots, num_ranges);
+	array::resize(state.infos, num_ranges);
+	array::resize(state.results, num_ranges);
+
+	std::thread threads[PARALLEL_MAX_WORKERS];
+	unsigned const num_threads = min(num_workers, num_ranges) - 1;
+	for (unsigned i = 0; i < num_threads; ++i) {
+		threads[i] = std::thread{read_text_parallel_worker, std::ref(state)};
+	}
+	read_text_parallel_worker(state);
+	for (unsigned i = 0; i < num_threads; ++i) {
+		threads[i].join();
+	}
+
+	object::clear(root);
+	unsigned num_children = 0;
+	for (unsigned i = 0; i < num_ranges; ++i) {
+		if (!state.results[i]) {
+			pinfo = state.infos[i];
+			return false;
+		}
+		num_children += array::size(object::children(state.roots[i]));
+	}
+	auto& children = object::children(root);
+	array::reserve(children, num_children);
+	for (auto& range_root : state.roots) {
+		for (auto& child : object::children(range_root)) {
+			array::push_back_inplace(children, rvalue_ref(child));
+		}
+	}
+	pinfo.line = 0;
+	pinfo.column = 0;
+	pinfo.message[0] = '\0';
+	return true;
+}
+
+/// Read text-format objects from file in parallel.
+///
+/// See read_text_string_parallel(). Falls back to read_text_file() if the
+/// file cannot be memory-mapped.
+bool object::read_text_file_parallel(
+	Object& root,
+	StringRef const& path,
+	unsigned num_workers IGEN_DEFAULT(0)
+) {
+	MappedFile file{};
+	if (!mapped_file_open(file, path)) {
+		return object::read_text_file(root, path, false);
+	}
+	ObjectParserInfo pinfo{};
+	bool const success = object::read_text_string_parallel(
+		root, mapped_file_ref(file), pinfo, num_workers
+	);
+	mapped_file_close(file);
+	if (!success) {
+		TOGO_LOG_ERRORF(
+			"failed to read object from '%.*s': [%2u,%2u]: %s\n",
+			path.size, path.data,
+			pinfo.line, pinfo.column, pinfo.message
+		);
+	}
+	return success;
+}
+
 /// Read text-format object from file.
+///
+/// The file is memory-mapped and scanned in place if possible, otherwise it
+/// is read through a stream. Either way, strings are copied into the tree
+/// and the mapping is closed before returning; the ObjectDocument overload
+/// keeps it instead.
 bool object::read_text_file(Object& root, StringRef const& path, bool single_value IGEN_DEFAULT(false)) {
-	FileReader stream{};
-	if (!stream.open(path)) {
+	ObjectParserInfo pinfo{};
+	bool success;
+	MappedFile file{};
+	if (mapped_file_open(file, path)) {
+		success = object::read_text_string(root, mapped_file_ref(file), pinfo, single_value);
+		mapped_file_close(file);
+	} else {
+		FileReader stream{};
+		if (!stream.open(path)) {
+			TOGO_LOG_ERRORF(
+				"failed to read object from '%.*s': failed to open file\n",
+				path.size, path.data
+			);
+			return false;
+		}
+		success = object::read_text(root, stream, pinfo, single_value);
+		stream.close();
+	}
+	if (!success) {
 		TOGO_LOG_ERRORF(
-			"failed to read object from '%.*s': failed to open file\n",
-			path.size, path.data
+			"failed to read object from '%.*s': [%2u,%2u]: %s\n",
+			path.size, path.data,
+			pinfo.line, pinfo.column, pinfo.message
+		);
+	}
+	return success;
+}
+
+/// Read text-format object from stream into document.
+///
+/// The document is cleared first. See read_text() for details.
+bool object::read_text(ObjectDocument& doc, IReader& stream, ObjectParserInfo& pinfo, bool single_value IGEN_DEFAULT(false)) {
+	object::clear(doc);
+	return object::read_text(doc.root, stream, pinfo, single_value);
+}
+
+/// Read text-format object from string into document.
+///
+/// The document is cleared first. See read_text_string() for details.
+bool object::read_text_string(ObjectDocument& doc, StringRef text, ObjectParserInfo& pinfo, bool single_value IGEN_DEFAULT(false)) {
+	object::clear(doc);
+	return object::read_text_string(doc.root, text, pinfo, single_value);
+}
+
+/// Read text-format object from file into document.
+///
+/// The document is cleared first. If the file can be memory-mapped, the
+/// document keeps the mapping until it is cleared, and long strings that
+/// need no unescaping refer to the file in place instead of being copied.
+/// The file must not be changed while the document refers to it. See
+/// read_text_file() for details.
+bool object::read_text_file(ObjectDocument& doc, StringRef const& path, bool single_value IGEN_DEFAULT(false)) {
+	object::clear(doc);
+	MappedFile file{};
+	if (!mapped_file_open(file, path)) {
+		return object::read_text_file(doc.root, path, single_value);
+	}
+	StringRef const text = mapped_file_ref(file);
+	doc._mapping = file.data;
+	doc._mapping_size = file.size;
+	// Owned by the document now
+	file.data = nullptr;
+	file.size = 0;
+
+	ObjectParserInfo pinfo{};
+	TempAllocator<4096> allocator{};
+	ObjectBuilder builder{doc.root, single_value, allocator};
+	builder.shared_input = text;
+	ObjectParser p{text, builder, pinfo, allocator};
+	if (!read_text_impl(p, doc.root, single_value)) {
+		TOGO_LOG_ERRORF(
+			"failed to read object from '%.*s': [%2u,%2u]: %s\n",
+			path.size, path.data,
+			pinfo.line, pinfo.column, pinfo.message
 		);
 		return false;
 	}
+	return true;
+}
+
+/// Read text-format objects from stream and visit them.
+///
+/// The parts of the objects are sent to the visitor as they are read (see
+/// IObjectVisitor). No objects are built; read_text() is the visitor that
+/// builds them.
+/// Returns false if a parser error occurred or the visitor stopped.
+bool object::read_text_visit(IReader& stream, IObjectVisitor& visitor, ObjectParserInfo& pinfo) {
+	TempAllocator<4096> allocator{};
+	ObjectParser p{stream, visitor, pinfo, allocator};
+	read_text_init(p, false);
+	return parser_read(p);
+}
+
+/// Read text-format objects from string and visit them.
+///
+/// The string is scanned in place. See read_text_visit() for details.
+bool object::read_text_string_visit(StringRef text, IObjectVisitor& visitor, ObjectParserInfo& pinfo) {
+	TempAllocator<4096> allocator{};
+	ObjectParser p{text, visitor, pinfo, allocator};
+	read_text_init(p, false);
+	return parser_read(p);
+}
 
+/// Read text-format objects from file and visit them.
+bool object::read_text_file_visit(StringRef const& path, IObjectVisitor& visitor) {
 	ObjectParserInfo pinfo{};
-	bool const success = object::read_text(root, stream, pinfo, single_value);
+	bool success;
+	MappedFile file{};
+	if (mapped_file_open(file, path)) {
+		success = object::read_text_string_visit(mapped_file_ref(file), visitor, pinfo);
+		mapped_file_close(file);
+	} else {
+		FileReader stream{};
+		if (!stream.open(path)) {
+			TOGO_LOG_ERRORF(
+				"failed to read object from '%.*s': failed to open file\n",
+				path.size, path.data
+			);
+			return false;
+		}
+		success = object::read_text_visit(stream, visitor, pinfo);
+		stream.close();
+	}
+	if (!success) {
+		TOGO_LOG_ERRORF(
+			"failed to read object from '%.*s': [%2u,%2u]: %s\n",
+			path.size, path.data,
+			pinfo.line, pinfo.column, pinfo.message
+		);
+	}
+	return success;
+}
+
+/// Resume reading text-format objects from stream.
+///
+/// Reads the top-level objects following checkpoint into the children of
+/// root and moves checkpoint past the last complete one. An incomplete object
+/// at the end of the input is dropped and read again by the next call, so
+/// input that is only ever appended to can be re-read in time proportional
+/// to the new bytes. root must have been read up to checkpoint.
+/// stream must be at the start of the input; the first checkpoint.offset
+/// bytes are skipped by reading them, since IReader is not seekable.
+/// read_text_file_resume() seeks instead.
+/// Returns false if a parser error occurred.
+bool object::read_text_resume(
+	Object& root,
+	IReader& stream,
+	ObjectTextCheckpoint& checkpoint,
+	ObjectParserInfo& pinfo
+) {
+	u8 skip_buffer[4096];
+	u64 remaining = checkpoint.offset;
+	while (remaining > 0) {
+		unsigned const size = static_cast<unsigned>(min(remaining, u64{sizeof(skip_buffer)}));
+		unsigned read_size = 0;
+		io::read(stream, skip_buffer, size, &read_size);
+		if (read_size == 0) {
+			pinfo.line = checkpoint.line;
+			pinfo.column = checkpoint.column;
+			std::snprintf(pinfo.message, array_extent(&ObjectParserInfo::message), "checkpoint is past the end of the stream");
+			return false;
+		}
+		remaining -= read_size;
+	}
+	return read_text_resume_stream(root, stream, checkpoint, pinfo);
+}
+
+/// Resume reading text-format objects from string.
+///
+/// text is the whole input, including the part before checkpoint.
+bool object::read_text_string_resume(
+	Object& root,
+	StringRef text,
+	ObjectTextCheckpoint& checkpoint,
+	ObjectParserInfo& pinfo
+) {
+	if (checkpoint.offset > text.size) {
+		pinfo.line = checkpoint.line;
+		pinfo.column = checkpoint.column;
+		std::snprintf(pinfo.message, array_extent(&ObjectParserInfo::message), "checkpoint is past the end of the string");
+		return false;
+	}
+	TempAllocator<4096> allocator{};
+	ObjectBuilder builder{root, false, allocator};
+	ObjectParser p{
+		StringRef{text.data + checkpoint.offset, static_cast<unsigned>(text.size - checkpoint.offset)},
+		builder, pinfo, allocator
+	};
+	return read_text_resume_impl(p, root, checkpoint);
+}
+
+/// Resume reading text-format objects from file.
+bool object::read_text_file_resume(
+	Object& root,
+	StringRef const& path,
+	ObjectTextCheckpoint& checkpoint
+) {
+	ObjectParserInfo pinfo{};
+	bool success;
+	MappedFile file{};
+	if (mapped_file_open(file, path)) {
+		success = object::read_text_string_resume(root, mapped_file_ref(file), checkpoint, pinfo);
+		mapped_file_close(file);
+	} else {
+		FileReader stream{};
+		if (!stream.open(path)) {
+			TOGO_LOG_ERRORF(
+				"failed to read object from '%.*s': failed to open file\n",
+				path.size, path.data
+			);
+			return false;
+		}
+		if (io::seek_to(stream, checkpoint.offset) == checkpoint.offset) {
+			success = read_text_resume_stream(root, stream, checkpoint, pinfo);
+		} else {
+			pinfo.line = checkpoint.line;
+			pinfo.column = checkpoint.column;
+			std::snprintf(pinfo.message, array_extent(&ObjectParserInfo::message), "checkpoint is past the end of the file");
+			success = false;
+		}
+		stream.close();
+	}
 	if (!success) {
 		TOGO_LOG_ERRORF(
 			"failed to read object from '%.*s': [%2u,%2u]: %s\n",
@@ -90,7 +663,6 @@ bool object::read_text_file(Object& root, StringRef const& path, bool single_val
 			pinfo.line, pinfo.column, pinfo.message
 		);
 	}
-	stream.close();
 	return success;
 }
 
@@ -117,28 +689,253 @@ bool object::read_text_file(Object& root, StringRef const& path, bool single_val
 ///
 /// If single_value is false, only the children of obj are written (without an
 /// enclosing block).
+/// With ObjectTextFormat::compact, the output has no optional whitespace
+/// and reads back to the same objects.
 /// Returns true if the write succeeded.
-bool object::write_text(Object const& obj, IWriter& stream, bool single_value IGEN_DEFAULT(false)) {
-	if (single_value) {
-		if (!write_object(stream, obj, 0)) {
+bool object::write_text(
+	Object const& obj,
+	IWriter& stream,
+	bool single_value IGEN_DEFAULT(false),
+	ObjectTextFormat format IGEN_DEFAULT(ObjectTextFormat::readable)
+) {
+	TextWriter out{stream};
+	out.compact = format == ObjectTextFormat::compact;
+	return
+		write_text_impl(out, obj, single_value) &&
+		writer_flush(out) &&
+		io::status(stream).ok()
+	;
+}
+
+/// Write text-format objects to stream in parallel.
+///
+/// The children of obj are split into ranges that are rendered on up to
+/// num_workers threads (the number of cores if 0) and written in order.
+/// The output is the same as write_text() with single_value false and the
+/// same format.
+/// Objects with few children are written on the calling thread.
+/// Returns true if the write succeeded.
+bool object::write_text_parallel(
+	Object const& obj,
+	IWriter& stream,
+	unsigned num_workers IGEN_DEFAULT(0),
+	ObjectTextFormat format IGEN_DEFAULT(ObjectTextFormat::readable)
+) {
+	if (num_workers == 0) {
+		num_workers = system::num_cores();
+	}
+	num_workers = min(num_workers, unsigned{PARALLEL_MAX_WORKERS});
+	auto const& children = object::children(obj);
+	if (num_workers <= 1 || array::size(children) < PARALLEL_MIN_WRITE_CHILDREN) {
+		return object::write_text(obj, stream, false, format);
+	}
+
+	ParallelWrite state{memory::default_allocator()};
+	state.root = &obj;
+	state.compact = format == ObjectTextFormat::compact;
+	state.num_children = array::size(children);
+	state.num_ranges = min(
+		num_workers * PARALLEL_RANGES_PER_WORKER,
+		state.num_children / (PARALLEL_MIN_WRITE_CHILDREN / PARALLEL_RANGES_PER_WORKER)
+	);
+	array::resize(state.outputs, state.num_ranges);
+	array::resize(state.results, state.num_ranges);
+	for (auto& output : state.outputs) {
+		output = TOGO_CONSTRUCT(
+			memory::default_allocator(), MemoryStream,
+			memory::default_allocator(), 64 * 1024
+		);
+	}
+
+	std::thread threads[PARALLEL_MAX_WORKERS];
+	unsigned const num_threads = min(num_workers, state.num_ranges) - 1;
+	for (unsigned i = 0; i < num_threads; ++i) {
+		threads[i] = std::thread{write_text_parallel_worker, std::ref(state)};
+	}
+	write_text_parallel_worker(state);
+	for (unsigned i = 0; i < num_threads; ++i) {
+		threads[i].join();
+	}
+
+	bool success = true;
+	for (unsigned i = 0; i < state.num_ranges; ++i) {
+		auto output = state.outputs[i];
+		success = success && state.results[i] && io::write(
+			stream,
+			array::begin(output->data()),
+			static_cast<unsigned>(output->size())
+		);
+		TOGO_DESTROY(memory::default_allocator(), output);
+	}
+	return success && io::status(stream).ok();
+}
+
+/// Write text-format object to file.
+bool object::write_text_file(
+	Object const& obj,
+	StringRef const& path,
+	bool single_value IGEN_DEFAULT(false),
+	ObjectTextFormat format IGEN_DEFAULT(ObjectTextFormat::readable)
+) {
+	FileWriter stream{};
+	if (!stream.open(path, false)) {
+		TOGO_LOG_ERRORF(
+			"failed to write object to '%.*s': failed to open file\n",
+			path.size, path.data
+		);
+		return false;
+	}
+	bool const success = object::write_text(obj, stream, single_value, format);
+	stream.close();
+	return success;
+}
+
+/// Write text-format object to file, rewriting only what changed.
+///
+/// The children of container (obj or an object in it) are the records of the
+/// file. If the file is still as described by layout and the text before the
+/// first record did not change, only the changed records are written in
+/// place. If the records after the changed ones moved, the file is
+/// rewritten from the first changed record, so appending a record or
+/// changing the last one writes only that. Otherwise, or if the patch would
+/// rewrite more than half of the file, the file is written to a temporary
+/// file that replaces it.
+///
+/// The layout is saved to path + ".layout". If layout is empty, it is loaded
+/// from there first, so separate runs can update the same file. The file's
+/// size and modification time must match the layout, otherwise the whole
+/// file is written.
+///
+/// The whole text is still rendered in memory and hashed to find the
+/// changes. Only the file I/O is proportional to the change.
+/// layout is set to the layout of the new file.
+/// Returns true if the write succeeded.
+bool object::write_text_file_update(
+	Object const& obj,
+	Object const& container,
+	StringRef const& path,
+	ObjectTextLayout& layout,
+	bool single_value IGEN_DEFAULT(false)
+) {
+	if (layout.size == 0) {
+		object::text_layout_load(layout, path);
+	}
+	MemoryStream text{
+		memory::default_allocator(),
+		static_cast<unsigned>(min(max(layout.size, u64{4096}), u64{0x7FFFFFFF}))
+	};
+	Array<u64> marks{memory::default_allocator()};
+	{
+		TextWriter out{text};
+		out.marked = &container;
+		out.marks = &marks;
+		if (!(
+			write_text_impl(out, obj, single_value) &&
+			writer_flush(out) &&
+			io::status(text).ok()
+		)) {
 			return false;
 		}
-	} else if (object::has_children(obj)) {
-		auto& last_child = array::back(object::children(obj));
-		for (auto& child : object::children(obj)) {
-			if (!(
-				write_object(stream, child, 0) &&
-				(&child == &last_child || io::write_value(stream, '\n'))
-			)) {
-				return false;
+	}
+	u8 const* const data = array::begin(text.data());
+	u64 const size = text.size();
+	if (array::empty(marks)) {
+		// No records; the whole text is the head
+		array::push_back(marks, size);
+	}
+
+	unsigned const num_records = array::size(marks) - 1;
+	unsigned const num_old_records = array::size(layout.records);
+	unsigned const num_common = min(num_records, num_old_records);
+	Array<ObjectTextLayout::Part> records{memory::default_allocator()};
+	array::reserve(records, num_records);
+	for (unsigned i = 0; i < num_records; ++i) {
+		array::push_back(records, object::text_layout_part(data, marks[i], marks[i + 1]));
+	}
+	auto const head = object::text_layout_part(data, 0, marks[0]);
+	auto const tail = object::text_layout_part(data, marks[num_records], size);
+
+	// Records [first, num_records - num_same_end) changed
+	bool const patch = layout.size > 0 && object::text_layout_part_equal(layout.head, head);
+	bool const same_tail = patch && object::text_layout_part_equal(layout.tail, tail);
+	unsigned first = 0;
+	unsigned num_same_end = 0;
+	if (patch) {
+		while (
+			first < num_common &&
+			object::text_layout_part_equal(layout.records[first], records[first])
+		) {
+			++first;
+		}
+		if (same_tail) {
+			while (
+				first + num_same_end < num_common &&
+				object::text_layout_part_equal(
+					layout.records[num_old_records - 1 - num_same_end],
+					records[num_records - 1 - num_same_end]
+				)
+			) {
+				++num_same_end;
 			}
 		}
 	}
-	return io::status(stream).ok();
+	u64 const offset = marks[first];
+	// The unchanged records at the end and the tail are in the same place if
+	// the size did not change
+	bool const in_place = same_tail && layout.size == size;
+	u64 const end = in_place ? marks[num_records - num_same_end] : size;
+
+	u64 const old_size = layout.size;
+	u64 const old_mtime = layout.mtime;
+	layout.head = head;
+	layout.tail = tail;
+	array::resize(layout.records, num_records);
+	for (unsigned i = 0; i < num_records; ++i) {
+		layout.records[i] = records[i];
+	}
+	layout.size = 0;
+	u64 mtime = 0;
+	bool success = patch && end - offset <= size - (end - offset) && object::file_patch(
+		path, old_size, old_mtime, offset,
+		data + offset, static_cast<unsigned>(end - offset), !in_place, mtime
+	);
+	if (!success) {
+		success = object::file_replace(path, data, static_cast<unsigned>(size), mtime);
+	}
+	if (!success) {
+		TOGO_LOG_ERRORF(
+			"failed to write object to '%.*s': failed to update file\n",
+			path.size, path.data
+		);
+		return false;
+	}
+	layout.size = size;
+	layout.mtime = mtime;
+	object::text_layout_save(layout, path);
+	return true;
 }
 
-/// Write text-format object to file.
-bool object::write_text_file(Object const& obj, StringRef const& path, bool single_value IGEN_DEFAULT(false)) {
+/// Write text-format object to file, rewriting only changed children.
+///
+/// See write_text_file_update(); the children of obj are the records.
+bool object::write_text_file_update(
+	Object const& obj,
+	StringRef const& path,
+	ObjectTextLayout& layout,
+	bool single_value IGEN_DEFAULT(false)
+) {
+	return object::write_text_file_update(obj, obj, path, layout, single_value);
+}
+
+/// Write text-format objects to file in parallel.
+///
+/// See write_text_parallel().
+bool object::write_text_file_parallel(
+	Object const& obj,
+	StringRef const& path,
+	unsigned num_workers IGEN_DEFAULT(0),
+	ObjectTextFormat format IGEN_DEFAULT(ObjectTextFormat::readable)
+) {
 	FileWriter stream{};
 	if (!stream.open(path, false)) {
 		TOGO_LOG_ERRORF(
@@ -147,7 +944,7 @@ bool object::write_text_file(Object const& obj, StringRef const& path, bool sing
 		);
 		return false;
 	}
-	bool const success = object::write_text(obj, stream, single_value);
+	bool const success = object::write_text_parallel(obj, stream, num_workers, format);
 	stream.close();
 	return success;
 }
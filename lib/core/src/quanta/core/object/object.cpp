@@ -14,6 +14,8 @@
 #include <togo/core/memory/memory.hpp>
 #include <togo/core/lua/types.hpp>
 
+#include <cstring>
+
 namespace quanta {
 
 namespace object {
@@ -22,6 +24,102 @@ TOGO_LUA_MARK_USERDATA_ANCHOR(Object);
 
 } // namespace object
 
+namespace object {
+namespace {
+
+enum : unsigned {
+	// Free nodes kept per thread and node size
+	POOL_MAX_FREE = 1024,
+};
+
+struct PoolNode {
+	PoolNode* next;
+};
+
+// Free lists of quantities (0) and extra storage (1)
+struct Pool {
+	PoolNode* free[2];
+	u32 num_free[2];
+	u64 hits;
+	u64 misses;
+
+	~Pool() {
+		object::pool_trim();
+	}
+};
+
+static thread_local Pool s_pool{};
+
+inline unsigned pool_list(unsigned const size) {
+	TOGO_DEBUG_ASSERTE(size == sizeof(Object) || size == sizeof(Object::Extra));
+	return size == sizeof(Object) ? 0 : 1;
+}
+
+} // anonymous namespace
+} // namespace object
+
+IGEN_PRIVATE
+void* object::pool_allocate(Allocator& allocator, unsigned const size, unsigned const align) {
+	if (&allocator != &memory::default_allocator()) {
+		return allocator.allocate(size, align);
+	}
+	auto& pool = s_pool;
+	unsigned const list = object::pool_list(size);
+	if (auto const node = pool.free[list]) {
+		pool.free[list] = node->next;
+		--pool.num_free[list];
+		++pool.hits;
+		return node;
+	}
+	++pool.misses;
+	return allocator.allocate(size, align);
+}
+
+IGEN_PRIVATE
+void object::pool_deallocate(Allocator& allocator, void* const p, unsigned const size) {
+	if (&allocator != &memory::default_allocator()) {
+		allocator.deallocate(p);
+		return;
+	}
+	auto& pool = s_pool;
+	unsigned const list = object::pool_list(size);
+	if (pool.num_free[list] == POOL_MAX_FREE) {
+		allocator.deallocate(p);
+		return;
+	}
+	auto const node = static_cast<PoolNode*>(p);
+	node->next = pool.free[list];
+	pool.free[list] = node;
+	++pool.num_free[list];
+}
+
+/// Node pool statistics of the calling thread.
+///
+/// Quantities and extra storage (see object::extra()) of objects that use
+/// the default allocator are taken from and returned to a per-thread pool.
+ObjectPoolStats object::pool_stats() {
+	auto const& pool = s_pool;
+	return {pool.hits, pool.misses, pool.num_free[0] + pool.num_free[1]};
+}
+
+/// Free the pooled nodes of the calling thread.
+///
+/// Pools of other threads are freed when the threads exit. The main
+/// thread's pool is freed after main() returns, so call this before
+/// memory::shutdown().
+void object::pool_trim() {
+	auto& pool = s_pool;
+	for (unsigned list = 0; list < 2; ++list) {
+		for (auto node = pool.free[list]; node;) {
+			auto const next = node->next;
+			memory::default_allocator().deallocate(node);
+			node = next;
+		}
+		pool.free[list] = nullptr;
+		pool.num_free[list] = 0;
+	}
+}
+
 /// Set type.
 ///
 /// Returns true if type changed.
@@ -39,7 +137,7 @@ bool object::set_type(Object& obj, ObjectValueType const type) {
 
 /// Reset value to type default.
 void object::clear_value(Object& obj) {
-	auto& a = memory::default_allocator();
+	auto& a = object::allocator(obj);
 	switch (object::type(obj)) {
 	case ObjectValueType::null:
 		break;
@@ -70,19 +168,21 @@ void object::clear_value(Object& obj) {
 		unmanaged_string::clear(obj.value.identifier, a);
 		break;
 	case ObjectValueType::expression:
-		array::set_capacity(obj.expression, 0);
+		if (obj.extra) {
+			array::set_capacity(obj.extra->expression, 0);
+		}
 		break;
 	}
 }
 
 /// Copy an object.
 void object::copy(Object& dst, Object const& src, bool const children IGEN_DEFAULT(true)) {
-	auto& a = memory::default_allocator();
+	auto& a = object::allocator(dst);
 	object::clear_value(dst);
 	dst.properties = src.properties;
 	dst.source = src.source;
 	dst.sub_source = src.sub_source;
-	unmanaged_string::set(dst.name, src.name, a);
+	internal::copy_hashed(dst, dst.name, src, src.name);
 	switch (object::type(src)) {
 	case ObjectValueType::null:
 		break;
@@ -91,28 +191,34 @@ void object::copy(Object& dst, Object const& src, bool const children IGEN_DEFAU
 		break;
 	case ObjectValueType::integer:
 		dst.value.numeric.integer = src.value.numeric.integer;
-		unmanaged_string::set(dst.value.numeric.unit, src.value.numeric.unit, a);
+		internal::copy_hashed(dst, dst.value.numeric.unit, src, src.value.numeric.unit);
 		break;
 	case ObjectValueType::decimal:
 		dst.value.numeric.decimal = src.value.numeric.decimal;
-		unmanaged_string::set(dst.value.numeric.unit, src.value.numeric.unit, a);
+		internal::copy_hashed(dst, dst.value.numeric.unit, src, src.value.numeric.unit);
 		break;
 	case ObjectValueType::currency:
 		dst.value.numeric.c = src.value.numeric.c;
-		unmanaged_string::set(dst.value.numeric.unit, src.value.numeric.unit, a);
+		internal::copy_hashed(dst, dst.value.numeric.unit, src, src.value.numeric.unit);
 		break;
 	case ObjectValueType::time:
 		dst.value.time = src.value.time;
 		break;
 	case ObjectValueType::string:
 		unmanaged_string::set(dst.value.string.value, src.value.string.value, a);
-		unmanaged_string::set(dst.value.string.type, src.value.string.type, a);
+		internal::copy_hashed(dst, dst.value.string.type, src, src.value.string.type);
 		break;
 	case ObjectValueType::identifier:
-		unmanaged_string::set(dst.value.identifier, src.value.identifier, a);
+		internal::copy_hashed(dst, dst.value.identifier, src, src.value.identifier);
 		break;
 	case ObjectValueType::expression:
-		array::copy(dst.expression, src.expression);
+		if (object::has_operands(src)) {
+			auto& expression = object::extra(dst).expression;
+			array::reserve(expression, array::size(src.extra->expression));
+			for (auto const& operand : src.extra->expression) {
+				object::copy(object::push_back_sub(expression, dst), operand);
+			}
+		}
 		break;
 	}
 	object::copy_tags(dst, src);
@@ -122,14 +228,91 @@ void object::copy(Object& dst, Object const& src, bool const children IGEN_DEFAU
 	object::copy_quantity(dst, src);
 }
 
+/// Move an object.
+///
+/// Like object::copy(Object&, Object const&, bool), but takes the strings and
+/// collections of src instead of copying them, and leaves src null. If dst
+/// and src have different allocators or string interning, this copies.
+void object::copy(Object& dst, Object&& src) {
+	if (&dst == &src) {
+		return;
+	} else if (dst.allocator != src.allocator || dst.interned != src.interned) {
+		object::copy(dst, static_cast<Object const&>(src));
+		object::clear(src);
+		return;
+	}
+	auto const source_line = dst.source_line;
+	dst = rvalue_ref(src);
+	dst.source_line = source_line;
+}
+
+/// Copy an object, sharing its children.
+///
+/// Like object::copy(), but instead of copying the children of src, dst
+/// and src refer to the same children until either is changed. The shared
+/// children are copied for an object on the first non-const
+/// object::children() call on it, one level at a time, so copying a large
+/// tree is O(1) and changing part of it copies only the path down to the
+/// change.
+///
+/// Reads should use the const accessors, which never copy. The non-const
+/// object::find_child() only copies when it finds the child.
+///
+/// References to children of src taken before the call must not be used
+/// to change them, since the children are then shared. Objects with shared
+/// children must be used from a single thread.
+///
+/// If dst and src have different allocators or string interning, this is
+/// the same as object::copy().
+void object::copy_shared(Object& dst, Object& src) {
+	if (&dst == &src) {
+		return;
+	} else if (dst.allocator != src.allocator || dst.interned != src.interned) {
+		object::copy(dst, src);
+		return;
+	}
+	object::copy(dst, src, false);
+	object::clear_children(dst);
+	if (!object::has_children(src)) {
+		return;
+	}
+	auto& src_extra = object::extra(src);
+	if (!src_extra.shared_children) {
+		src_extra.shared_children = TOGO_CONSTRUCT(
+			object::allocator(src), Object::SharedChildren, object::allocator(src)
+		);
+		src_extra.shared_children->array = rvalue_ref(src.children);
+	}
+	++src_extra.shared_children->references;
+	object::extra(dst).shared_children = src_extra.shared_children;
+}
+
+IGEN_PRIVATE
+void object::unshare_children(Object& obj) {
+	auto const shared = obj.extra->shared_children;
+	if (shared->references == 1) {
+		obj.children = rvalue_ref(shared->array);
+	} else {
+		array::reserve(obj.children, array::size(shared->array));
+		for (auto& child : shared->array) {
+			object::copy_shared(object::push_back_sub(obj.children, obj), child);
+		}
+	}
+	internal::release_shared_children(obj);
+}
+
 /// Create quantity or clear existing quantity.
 Object& object::make_quantity(Object& obj) {
-	if (object::has_quantity(obj)) {
-		object::clear(*obj.quantity);
+	auto& extra = object::extra(obj);
+	if (extra.quantity) {
+		object::clear(*extra.quantity);
 	} else {
-		obj.quantity = TOGO_CONSTRUCT_DEFAULT(memory::default_allocator(), Object);
+		extra.quantity = new(object::pool_allocate(
+			object::allocator(obj), sizeof(Object), alignof(Object)
+		)) Object(object::allocator(obj));
+		extra.quantity->interned = obj.interned;
 	}
-	return *obj.quantity;
+	return *extra.quantity;
 }
 
 /// Set to null and clear all properties.
@@ -143,12 +326,123 @@ void object::clear(Object& obj) {
 	object::clear_quantity(obj);
 }
 
-/// Time value context.
+/// Visit an object tree.
 ///
-/// Relative date parts are taken from the context time.
-/// If the time value does not specify a zone offset, it is adjusted to the
-/// zone offset of the context (time assumed to be zone-local).
-Time object::time_resolved(Object const& obj, Time context) {
+/// obj is visited as kind, followed by its parts, tags, expression operands,
+/// children and quantity (see IObjectVisitor). Null values are not visited.
+/// Returns false if the visitor stopped.
+bool object::visit(
+	Object const& obj,
+	IObjectVisitor& visitor,
+	ObjectVisitKind const kind IGEN_DEFAULT(ObjectVisitKind::child)
+) {
+	if (!visitor.begin_object(kind, object::source_line(obj))) {
+		return false;
+	}
+	if (kind == ObjectVisitKind::operand && !visitor.op(object::op(obj))) {
+		return false;
+	}
+	if (object::is_named(obj) && !visitor.name(object::name(obj))) {
+		return false;
+	}
+	if (
+		(object::marker_value_uncertain(obj) && !visitor.marker(ObjectValueMarker::uncertain, 0)) ||
+		(object::marker_value_guess(obj) && !visitor.marker(ObjectValueMarker::guess, 0)) ||
+		(
+			object::value_approximation(obj) != 0 &&
+			!visitor.marker(ObjectValueMarker::approximate, object::value_approximation(obj))
+		)
+	) {
+		return false;
+	}
+	ObjectVisitValue value{};
+	value.type = object::type(obj);
+	switch (value.type) {
+	case ObjectValueType::null:
+	case ObjectValueType::expression:
+		break;
+
+	case ObjectValueType::boolean: value.boolean = object::boolean(obj); break;
+	case ObjectValueType::integer: value.integer = object::integer(obj); break;
+	case ObjectValueType::decimal: value.decimal = object::decimal(obj); break;
+
+	case ObjectValueType::time:
+		value.time.value = object::time_value(obj);
+		value.time.type = object::time_type(obj);
+		value.time.zoned = object::is_zoned(obj);
+		value.time.year_contextual = object::is_year_contextual(obj);
+		value.time.month_contextual = object::is_month_contextual(obj);
+		break;
+
+	case ObjectValueType::currency:
+		value.currency.value = object::currency(obj);
+		value.currency.exponent = object::currency_exponent(obj);
+		break;
+
+	case ObjectValueType::string:
+		value.string = object::string(obj);
+		value.string_type = object::string_type(obj);
+		break;
+
+	case ObjectValueType::identifier:
+		value.string = object::identifier(obj);
+		break;
+	}
+	if (
+		value.type != ObjectValueType::null &&
+		value.type != ObjectValueType::expression &&
+		!visitor.value(value)
+	) {
+		return false;
+	}
+	if (object::has_unit(obj) && !visitor.unit(object::unit(obj))) {
+		return false;
+	}
+	if (
+		(object::has_source(obj) || object::marker_source_uncertain(obj)) &&
+		!visitor.source(object::source(obj), !object::marker_source_uncertain(obj))
+	) {
+		return false;
+	}
+	if (
+		(object::has_sub_source(obj) || object::marker_sub_source_uncertain(obj)) &&
+		!visitor.sub_source(object::sub_source(obj), !object::marker_sub_source_uncertain(obj))
+	) {
+		return false;
+	}
+	for (auto const& tag : object::tags(obj)) {
+		if (!object::visit(tag, visitor, ObjectVisitKind::tag)) {
+			return false;
+		}
+	}
+	if (object::is_expression(obj)) {
+		if (!visitor.value(value)) {
+			return false;
+		}
+		for (auto const& operand : object::expression(obj)) {
+			if (!object::visit(operand, visitor, ObjectVisitKind::operand)) {
+				return false;
+			}
+		}
+	}
+	for (auto const& child : object::children(obj)) {
+		if (!object::visit(child, visitor, ObjectVisitKind::child)) {
+			return false;
+		}
+	}
+	if (object::has_quantity(obj)) {
+		if (!object::visit(*object::quantity(obj), visitor, ObjectVisitKind::quantity)) {
+			return false;
+		}
+	}
+	return visitor.end_object();
+}
+
+namespace object {
+namespace {
+
+template<class T>
+static Time time_resolved_impl(T const& obj, Time context) {
 	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::time));
 
 	Time value = obj.value.time;
@@ -179,6 +473,25 @@ Time object::time_resolved(Object const& obj, Time context) {
 	return value;
 }
 
+} // anonymous namespace
+} // namespace object
+
+/// Time value context.
+///
+/// Relative date parts are taken from the context time.
+/// If the time value does not specify a zone offset, it is adjusted to the
+/// zone offset of the context (time assumed to be zone-local).
+Time object::time_resolved(Object const& obj, Time context) {
+	return object::time_resolved_impl(obj, context);
+}
+
+/// Time value context of a frozen object.
+///
+/// See object::time_resolved(Object const&, Time).
+Time object::time_resolved(FrozenObject const& obj, Time context) {
+	return object::time_resolved_impl(obj, context);
+}
+
 /// Reduce date and timezone to minimal specificity within a context.
 void object::reduce_time(Object& obj, Time context) {
 	if (obj.value.time.zone_offset == context.zone_offset) {
@@ -209,80 +522,244 @@ void object::reduce_time(Object& obj, Time context) {
 	}
 }
 
+namespace object {
+namespace {
+
+enum : unsigned {
+	// Collections smaller than this are searched linearly
+	INDEX_THRESHOLD = 16,
+	INDEX_MIN_CAPACITY = 64,
+};
+
+inline u32* index_slots(Object::Index* index) {
+	return reinterpret_cast<u32*>(index + 1);
+}
+inline u32 const* index_slots(Object::Index const* index) {
+	return reinterpret_cast<u32 const*>(index + 1);
+}
+
+// Add objects from index->size to the end of collection to index
+static void index_extend(Object::Index* index, Array<Object> const& collection) {
+	u32 const mask = index->capacity - 1;
+	u32* const slots = index_slots(index);
+	for (u32 i = index->size; i < array::size(collection); ++i) {
+		ObjectNameHash const name_hash = collection[i].name.hash;
+		if (name_hash == OBJECT_NAME_NULL) {
+			continue;
+		}
+		// Keep the first object with the name
+		u32 slot = name_hash & mask;
+		for (; slots[slot] != 0; slot = (slot + 1) & mask) {
+			if (collection[slots[slot] - 1].name.hash == name_hash) {
+				goto l_next;
+			}
+		}
+		slots[slot] = i + 1;
+	l_next:
+		continue;
+	}
+	index->size = array::size(collection);
+}
+
+// Find name_hash in index
+inline Object const* index_find(
+	Object::Index const* const index,
+	Array<Object> const& collection,
+	ObjectNameHash const name_hash
+) {
+	u32 const mask = index->capacity - 1;
+	u32 const* const slots = index_slots(index);
+	for (u32 slot = name_hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+		if (collection[slots[slot] - 1].name.hash == name_hash) {
+			return &collection[slots[slot] - 1];
+		}
+	}
+	return nullptr;
+}
+
+// Update the lookup index of collection, building it if it is too small or
+// rebuild is true
+static Object::Index* index_update(
+	Object& obj,
+	Object::Index*& index,
+	Array<Object> const& collection,
+	bool const rebuild
+) {
+	u32 const size = array::size(collection);
+	if (!rebuild && index && index->size <= size && size * 2 <= index->capacity) {
+		if (index->size < size) {
+			object::index_extend(index, collection);
+		}
+		return index;
+	}
+	internal::release_index(obj, index);
+	u32 capacity = INDEX_MIN_CAPACITY;
+	while (capacity < size * 4) {
+		capacity *= 2;
+	}
+	index = static_cast<Object::Index*>(object::allocator(obj).allocate(
+		sizeof(Object::Index) + capacity * sizeof(u32), alignof(Object::Index)
+	));
+	index->size = 0;
+	index->capacity = capacity;
+	index->dirty = false;
+	std::memset(index_slots(index), 0, capacity * sizeof(u32));
+	object::index_extend(index, collection);
+	return index;
+}
+
+} // anonymous namespace
+} // namespace object
+
 IGEN_PRIVATE
 Object const* object::find_impl(
+	Object const& obj,
 	Array<Object> const& collection,
+	bool const tags,
 	StringRef const& name,
-	ObjectNameHash const name_hash
+	ObjectNameHash const name_hash,
+	Object* const mutable_obj
 ) {
 	if (name_hash == OBJECT_NAME_NULL || array::empty(collection)) {
 		return nullptr;
 	}
-	for (Object const& item : collection) {
-		if (name_hash == item.name.hash) {
-			#if defined(QUANTA_DEBUG)
-			if (name.valid() && !string::compare_equal(name, object::name(item))) {
-				TOGO_LOG_DEBUGF(
-					"hashes matched, but names mismatched: '%.*s' != '%.*s' (lookup_name != name)\n",
-					name.size, name.data,
-					item.name.size, item.name.data
-				);
+	Object const* item = nullptr;
+	if (array::size(collection) < INDEX_THRESHOLD) {
+		for (Object const& it : collection) {
+			if (name_hash == it.name.hash) {
+				item = &it;
+				break;
+			}
+		}
+	} else if (mutable_obj) {
+		auto& extra = object::extra(*mutable_obj);
+		auto& index = tags ? extra.tags_index : extra.children_index;
+		object::index_update(*mutable_obj, index, collection, false);
+		item = object::index_find(index, collection, name_hash);
+		if (!item && index->dirty) {
+			// Objects may have been renamed or moved since the index was
+			// built, so a miss is only final in a fresh index
+			object::index_update(*mutable_obj, index, collection, true);
+			item = object::index_find(index, collection, name_hash);
+		}
+		if (item) {
+			// The caller can rename the object through the result
+			index->dirty = true;
+		}
+	} else {
+		// Const lookups only read an index built by earlier lookups
+		Object::Index const* const index
+			= !obj.extra ? nullptr
+			: tags ? obj.extra->tags_index
+			: obj.extra->children_index
+		;
+		u32 scan_from = 0;
+		if (index && index->size <= array::size(collection)) {
+			item = object::index_find(index, collection, name_hash);
+			// Objects added after the index was built are not in it
+			scan_from = index->dirty ? 0 : index->size;
+		}
+		if (!item) {
+			for (auto it = begin(collection) + scan_from; it != end(collection); ++it) {
+				if (name_hash == it->name.hash) {
+					item = it;
+					break;
+				}
 			}
-			#else
-				(void)name;
-			#endif
-			return &item;
 		}
 	}
-	return nullptr;
+	#if defined(QUANTA_DEBUG)
+	if (item && name.valid() && !string::compare_equal(name, object::name(*item))) {
+		TOGO_LOG_DEBUGF(
+			"hashes matched, but names mismatched: '%.*s' != '%.*s' (lookup_name != name)\n",
+			name.size, name.data,
+			item->name.size, unmanaged_string::data(item->name)
+		);
+	}
+	#else
+		(void)name;
+	#endif
+	return item;
+}
+
+IGEN_PRIVATE
+Object* object::find_child_unshare(
+	Object& obj,
+	StringRef const& name,
+	ObjectNameHash const name_hash
+) {
+	auto const& children = object::children(static_cast<Object const&>(obj));
+	auto const item = object::find_impl(obj, children, false, name, name_hash, &obj);
+	if (!item || !object::has_shared_children(obj)) {
+		return const_cast<Object*>(item);
+	}
+	// Unsharing keeps the order of the children
+	auto const position = item - array::begin(children);
+	return &object::children(obj)[position];
 }
 
 /// Find tag by name.
+///
+/// Lookups in objects with many tags or children use an index built on the
+/// first non-const lookup (see object::clear_indexes()). Const lookups use
+/// the index if it exists, but never build or change it.
 Object* object::find_tag(Object& obj, StringRef const& name) {
 	ObjectNameHash const name_hash = object::hash_name(name);
-	return const_cast<Object*>(object::find_impl(obj.tags, name, name_hash));
+	auto const& tags = object::tags(static_cast<Object const&>(obj));
+	return const_cast<Object*>(
+		object::find_impl(obj, tags, true, name, name_hash, &obj)
+	);
 }
 
 /// Find tag by name.
 Object const* object::find_tag(Object const& obj, StringRef const& name) {
 	ObjectNameHash const name_hash = object::hash_name(name);
-	return object::find_impl(obj.tags, name, name_hash);
+	return object::find_impl(obj, object::tags(obj), true, name, name_hash, nullptr);
 }
 
 /// Find tag by name hash.
 Object* object::find_tag(Object& obj, ObjectNameHash const name_hash) {
+	auto const& tags = object::tags(static_cast<Object const&>(obj));
 	return const_cast<Object*>(
-		object::find_impl(obj.tags, StringRef{}, name_hash)
+		object::find_impl(obj, tags, true, StringRef{}, name_hash, &obj)
 	);
 }
 
 /// Find tag by name hash.
 Object const* object::find_tag(Object const& obj, ObjectNameHash const name_hash) {
-	return object::find_impl(obj.tags, StringRef{}, name_hash);
+	return object::find_impl(
+		obj, object::tags(obj), true, StringRef{}, name_hash, nullptr
+	);
 }
 
 /// Find child by name.
+///
+/// Lookups in objects with many tags or children use an index built on the
+/// first non-const lookup (see object::clear_indexes()). Const lookups use
+/// the index if it exists, but never build or change it.
+///
+/// If the children are shared, they are only copied if the child is found.
 Object* object::find_child(Object& obj, StringRef const& name) {
 	ObjectNameHash const name_hash = object::hash_name(name);
-	return const_cast<Object*>(object::find_impl(obj.children, name, name_hash));
+	return object::find_child_unshare(obj, name, name_hash);
 }
 
 /// Find child by name.
 Object const* object::find_child(Object const& obj, StringRef const& name) {
 	ObjectNameHash const name_hash = object::hash_name(name);
-	return object::find_impl(obj.children, name, name_hash);
+	return object::find_impl(obj, object::children(obj), false, name, name_hash, nullptr);
 }
 
 /// Find child by name hash.
 Object* object::find_child(Object& obj, ObjectNameHash const name_hash) {
-	return const_cast<Object*>(
-		object::find_impl(obj.children, StringRef{}, name_hash)
-	);
+	return object::find_child_unshare(obj, StringRef{}, name_hash);
 }
 
 /// Find child by name hash.
 Object const* object::find_child(Object const& obj, ObjectNameHash const name_hash) {
-	return object::find_impl(obj.children, StringRef{}, name_hash);
+	return object::find_impl(
+		obj, object::children(obj), false, StringRef{}, name_hash, nullptr
+	);
 }
 
 } // namespace quanta
@@ -9,8 +9,12 @@
 
 #pragma once
 
+// igen-source: object/document.cpp
+// igen-source: object/frozen.cpp
 // igen-source: object/io_text.cpp
+// igen-source: object/io_binary.cpp
 // igen-source: object/object_li.cpp
+// igen-source: object/frozen_li.cpp
 
 #include <quanta/core/config.hpp>
 #include <quanta/core/types.hpp>
@@ -28,6 +32,9 @@
 #include <togo/core/hash/hash.hpp>
 #include <togo/core/io/types.hpp>
 
+#include <new>
+#include <cstring>
+
 #include <quanta/core/object/object.gen_interface>
 
 namespace quanta {
@@ -48,6 +55,116 @@ inline ObjectValueHash hash_value(StringRef const& name) {
 	return hash::calc<ObjectValueHasher>(name);
 }
 
+/// Allocator for strings, collections and quantity.
+inline Allocator& allocator(Object const& obj) {
+	return *obj.allocator;
+}
+
+/// Whether names, units, identifiers and string types are interned.
+///
+/// If true, the allocator is an ObjectArena and these strings are shared
+/// through its string pool (see object::intern()).
+inline bool interned(Object const& obj) {
+	return obj.interned;
+}
+
+/// Whether two interned strings from the same arena are equal.
+///
+/// The pool stores each distinct string once, so this compares hashes,
+/// sizes and either inline bytes or pool pointers, never long contents.
+/// Names, units, identifiers and string types of interned objects are
+/// interned strings.
+template<class H>
+inline bool interned_equal(
+	HashedUnmanagedString<H> const& x,
+	HashedUnmanagedString<H> const& y
+) {
+	if (x.hash != y.hash || x.size != y.size) {
+		return false;
+	}
+	char const* const x_data = unmanaged_string::data(x);
+	char const* const y_data = unmanaged_string::data(y);
+	return unmanaged_string::is_inline(x)
+		? std::memcmp(x_data, y_data, x.size) == 0
+		: x_data == y_data
+	;
+}
+
+/// Add a null object to a collection of obj (expression, tags or children).
+///
+/// The new object has the same allocator and string interning as obj.
+/// The collection grows in smaller steps than with array::push_back(),
+/// since most objects have only a few operands, tags or children.
+inline Object& push_back_sub(Array<Object>& collection, Object const& obj) {
+	if (array::size(collection) == array::capacity(collection)) {
+		array::set_capacity(collection, array::capacity(collection) * 2 + 1);
+	}
+	auto& sub = array::push_back_inplace(collection, object::allocator(obj));
+	sub.interned = obj.interned;
+	return sub;
+}
+
+/// Extra storage (expression operands, tags and quantity).
+///
+/// Created if it does not exist.
+inline Object::Extra& extra(Object& obj) {
+	if (!obj.extra) {
+		obj.extra = new(object::pool_allocate(
+			object::allocator(obj), sizeof(Object::Extra), alignof(Object::Extra)
+		)) Object::Extra(object::allocator(obj));
+	}
+	return *obj.extra;
+}
+
+namespace internal {
+
+// Stands in for the collections of objects without extra storage
+inline Array<Object> const& empty_collection() {
+	static Array<Object> const s_empty{memory::default_allocator()};
+	return s_empty;
+}
+
+// Set a name, unit, identifier or string type of obj
+template<class H>
+inline void set_hashed(
+	Object& obj, HashedUnmanagedString<H>& s,
+	StringRef const value, typename H::Value const hash
+) {
+	if (obj.interned) {
+		unmanaged_string::set_shared(s, object::intern(
+			static_cast<ObjectArena&>(object::allocator(obj)), value, hash
+		), hash);
+	} else {
+		unmanaged_string::set(static_cast<UnmanagedString&>(s), value, object::allocator(obj));
+		s.hash = hash;
+	}
+}
+
+template<class H>
+inline void set_hashed(Object& obj, HashedUnmanagedString<H>& s, StringRef const value) {
+	internal::set_hashed(obj, s, value, hash::calc<H>(value));
+}
+
+// Copy a name, unit, identifier or string type of src to dst
+template<class H>
+inline void copy_hashed(
+	Object& dst, HashedUnmanagedString<H>& s,
+	Object const& src, HashedUnmanagedString<H> const& value
+) {
+	if (!dst.interned) {
+		unmanaged_string::set(s, value, object::allocator(dst));
+	} else if (src.interned && src.allocator == dst.allocator) {
+		// Already in the pool
+		s = value;
+	} else {
+		unmanaged_string::set_shared(s, object::intern(
+			static_cast<ObjectArena&>(object::allocator(dst)), value, value.hash
+		), value.hash);
+	}
+}
+
+} // namespace internal
+
 /// Value type.
 inline ObjectValueType type(Object const& obj) {
 	return static_cast<ObjectValueType>(internal::get_property(obj, M_TYPE, 0));
@@ -127,12 +244,12 @@ inline bool is_named(Object const& obj) {
 
 /// Set name.
 inline void set_name(Object& obj, StringRef name) {
-	unmanaged_string::set(obj.name, name, memory::default_allocator());
+	internal::set_hashed(obj, obj.name, name);
 }
 
 /// Clear name.
 inline void clear_name(Object& obj) {
-	unmanaged_string::clear(obj.name, memory::default_allocator());
+	unmanaged_string::clear(obj.name, object::allocator(obj));
 }
 
 /// Operator.
@@ -356,7 +473,7 @@ inline bool has_unit(Object const& obj) {
 /// Type must be numeric or currency.
 inline void set_unit(Object& obj, StringRef const unit) {
 	TOGO_ASSERTE(object::is_type_any(obj, type_mask_unit_carrier));
-	unmanaged_string::set(obj.value.numeric.unit, unit, memory::default_allocator());
+	internal::set_hashed(obj, obj.value.numeric.unit, unit);
 }
 
 /// Set integer value and unit.
@@ -561,7 +678,18 @@ inline StringRef string(Object const& obj) {
 /// Set string value.
 inline void set_string(Object& obj, StringRef const value) {
 	object::set_type(obj, ObjectValueType::string);
-	unmanaged_string::set(obj.value.string.value, value, memory::default_allocator());
+	unmanaged_string::set(obj.value.string.value, value, object::allocator(obj));
+}
+
+/// Set string value without taking a copy of it.
+///
+/// obj must be interned (see object::interned()), since its arena never
+/// frees the value. A long value is referred to in place, so it must
+/// outlive the arena's current contents (see unmanaged_string::set_shared()).
+inline void set_string_shared(Object& obj, StringRef const value) {
+	TOGO_ASSERTE(object::interned(obj));
+	object::set_type(obj, ObjectValueType::string);
+	unmanaged_string::set_shared(obj.value.string.value, value);
 }
 
 /// String type.
@@ -584,7 +712,7 @@ inline bool has_string_type(Object const& obj) {
 /// Set string type.
 inline void set_string_type(Object& obj, StringRef const type) {
 	object::set_type(obj, ObjectValueType::string);
-	unmanaged_string::set(obj.value.string.type, type, memory::default_allocator());
+	internal::set_hashed(obj, obj.value.string.type, type);
 }
 
 /// Identifier value.
@@ -602,7 +730,7 @@ inline ObjectValueHash identifier_hash(Object const& obj) {
 /// Set identifier value.
 inline void set_identifier(Object& obj, StringRef const value) {
 	object::set_type(obj, ObjectValueType::identifier);
-	unmanaged_string::set(obj.value.identifier, value, memory::default_allocator());
+	internal::set_hashed(obj, obj.value.identifier, value);
 }
 
 /// String or identifier value.
@@ -617,118 +745,252 @@ inline void set_expression(Object& obj) {
 }
 
 /// Expression value.
+///
+/// The non-const overload creates extra storage.
 inline Array<Object>& expression(Object& obj) {
 	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::expression));
-	return obj.expression;
+	return object::extra(obj).expression;
 }
 inline Array<Object> const& expression(Object const& obj) {
 	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::expression));
-	return obj.expression;
+	return obj.extra ? obj.extra->expression : internal::empty_collection();
 }
 
 /// Whether the object has any operands (is an expression).
 inline bool has_operands(Object const& obj) {
-	return array::any(obj.expression);
+	return obj.extra && array::any(obj.extra->expression);
 }
 
 /// Clear expression.
 inline void clear_expression(Object& obj) {
 	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::expression));
-	array::clear(obj.expression);
+	if (obj.extra) {
+		array::clear(obj.extra->expression);
+	}
+}
+
+/// Whether the object shares its children with other objects.
+///
+/// See object::copy_shared().
+inline bool has_shared_children(Object const& obj) {
+	return obj.extra && obj.extra->shared_children;
 }
 
 /// Children.
-inline Array<Object>& children(Object& obj) { return obj.children; }
-inline Array<Object> const& children(Object const& obj) { return obj.children; }
+///
+/// If the children are shared, the non-const overload first gives obj its
+/// own copy of them. It also marks the lookup index out of date (see
+/// object::clear_indexes()). Use the const overload to read them.
+inline Array<Object>& children(Object& obj) {
+	if (object::has_shared_children(obj)) {
+		object::unshare_children(obj);
+	}
+	if (obj.extra && obj.extra->children_index) {
+		obj.extra->children_index->dirty = true;
+	}
+	return obj.children;
+}
+inline Array<Object> const& children(Object const& obj) {
+	return object::has_shared_children(obj)
+		? obj.extra->shared_children->array
+		: obj.children
+	;
+}
 
 /// Whether the object has children.
 inline bool has_children(Object const& obj) {
-	return array::any(obj.children);
+	return array::any(object::children(obj));
+}
+
+namespace internal {
+
+// Release a lookup index of obj
+inline void release_index(Object& obj, Object::Index*& index) {
+	if (index) {
+		object::allocator(obj).deallocate(index);
+		index = nullptr;
+	}
+}
+
+// Drop the reference of obj to shared children
+inline void release_shared_children(Object& obj) {
+	auto const shared = obj.extra->shared_children;
+	obj.extra->shared_children = nullptr;
+	if (shared && --shared->references == 0) {
+		TOGO_DESTROY(object::allocator(obj), shared);
+	}
+}
+
+} // namespace internal
+
+/// Release the child and tag lookup indexes.
+///
+/// The non-const object::find_child() and object::find_tag() build an
+/// index for collections with many objects. The index follows objects being
+/// added to the end of a collection. Handing out a non-const collection
+/// (object::children(), object::tags()) or a non-const lookup result marks
+/// the index out of date, and the next lookup that misses it rebuilds it;
+/// otherwise a miss is final. Objects renamed or moved in place through
+/// references kept across lookups are only found again after calling this,
+/// which also frees the indexes.
+inline void clear_indexes(Object& obj) {
+	if (obj.extra) {
+		internal::release_index(obj, obj.extra->children_index);
+		internal::release_index(obj, obj.extra->tags_index);
+	}
 }
 
 /// Clear children.
 inline void clear_children(Object& obj) {
 	array::clear(obj.children);
+	if (obj.extra) {
+		internal::release_index(obj, obj.extra->children_index);
+		internal::release_shared_children(obj);
+	}
 }
 
 /// Copy children.
 inline void copy_children(Object& dst, Object const& src) {
-	array::copy(dst.children, src.children);
+	object::clear_children(dst);
+	auto const& src_children = object::children(src);
+	array::reserve(dst.children, array::size(src_children));
+	for (auto const& child : src_children) {
+		object::copy(object::push_back_sub(dst.children, dst), child);
+	}
 }
 
 /// Tags.
-inline Array<Object>& tags(Object& obj) { return obj.tags; }
-inline Array<Object> const& tags(Object const& obj) { return obj.tags; }
+///
+/// The non-const overload creates extra storage and marks the lookup index
+/// out of date (see object::clear_indexes()).
+inline Array<Object>& tags(Object& obj) {
+	auto& extra = object::extra(obj);
+	if (extra.tags_index) {
+		extra.tags_index->dirty = true;
+	}
+	return extra.tags;
+}
+inline Array<Object> const& tags(Object const& obj) {
+	return obj.extra ? obj.extra->tags : internal::empty_collection();
+}
 
 /// Whether the object has tags.
 inline bool has_tags(Object const& obj) {
-	return array::any(obj.tags);
+	return obj.extra && array::any(obj.extra->tags);
 }
 
 /// Clear tags.
 inline void clear_tags(Object& obj) {
-	array::clear(obj.tags);
+	if (obj.extra) {
+		array::clear(obj.extra->tags);
+		internal::release_index(obj, obj.extra->tags_index);
+	}
 }
 
 /// Copy tags.
 inline void copy_tags(Object& dst, Object const& src) {
-	array::copy(dst.tags, src.tags);
+	object::clear_tags(dst);
+	if (!object::has_tags(src)) {
+		return;
+	}
+	auto& tags = object::extra(dst).tags;
+	array::reserve(tags, array::size(src.extra->tags));
+	for (auto const& tag : src.extra->tags) {
+		object::copy(object::push_back_sub(tags, dst), tag);
+	}
 }
 
 /// Quantity.
-inline Object* quantity(Object& obj) { return obj.quantity; }
-inline Object const* quantity(Object const& obj) { return obj.quantity; }
+inline Object* quantity(Object& obj) { return obj.extra ? obj.extra->quantity : nullptr; }
+inline Object const* quantity(Object const& obj) { return obj.extra ? obj.extra->quantity : nullptr; }
 
 /// Whether the object has a quantity.
 inline bool has_quantity(Object const& obj) {
-	return obj.quantity;
+	return obj.extra && obj.extra->quantity;
 }
 
 /// Clear quantity.
 inline void clear_quantity(Object& obj) {
 	if (object::has_quantity(obj)) {
-		object::clear(*obj.quantity);
+		object::clear(*obj.extra->quantity);
 	}
 }
 
 /// Release quantity.
 inline void release_quantity(Object& obj) {
-	TOGO_DESTROY(memory::default_allocator(), obj.quantity);
-	obj.quantity = nullptr;
+	if (obj.extra && obj.extra->quantity) {
+		obj.extra->quantity->~Object();
+		object::pool_deallocate(object::allocator(obj), obj.extra->quantity, sizeof(Object));
+		obj.extra->quantity = nullptr;
+	}
 }
 
 /// Copy quantity.
 inline void copy_quantity(Object& dst, Object const& src) {
 	if (object::has_quantity(src)) {
-		if (object::has_quantity(dst)) {
-			object::copy(*dst.quantity, *src.quantity);
-		} else {
-			dst.quantity = TOGO_CONSTRUCT(memory::default_allocator(), Object, *src.quantity);
-		}
+		auto& quantity = object::has_quantity(dst)
+			? *dst.extra->quantity
+			: object::make_quantity(dst)
+		;
+		object::copy(quantity, *src.extra->quantity);
 	} else {
 		object::release_quantity(dst);
 	}
 }
 
+/// Release extra storage (expression operands, tags, quantity, lookup
+/// indexes and shared children).
+inline void release_extra(Object& obj) {
+	if (obj.extra) {
+		object::release_quantity(obj);
+		object::clear_indexes(obj);
+		internal::release_shared_children(obj);
+		obj.extra->~Extra();
+		object::pool_deallocate(object::allocator(obj), obj.extra, sizeof(Object::Extra));
+		obj.extra = nullptr;
+	}
+}
+
+/// Construct empty.
+inline Object::Extra::Extra(Allocator& allocator)
+	: expression(allocator)
+	, tags(allocator)
+	, quantity(nullptr)
+	, children_index(nullptr)
+	, tags_index(nullptr)
+	, shared_children(nullptr)
+{}
+
+/// Construct empty.
+inline Object::SharedChildren::SharedChildren(Allocator& allocator)
+	: references(1)
+	, array(allocator)
+{}
+
 /// Destruct.
 inline Object::~Object() {
 	object::clear_name(*this);
 	object::set_null(*this);
-	object::release_quantity(*this);
+	object::release_extra(*this);
 }
 
-/// Construct null.
-inline Object::Object()
+/// Construct null with allocator.
+inline Object::Object(Allocator& allocator)
 	: properties(unsigned_cast(ObjectValueType::null))
 	, source_line(0)
 	, source(0)
 	, sub_source(0)
+	, interned(false)
 	, name()
 	, value()
-	, expression(memory::default_allocator())
-	, tags(memory::default_allocator())
-	, children(memory::default_allocator())
-	, quantity(nullptr)
+	, children(allocator)
+	, extra(nullptr)
+	, allocator(&allocator)
+{}
+
+/// Construct null.
+inline Object::Object()
+	: Object(memory::default_allocator())
 {}
 
 /// Construct copy.
@@ -738,54 +1000,52 @@ inline Object::Object(Object const& other)
 	object::copy(*this, other);
 }
 
+namespace internal {
+
+// Take the state of src, leaving it null
+inline void move_from(Object& dst, Object& src) {
+	dst.properties = src.properties;
+	dst.source_line = src.source_line;
+	dst.source = src.source;
+	dst.sub_source = src.sub_source;
+	dst.interned = src.interned;
+	dst.name = src.name;
+	dst.value = src.value;
+	dst.extra = src.extra;
+	dst.allocator = src.allocator;
+	src.properties = unsigned_cast(ObjectValueType::null);
+	src.source_line = 0;
+	src.source = 0;
+	src.sub_source = 0;
+	src.name = {};
+	src.value = {};
+	src.extra = nullptr;
+}
+
+} // namespace internal
+
 /// Move-construct.
-inline Object::Object(Object&& other)
-	: properties(other.properties)
-	, source(other.source)
-	, sub_source(other.sub_source)
-	, name(other.name)
-	, value(other.value)
-	, expression(rvalue_ref(other.expression))
-	, tags(rvalue_ref(other.tags))
-	, children(rvalue_ref(other.children))
-	, quantity(other.quantity)
+inline Object::Object(Object&& other) noexcept
+	: children(rvalue_ref(other.children))
 {
-	switch (object::type(other)) {
-	case ObjectValueType::null:
-		break;
-	case ObjectValueType::boolean:
-		other.value.boolean = false;
-		break;
-	case ObjectValueType::integer:
-		other.value.numeric.integer = 0;
-		other.value.numeric.unit = {};
-		break;
-	case ObjectValueType::decimal:
-		other.value.numeric.decimal = 0.0f;
-		other.value.numeric.unit = {};
-		break;
-	case ObjectValueType::currency:
-		other.value.numeric.c = {};
-		other.value.numeric.unit = {};
-		break;
-	case ObjectValueType::time:
-		other.value.time = {};
-		break;
-	case ObjectValueType::string:
-		other.value.string.value = {};
-		other.value.string.type = {};
-		break;
-	case ObjectValueType::identifier:
-		other.value.identifier = {};
-		break;
-	case ObjectValueType::expression:
-		break;
+	internal::move_from(*this, other);
+}
+
+/// Move-assign.
+///
+/// Takes the strings, collections and allocator of other, which is left
+/// null. Nothing is copied.
+inline Object& Object::operator=(Object&& other) noexcept {
+	if (this != &other) {
+		// other may be owned by this
+		Object taken{rvalue_ref(other)};
+		object::clear_name(*this);
+		object::set_null(*this);
+		object::release_extra(*this);
+		children = rvalue_ref(taken.children);
+		internal::move_from(*this, taken);
 	}
-	other.properties = unsigned_cast(ObjectValueType::null);
-	other.source = 0;
-	other.sub_source = 0;
-	other.name = {};
-	other.quantity = nullptr;
+	return *this;
 }
 
 inline Object& Object::operator=(Object const& other) {
@@ -793,6 +1053,388 @@ inline Object& Object::operator=(Object const& other) {
 	return *this;
 }
 
+namespace internal {
+
+// String of a frozen object
+inline StringRef frozen_string(FrozenObject const& obj, FrozenObject::String const s) {
+	return StringRef{reinterpret_cast<char const*>(&obj) + s.offset, s.size};
+}
+
+// Block of sub-objects of a frozen object
+inline FrozenObject const* frozen_subs(FrozenObject const& obj) {
+	return reinterpret_cast<FrozenObject const*>(
+		reinterpret_cast<u8 const*>(&obj) + obj.subs
+	);
+}
+
+} // namespace internal
+
+/// Root of a frozen document.
+///
+/// If the document is empty, this is a null object.
+inline FrozenObject const& root(FrozenObjectDocument const& doc) {
+	static FrozenObject const s_null{
+		unsigned_cast(ObjectValueType::null),
+		0, 0, 0, OBJECT_NAME_NULL, {0, 0}, {0, 0}, OBJECT_VALUE_NULL,
+		0, 0, 0, 0, false, {false}
+	};
+	return doc._data ? *doc._data : s_null;
+}
+
+/// Number of objects in a frozen document.
+inline unsigned num_objects(FrozenObjectDocument const& doc) {
+	return doc._num_objects;
+}
+
+/// Size of a frozen document in bytes.
+inline unsigned size(FrozenObjectDocument const& doc) {
+	return doc._size;
+}
+
+/// Value type.
+inline ObjectValueType type(FrozenObject const& obj) {
+	return static_cast<ObjectValueType>(internal::get_property(obj, M_TYPE, 0));
+}
+
+/// Whether type is type.
+inline bool is_type(FrozenObject const& obj, ObjectValueType const type) {
+	return object::type(obj) == type;
+}
+
+/// Whether type is any in type.
+inline bool is_type_any(FrozenObject const& obj, ObjectValueType const type) {
+	return enum_bool(object::type(obj) & type);
+}
+
+/// Whether type is ObjectValueType::null.
+inline bool is_null(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::null); }
+
+/// Whether type is ObjectValueType::boolean.
+inline bool is_boolean(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::boolean); }
+
+/// Whether type is ObjectValueType::integer.
+inline bool is_integer(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::integer); }
+
+/// Whether type is ObjectValueType::decimal.
+inline bool is_decimal(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::decimal); }
+
+/// Whether type is ObjectValueType::integer or ObjectValueType::decimal.
+inline bool is_numeric(FrozenObject const& obj) {
+	return object::is_type_any(obj, type_mask_numeric);
+}
+
+/// Whether type is ObjectValueType::currency.
+inline bool is_currency(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::currency); }
+
+/// Whether type is ObjectValueType::time.
+inline bool is_time(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::time); }
+
+/// Whether type is ObjectValueType::string.
+inline bool is_string(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::string); }
+
+/// Whether type is ObjectValueType::identifier.
+inline bool is_identifier(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::identifier); }
+
+/// Whether type is ObjectValueType::string or ObjectValueType::identifier.
+inline bool is_textual(FrozenObject const& obj) { return object::is_type_any(obj, type_mask_textual); }
+
+/// Whether type is ObjectValueType::expression.
+inline bool is_expression(FrozenObject const& obj) { return object::is_type(obj, ObjectValueType::expression); }
+
+/// Line in source file.
+inline unsigned source_line(FrozenObject const& obj) {
+	return obj.source_line;
+}
+
+/// Name.
+inline StringRef name(FrozenObject const& obj) {
+	return internal::frozen_string(obj, obj.name);
+}
+
+/// Name hash.
+inline ObjectNameHash name_hash(FrozenObject const& obj) {
+	return obj.name_hash;
+}
+
+/// Whether name is non-empty.
+inline bool is_named(FrozenObject const& obj) {
+	return obj.name.size > 0;
+}
+
+/// Operator.
+inline ObjectOperator op(FrozenObject const& obj) {
+	return static_cast<ObjectOperator>(internal::get_property(obj, M_OP, S_OP));
+}
+
+/// Source.
+inline unsigned source(FrozenObject const& obj) {
+	return obj.source;
+}
+
+/// Whether source uncertainty marker is set.
+inline bool marker_source_uncertain(FrozenObject const& obj) {
+	return internal::get_property(obj, M_SOURCE_UNCERTAIN, 0);
+}
+
+/// Sub-source.
+inline unsigned sub_source(FrozenObject const& obj) {
+	return obj.sub_source;
+}
+
+/// Whether sub-source uncertainty marker is set.
+inline bool marker_sub_source_uncertain(FrozenObject const& obj) {
+	return internal::get_property(obj, M_SUB_SOURCE_UNCERTAIN, 0);
+}
+
+/// Whether a source is specified.
+inline bool has_source(FrozenObject const& obj) {
+	return obj.source != 0;
+}
+
+/// Whether a sub-source is specified.
+inline bool has_sub_source(FrozenObject const& obj) {
+	return obj.sub_source != 0;
+}
+
+/// Whether the source and sub-source are certain.
+inline bool source_certain(FrozenObject const& obj) {
+	return object::has_source(obj) && !(obj.properties & M_BOTH_SOURCE_UNCERTAIN);
+}
+
+/// Whether the source and sub-source are certain or unspecified.
+inline bool source_certain_or_unspecified(FrozenObject const& obj) {
+	return obj.source == 0 || !(obj.properties & M_BOTH_SOURCE_UNCERTAIN);
+}
+
+/// Whether the value uncertain marker is set.
+inline bool marker_value_uncertain(FrozenObject const& obj) {
+	return internal::get_property(obj, M_VALUE_UNCERTAIN, 0);
+}
+
+/// Whether the value guess marker is set.
+inline bool marker_value_guess(FrozenObject const& obj) {
+	return internal::get_property(obj, M_VALUE_GUESS, 0);
+}
+
+/// Value approximation marker value.
+inline signed value_approximation(FrozenObject const& obj) {
+	unsigned const value = internal::get_property(obj, M_VALUE_APPROXIMATE, S_VALUE_APPROXIMATE);
+	return (value & (1 << 2)) ? -(signed_cast(value) & 3) : signed_cast(value);
+}
+
+/// Whether value is certain.
+inline bool value_certain(FrozenObject const& obj) {
+	return !(obj.properties & M_VALUE_MARKERS);
+}
+
+/// Boolean value.
+inline bool boolean(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::boolean));
+	return obj.value.boolean;
+}
+
+/// Integer value.
+inline s64 integer(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::integer));
+	return obj.value.integer;
+}
+
+/// Decimal value.
+inline f64 decimal(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::decimal));
+	return obj.value.decimal;
+}
+
+/// Numeric/currency unit.
+inline StringRef unit(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type_any(obj, type_mask_unit_carrier));
+	return internal::frozen_string(obj, obj.value_name);
+}
+
+/// Numeric/currency unit hash.
+inline ObjectValueHash unit_hash(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type_any(obj, type_mask_unit_carrier));
+	return obj.value_hash;
+}
+
+/// Whether the numeric/currency value has a unit.
+inline bool has_unit(FrozenObject const& obj) {
+	return object::is_type_any(obj, type_mask_unit_carrier) && obj.value_name.size > 0;
+}
+
+/// Currency value.
+inline s64 currency(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::currency));
+	return obj.value.currency.value;
+}
+
+/// Currency exponent.
+inline s32 currency_exponent(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::currency));
+	return obj.value.currency.exponent;
+}
+
+/// Time value.
+inline Time const& time_value(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::time));
+	return obj.value.time;
+}
+
+/// Time type.
+inline ObjectTimeType time_type(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::time));
+	return static_cast<ObjectTimeType>(internal::get_property(obj, M_TM_TYPE, S_TM_TYPE));
+}
+
+/// Whether the time value specifies a date (by time type).
+inline bool has_date(FrozenObject const& obj) {
+	return object::time_type(obj) != ObjectTimeType::clock;
+}
+
+/// Whether the time value specifies a clock (by time type).
+inline bool has_clock(FrozenObject const& obj) {
+	return object::time_type(obj) != ObjectTimeType::date;
+}
+
+/// Whether the time value specifies a zone offset (UTC or relative to UTC).
+inline bool is_zoned(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::time));
+	return obj.value.time.zone_offset != 0 || !internal::get_property(obj, M_TM_UNZONED, 0);
+}
+
+/// Whether the time value is context-relative to year.
+inline bool is_year_contextual(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::time));
+	return
+		object::has_date(obj) &&
+		internal::get_property(obj, M_TM_CONTEXTUAL_YEAR | M_TM_CONTEXTUAL_MONTH, 0)
+	;
+}
+
+/// Whether the time value is context-relative to month.
+inline bool is_month_contextual(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::time));
+	return
+		object::has_date(obj) &&
+		internal::get_property(obj, M_TM_CONTEXTUAL_MONTH, 0)
+	;
+}
+
+/// Whether the time value is context-relative to year or month.
+inline bool is_date_contextual(FrozenObject const& obj) {
+	return object::is_year_contextual(obj);
+}
+
+/// String value.
+inline StringRef string(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::string));
+	return internal::frozen_string(obj, obj.value.string);
+}
+
+/// String type.
+inline StringRef string_type(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::string));
+	return internal::frozen_string(obj, obj.value_name);
+}
+
+/// String type hash.
+inline ObjectValueHash string_type_hash(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::string));
+	return obj.value_hash;
+}
+
+/// Whether the string value is typed.
+inline bool has_string_type(FrozenObject const& obj) {
+	return object::is_type(obj, ObjectValueType::string) && obj.value_name.size > 0;
+}
+
+/// Identifier value.
+inline StringRef identifier(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::identifier));
+	return internal::frozen_string(obj, obj.value_name);
+}
+
+/// Identifier value hash.
+inline ObjectValueHash identifier_hash(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::identifier));
+	return obj.value_hash;
+}
+
+/// String or identifier value.
+inline StringRef text(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type_any(obj, type_mask_textual));
+	return internal::frozen_string(
+		obj, object::is_type(obj, ObjectValueType::string) ? obj.value.string : obj.value_name
+	);
+}
+
+/// Expression value.
+inline ArrayRef<FrozenObject const> expression(FrozenObject const& obj) {
+	TOGO_ASSERTE(object::is_type(obj, ObjectValueType::expression));
+	auto const subs = internal::frozen_subs(obj);
+	return {subs, subs + obj.num_operands};
+}
+
+/// Whether the object has any operands (is an expression).
+inline bool has_operands(FrozenObject const& obj) {
+	return obj.num_operands > 0;
+}
+
+/// Tags.
+inline ArrayRef<FrozenObject const> tags(FrozenObject const& obj) {
+	auto const subs = internal::frozen_subs(obj) + obj.num_operands;
+	return {subs, subs + obj.num_tags};
+}
+
+/// Whether the object has tags.
+inline bool has_tags(FrozenObject const& obj) {
+	return obj.num_tags > 0;
+}
+
+/// Children.
+inline ArrayRef<FrozenObject const> children(FrozenObject const& obj) {
+	auto const subs = internal::frozen_subs(obj) + obj.num_operands + obj.num_tags;
+	return {subs, subs + obj.num_children};
+}
+
+/// Whether the object has children.
+inline bool has_children(FrozenObject const& obj) {
+	return obj.num_children > 0;
+}
+
+/// Quantity.
+inline FrozenObject const* quantity(FrozenObject const& obj) {
+	return obj.has_quantity
+		? internal::frozen_subs(obj) + obj.num_operands + obj.num_tags + obj.num_children
+		: nullptr
+	;
+}
+
+/// Whether the object has a quantity.
+inline bool has_quantity(FrozenObject const& obj) {
+	return obj.has_quantity;
+}
+
+/// Construct empty with allocator.
+inline FrozenObjectDocument::FrozenObjectDocument(Allocator& allocator)
+	: _allocator(&allocator)
+	, _data(nullptr)
+	, _num_objects(0)
+	, _size(0)
+	, _mapping(nullptr)
+	, _mapping_size(0)
+{}
+
+/// Construct empty with the default allocator.
+inline FrozenObjectDocument::FrozenObjectDocument()
+	: FrozenObjectDocument(memory::default_allocator())
+{}
+
+/// Destruct.
+inline FrozenObjectDocument::~FrozenObjectDocument() {
+	object::clear(*this);
+}
+
 /** @} */ // end of doc-group lib_core_object
 
 } // namespace object
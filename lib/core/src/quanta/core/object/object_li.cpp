@@ -26,8 +26,15 @@ TOGO_LI_FUNC_DEF(__mm_destroy) {
 	return 0;
 }
 
+static signed li_text_layout_destroy(lua_State* L) {
+	auto layout = lua::get_userdata<ObjectTextLayout>(L, 1);
+	layout->~ObjectTextLayout();
+	return 0;
+}
+
 TOGO_LI_FUNC_DEF(__module_init__) {
 	lua::register_userdata<Object>(L, li___mm_destroy);
+	lua::register_userdata<ObjectTextLayout>(L, li_text_layout_destroy);
 
 	lua::table_set_raw(L, "NAME_NULL", unsigned_cast(OBJECT_NAME_NULL));
 	lua::table_set_raw(L, "VALUE_NULL", unsigned_cast(OBJECT_VALUE_NULL));
@@ -45,6 +52,12 @@ TOGO_LI_FUNC_DEF(__module_init__) {
 	lua::table_set_raw(L, "expression", unsigned_cast(ObjectValueType::expression));
 	lua_pop(L, 1);
 
+	lua_createtable(L, 0, 2);
+	lua::table_set_copy_raw(L, -4, "TextFormat", -1);
+	lua::table_set_raw(L, "readable", unsigned_cast(ObjectTextFormat::readable));
+	lua::table_set_raw(L, "compact", unsigned_cast(ObjectTextFormat::compact));
+	lua_pop(L, 1);
+
 	lua_createtable(L, 0, 5);
 	lua::table_set_copy_raw(L, -4, "Operator", -1);
 	lua::table_set_raw(L, "none", unsigned_cast(ObjectOperator::none));
@@ -389,6 +402,13 @@ TOGO_LI_FUNC_DEF(copy) {
 	return 0;
 }
 
+TOGO_LI_FUNC_DEF(copy_shared) {
+	auto dst = lua::get_pointer<Object>(L, 1);
+	auto src = lua::get_pointer<Object>(L, 2);
+	object::copy_shared(*dst, *src);
+	return 0;
+}
+
 TOGO_LI_FUNC_DEF(set_null) {
 	auto obj = lua::get_pointer<Object>(L, 1);
 	object::set_null(*obj);
@@ -682,7 +702,7 @@ TOGO_LI_FUNC_DEF(array_iter) {
 static signed TOGO_LI_FUNC(push_sub)(lua_State* L, Object* obj, Array<Object>& a, bool sv_default) {
 	Object* sub = nullptr;
 	if (lua_isnone(L, 2)) {
-		sub = &array::push_back_inplace(a);
+		sub = &object::push_back_sub(a, *obj);
 	} else if (lua_isstring(L, 2)) {
 		auto text = lua::get_string(L, 2);
 		bool single_value = luaL_opt(L, lua::get_boolean, 3, sv_default);
@@ -700,7 +720,8 @@ static signed TOGO_LI_FUNC(push_sub)(lua_State* L, Object* obj, Array<Object>& a
 	return 1;
 }
 
-static signed TOGO_LI_FUNC(remove_sub)(lua_State* L, Object* /*obj*/, Array<Object>& a) {
+static signed TOGO_LI_FUNC(remove_sub)(lua_State* L, Object* obj, Array<Object>& a) {
+	object::clear_indexes(*obj);
 	if (lua_isuserdata(L, 2)) {
 		auto ptr = lua::get_pointer<Object>(L, 2);
 		array::remove(a, ptr);
@@ -712,24 +733,41 @@ static signed TOGO_LI_FUNC(remove_sub)(lua_State* L, Object* /*obj*/, Array<Obje
 	return 0;
 }
 
-static signed TOGO_LI_FUNC(sub_at)(lua_State* L, Object* /*obj*/, Array<Object>& a) {
+static signed TOGO_LI_FUNC(sub_at)(lua_State* L, Object* /*obj*/, Array<Object> const& a) {
 	auto i = luaL_checkinteger(L, 2);
 	luaL_argcheck(L, i >= 1 && i <= signed_cast(array::size(a)), 2, "index out of bounds");
-	lua::push_lightuserdata(L, &a[i - 1]);
+	lua::push_lightuserdata(L, const_cast<Object*>(&a[i - 1]));
 	return 1;
 }
 
+// Read paths use the const collections, which do not create extra storage
+// or copy shared children. Lua has no const, so bindings that hand out
+// children or tags (children(), child_at(), tags(), tag_at()) still use the
+// non-const collection to mark the lookup index out of date.
+inline static void li_push_collection(lua_State* L, Array<Object> const& a) {
+	lua::push_lightuserdata(L, const_cast<Array<Object>*>(&a));
+}
+
+inline static Object const& li_const(Object* obj) {
+	return *obj;
+}
+
+// Tags without creating extra storage
+inline static Array<Object> const& li_tags(Object* obj) {
+	return obj->extra ? object::tags(*obj) : object::tags(li_const(obj));
+}
+
 TOGO_LI_FUNC_DEF(expression) {
 	auto obj = lua::get_pointer<Object>(L, 1);
 	lua::push_value(L, TOGO_LI_FUNC(array_iter));
-	lua::push_lightuserdata(L, &object::expression(*obj));
+	li_push_collection(L, object::expression(li_const(obj)));
 	lua::push_value(L, 0);
 	return 3;
 }
 
 TOGO_LI_FUNC_DEF(num_expression) {
 	auto obj = lua::get_pointer<Object>(L, 1);
-	lua::push_value(L, array::size(object::expression(*obj)));
+	lua::push_value(L, array::size(object::expression(li_const(obj))));
 	return 1;
 }
 
@@ -768,7 +806,7 @@ TOGO_LI_FUNC_DEF(remove_operand) {
 
 TOGO_LI_FUNC_DEF(operand_at) {
 	auto obj = lua::get_pointer<Object>(L, 1);
-	return li_sub_at(L, obj, object::expression(*obj));
+	return li_sub_at(L, obj, object::expression(li_const(obj)));
 }
 
 TOGO_LI_FUNC_DEF(children) {
@@ -781,13 +819,13 @@ TOGO_LI_FUNC_DEF(children) {
 
 TOGO_LI_FUNC_DEF(num_children) {
 	auto obj = lua::get_pointer<Object>(L, 1);
-	lua::push_value(L, array::size(object::children(*obj)));
+	lua::push_value(L, array::size(object::children(li_const(obj))));
 	return 1;
 }
 
 TOGO_LI_FUNC_DEF(has_children) {
 	auto obj = lua::get_pointer<Object>(L, 1);
-	lua::push_value(L, object::has_children(*obj));
+	lua::push_value(L, object::has_children(li_const(obj)));
 	return 1;
 }
 
@@ -817,6 +855,7 @@ TOGO_LI_FUNC_DEF(push_child_mv) {
 TOGO_LI_FUNC_DEF(pop_child) {
 	auto obj = lua::get_pointer<Object>(L, 1);
 	array::pop_back(object::children(*obj));
+	object::clear_indexes(*obj);
 	return 0;
 }
 
@@ -845,14 +884,14 @@ TOGO_LI_FUNC_DEF(find_child) {
 TOGO_LI_FUNC_DEF(tags) {
 	auto obj = lua::get_pointer<Object>(L, 1);
 	lua::push_value(L, li_array_iter);
-	lua::push_lightuserdata(L, &object::tags(*obj));
+	li_push_collection(L, li_tags(obj));
 	lua::push_value(L, 0);
 	return 3;
 }
 
 TOGO_LI_FUNC_DEF(num_tags) {
 	auto obj = lua::get_pointer<Object>(L, 1);
-	lua::push_value(L, array::size(object::tags(*obj)));
+	lua::push_value(L, array::size(object::tags(li_const(obj))));
 	return 1;
 }
 
@@ -888,6 +927,7 @@ TOGO_LI_FUNC_DEF(push_tag_mv) {
 TOGO_LI_FUNC_DEF(pop_tag) {
 	auto obj = lua::get_pointer<Object>(L, 1);
 	array::pop_back(object::tags(*obj));
+	object::clear_indexes(*obj);
 	return 0;
 }
 
@@ -898,7 +938,7 @@ TOGO_LI_FUNC_DEF(remove_tag) {
 
 TOGO_LI_FUNC_DEF(tag_at) {
 	auto obj = lua::get_pointer<Object>(L, 1);
-	return li_sub_at(L, obj, object::tags(*obj));
+	return li_sub_at(L, obj, li_tags(obj));
 }
 
 TOGO_LI_FUNC_DEF(find_tag) {
@@ -913,6 +953,12 @@ TOGO_LI_FUNC_DEF(find_tag) {
 	return 1;
 }
 
+TOGO_LI_FUNC_DEF(clear_indexes) {
+	auto obj = lua::get_pointer<Object>(L, 1);
+	object::clear_indexes(*obj);
+	return 0;
+}
+
 TOGO_LI_FUNC_DEF(quantity) {
 	auto obj = lua::get_pointer<Object>(L, 1);
 	lua::push_lightuserdata(L, object::quantity(*obj));
@@ -968,22 +1014,43 @@ TOGO_LI_FUNC_DEF(read_text_string) {
 	return 1;
 }
 
-// obj, path, single_value = false
+// obj, path, single_value = false, format = TextFormat.readable
 TOGO_LI_FUNC_DEF(write_text_file) {
 	auto obj = lua::get_pointer<Object>(L, 1);
 	auto path = lua::get_string(L, 2);
 	bool single_value = luaL_opt(L, lua::get_boolean, 3, false);
-	lua::push_value(L, object::write_text_file(*obj, path, single_value));
+	auto format = static_cast<ObjectTextFormat>(luaL_opt(L, luaL_checkinteger, 4, 0));
+	lua::push_value(L, object::write_text_file(*obj, path, single_value, format));
 	return 1;
 }
 
-// obj, single_value = false, capacity = 512
+// obj, path, layout = nil, single_value = false, container = obj
+TOGO_LI_FUNC_DEF(write_text_file_update) {
+	auto obj = lua::get_pointer<Object>(L, 1);
+	auto path = lua::get_string(L, 2);
+	bool single_value = luaL_opt(L, lua::get_boolean, 4, false);
+	auto container = lua_isnoneornil(L, 5) ? obj : lua::get_pointer<Object>(L, 5);
+	ObjectTextLayout* layout;
+	signed layout_index = 3;
+	if (lua_isnoneornil(L, 3)) {
+		layout = lua::new_userdata<ObjectTextLayout>(L);
+		layout_index = lua_gettop(L);
+	} else {
+		layout = lua::get_pointer<ObjectTextLayout>(L, 3);
+	}
+	lua::push_value(L, object::write_text_file_update(*obj, *container, path, *layout, single_value));
+	lua_pushvalue(L, layout_index);
+	return 2;
+}
+
+// obj, single_value = false, capacity = 512, format = TextFormat.readable
 TOGO_LI_FUNC_DEF(write_text_string) {
 	auto obj = lua::get_pointer<Object>(L, 1);
 	bool single_value = luaL_opt(L, lua::get_boolean, 2, false);
 	auto size = luaL_opt(L, luaL_checkinteger, 3, 512);
+	auto format = static_cast<ObjectTextFormat>(luaL_opt(L, luaL_checkinteger, 4, 0));
 	MemoryStream stream{memory::scratch_allocator(), static_cast<unsigned>(size)};
-	if (object::write_text(*obj, stream, single_value)) {
+	if (object::write_text(*obj, stream, single_value, format)) {
 		lua::push_value(L, {
 			reinterpret_cast<char*>(array::begin(stream.data())),
 			static_cast<unsigned>(stream.size())
@@ -1062,6 +1129,7 @@ static LuaModuleFunctionArray const li_funcs{
 	TOGO_LI_FUNC_REF(object, clear_value)
 	TOGO_LI_FUNC_REF(object, clear)
 	TOGO_LI_FUNC_REF(object, copy)
+	TOGO_LI_FUNC_REF(object, copy_shared)
 
 	TOGO_LI_FUNC_REF(object, set_null)
 
@@ -1145,6 +1213,7 @@ static LuaModuleFunctionArray const li_funcs{
 	TOGO_LI_FUNC_REF(object, remove_tag)
 	TOGO_LI_FUNC_REF(object, tag_at)
 	TOGO_LI_FUNC_REF(object, find_tag)
+	TOGO_LI_FUNC_REF(object, clear_indexes)
 
 	TOGO_LI_FUNC_REF(object, quantity)
 	TOGO_LI_FUNC_REF(object, has_quantity)
@@ -1156,6 +1225,7 @@ static LuaModuleFunctionArray const li_funcs{
 	TOGO_LI_FUNC_REF(object, read_text_file)
 	TOGO_LI_FUNC_REF(object, read_text_string)
 	TOGO_LI_FUNC_REF(object, write_text_file)
+	TOGO_LI_FUNC_REF(object, write_text_file_update)
 	TOGO_LI_FUNC_REF(object, write_text_string)
 };
 
@@ -1171,6 +1241,7 @@ static LuaModuleRef const li_module{
 /// Register the Lua interface.
 void object::register_lua_interface(lua_State* L) {
 	lua::preload_module(L, li_module);
+	object::register_frozen_lua_interface(L);
 }
 
 } // namespace quanta
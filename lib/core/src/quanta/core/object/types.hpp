@@ -16,6 +16,7 @@
 #include <quanta/core/chrono/types.hpp>
 
 #include <togo/core/utility/traits.hpp>
+#include <togo/core/memory/types.hpp>
 #include <togo/core/collection/types.hpp>
 #include <togo/core/string/types.hpp>
 #include <togo/core/hash/hash.hpp>
@@ -121,6 +122,15 @@ enum class ObjectTimeType : unsigned {
 	clock,
 };
 
+/// Object text format (see object::write_text()).
+enum class ObjectTextFormat : unsigned {
+	/// One child per line with tab indentation.
+	readable,
+	/// Minimal whitespace. Children are separated by commas on one line;
+	/// top-level objects are still written one per line.
+	compact,
+};
+
 /// Object.
 struct Object {
 	TOGO_LUA_MARK_USERDATA(quanta::object::Object);
@@ -150,29 +160,78 @@ struct Object {
 		HashedUnmanagedString<ObjectValueHasher> identifier;
 	};
 
+	/// Name lookup index of children or tags.
+	///
+	/// Open-addressed table of positions + 1 by name hash; capacity slots
+	/// follow the header. Covers the first size objects of the collection.
+	/// dirty is set when objects may have been renamed or moved in place
+	/// since the index was built.
+	struct Index {
+		u32 size;
+		u32 capacity;
+		bool dirty;
+	};
+
+	/// Children shared by objects (see object::copy_shared()).
+	struct SharedChildren {
+		u32 references;
+		Array<Object> array;
+
+		SharedChildren(Allocator& allocator);
+	};
+
+	/// Expression operands, tags, quantity, lookup indexes and shared
+	/// children.
+	///
+	/// Most objects have none of these, so they live in a side allocation
+	/// that is created on first use (see object::extra()).
+	struct Extra {
+		Array<Object> expression;
+		Array<Object> tags;
+		Object* quantity;
+		Index* children_index;
+		Index* tags_index;
+		SharedChildren* shared_children;
+
+		Extra(Allocator& allocator);
+	};
+
 	u32 properties;
 	u32 source_line;
 	u16 source;
 	u16 sub_source;
+	bool interned;
 	HashedUnmanagedString<ObjectNameHasher> name;
 	Value value;
-	Array<Object> expression;
-	Array<Object> tags;
 	Array<Object> children;
-	Object* quantity;
-
-	Object& operator=(Object&&) = delete;
+	Extra* extra;
+	Allocator* allocator;
 
 	~Object();
 	Object();
+	Object(Allocator& allocator);
 	Object(Object const& other);
-	Object(Object&& other);
+	Object(Object&& other) noexcept;
+	Object& operator=(Object&& other) noexcept;
 
 private:
 	friend struct togo::collection_npod_impl<Object, true>;
 	Object& operator=(Object const&);
 };
 
+/// Object node pool statistics.
+///
+/// Quantities and extra storage of objects using the default allocator are
+/// recycled through a per-thread pool (see object::pool_stats()).
+struct ObjectPoolStats {
+	/// Allocations served by the pool.
+	u64 hits;
+	/// Allocations that went to the allocator.
+	u64 misses;
+	/// Nodes in the pool.
+	u32 num_free;
+};
+
 /// Object parser information.
 struct ObjectParserInfo {
 	/// Line in stream.
@@ -183,6 +242,343 @@ struct ObjectParserInfo {
 	char message[512];
 };
 
+/// Object text reader checkpoint.
+///
+/// Position after the last complete top-level object read by
+/// object::read_text_resume(). A zero-initialized checkpoint reads from the
+/// start of the input.
+struct ObjectTextCheckpoint {
+	/// Byte offset in the input.
+	u64 offset;
+	/// Line at offset.
+	unsigned line;
+	/// Column at offset.
+	unsigned column;
+	/// Number of root children read up to offset.
+	unsigned num_children;
+};
+
+/// Object text file layout.
+///
+/// Sizes and hashes of the parts of a text file written by
+/// object::write_text_file_update(): the text before the first record, each
+/// record (child of the record container), and the text after the last
+/// record. The next update uses it to rewrite only what changed. It is also
+/// saved next to the file, and an empty layout is loaded from there.
+struct ObjectTextLayout {
+	TOGO_LUA_MARK_USERDATA(quanta::object::ObjectTextLayout);
+
+	struct Part {
+		u64 hash;
+		u64 size;
+	};
+
+	Part head;
+	Array<Part> records;
+	Part tail;
+	/// Size of the file.
+	u64 size;
+	/// Modification time of the file (nanoseconds).
+	u64 mtime;
+
+	ObjectTextLayout(ObjectTextLayout&&) = delete;
+	ObjectTextLayout(ObjectTextLayout const&) = delete;
+	ObjectTextLayout& operator=(ObjectTextLayout&&) = delete;
+	ObjectTextLayout& operator=(ObjectTextLayout const&) = delete;
+
+	ObjectTextLayout();
+	ObjectTextLayout(Allocator& allocator);
+};
+
+/// Object visit kind.
+enum class ObjectVisitKind : unsigned {
+	/// Top-level object or child.
+	child,
+	/// Tag.
+	tag,
+	/// Quantity.
+	quantity,
+	/// Expression operand.
+	operand,
+};
+
+/// Object value marker.
+enum class ObjectValueMarker : unsigned {
+	/// Uncertain value ('?').
+	uncertain,
+	/// Guess ('G').
+	guess,
+	/// Approximate value ('~' or '^').
+	approximate,
+};
+
+/// Object wrap kind (see IObjectVisitor::wrap()).
+enum class ObjectVisitWrap : unsigned {
+	/// First operand of an expression.
+	expression,
+	/// First child of a quantity collection.
+	collection,
+};
+
+/// Object value for visitors.
+///
+/// Strings are only valid for the duration of the visitor call.
+struct ObjectVisitValue {
+	struct Currency {
+		s64 value;
+		s32 exponent;
+	};
+	struct TimeValue {
+		Time value;
+		ObjectTimeType type;
+		bool zoned;
+		bool year_contextual;
+		bool month_contextual;
+	};
+
+	/// Value type.
+	///
+	/// Operands of an expression value follow as objects.
+	ObjectValueType type;
+	union {
+		bool boolean;
+		s64 integer;
+		f64 decimal;
+		Currency currency;
+		TimeValue time;
+	};
+	/// String or identifier.
+	StringRef string;
+	/// String type.
+	StringRef string_type;
+};
+
+/// Object visitor.
+///
+/// Receives the parts of objects in document order as the text parser reads
+/// them (see object::read_text_visit()) or as they are found in an object
+/// tree (see object::visit()). No objects are built for the visitor; strings
+/// are only valid for the duration of the call.
+///
+/// Parts of an object come between its begin_object() and end_object(). Its
+/// tags, expression operands, children and quantity are objects nested in
+/// it. Returning false stops the visit.
+///
+/// The default implementations ignore the part.
+class IObjectVisitor {
+public:
+	virtual ~IObjectVisitor() = 0;
+
+	/// Object begins.
+	///
+	/// line is the source line of the object.
+	virtual bool begin_object(ObjectVisitKind /*kind*/, unsigned /*line*/) { return true; }
+
+	/// Object ends.
+	virtual bool end_object() { return true; }
+
+	/// The object that just ended is wrapped.
+	///
+	/// The text format only shows that an object is the first operand of an
+	/// expression (or the first child of a quantity collection) once its
+	/// operator (or separator) is read. A new object takes the place and name
+	/// of the object that just ended and holds it as the first operand (or
+	/// child). The rest of its operands (or children) follow, and the new
+	/// object ends with end_object().
+	///
+	/// line is the source line of the new object.
+	virtual bool wrap(ObjectVisitWrap /*wrap*/, unsigned /*line*/) { return true; }
+
+	/// Name.
+	virtual bool name(StringRef /*name*/) { return true; }
+
+	/// Expression operator of an operand.
+	///
+	/// Follows begin_object() of each operand.
+	virtual bool op(ObjectOperator /*op*/) { return true; }
+
+	/// Value marker.
+	///
+	/// approximation is the value of an approximation marker (see
+	/// object::set_value_approximation()).
+	virtual bool marker(ObjectValueMarker /*marker*/, signed /*approximation*/) { return true; }
+
+	/// Value.
+	virtual bool value(ObjectVisitValue const& /*value*/) { return true; }
+
+	/// Unit of the numeric or currency value.
+	virtual bool unit(StringRef /*unit*/) { return true; }
+
+	/// Source.
+	///
+	/// source is 0 if only the certainty is specified.
+	virtual bool source(unsigned /*source*/, bool /*certain*/) { return true; }
+
+	/// Sub-source.
+	///
+	/// sub_source is 0 if only the certainty is specified.
+	virtual bool sub_source(unsigned /*sub_source*/, bool /*certain*/) { return true; }
+};
+
+inline IObjectVisitor::~IObjectVisitor() = default;
+
+/// Object arena.
+///
+/// Bump allocator for the strings, collections and quantities of an object
+/// document. deallocate() does nothing; memory is released by reset() or
+/// destruction.
+///
+/// The arena also keeps a pool of interned strings (see object::intern()).
+class ObjectArena : public Allocator {
+public:
+	enum : u32 {
+		/// Default block size.
+		BLOCK_SIZE = 64 * 1024,
+	};
+
+	struct Block {
+		Block* next;
+		u32 size;
+	};
+
+	struct InternedString {
+		char* data;
+		u32 size;
+		u32 hash;
+	};
+
+	Allocator& _backing;
+	Block* _head;
+	u8* _put;
+	u8* _end;
+	u32 _num_allocations;
+	u32 _total_size;
+	InternedString* _strings;
+	u32 _strings_capacity;
+	u32 _strings_size;
+
+	ObjectArena(ObjectArena&&) = delete;
+	ObjectArena(ObjectArena const&) = delete;
+	ObjectArena& operator=(ObjectArena&&) = delete;
+	ObjectArena& operator=(ObjectArena const&) = delete;
+
+	~ObjectArena() override;
+	ObjectArena(Allocator& backing);
+
+	u32 num_allocations() const override;
+	u32 total_size() const override;
+	void* allocate(u32 size, u32 align = DEFAULT_ALIGNMENT) override;
+	void deallocate(void* p) override;
+
+	/// Release all allocations and interned strings.
+	///
+	/// The first block and the string pool table are kept for reuse.
+	void reset();
+};
+
+/// Object document.
+///
+/// An object tree whose strings, collections and quantities are all
+/// allocated from an arena, which makes object::clear(ObjectDocument&) a
+/// single arena reset instead of a walk over the tree.
+///
+/// Names, units, identifiers and string types in the tree are interned in
+/// the arena, so each distinct string is stored once.
+///
+/// Objects added to the tree must be constructed with the document's
+/// allocator (see object::push_back_sub()); an object moved in from
+/// elsewhere keeps its own allocator and would leak on clear.
+///
+/// A document read by object::read_text_file() keeps the file mapped and
+/// refers to long strings in it in place; the mapping is released on clear.
+struct ObjectDocument {
+	ObjectArena arena;
+	Object root;
+	void* _mapping;
+	u32 _mapping_size;
+
+	ObjectDocument(ObjectDocument&&) = delete;
+	ObjectDocument(ObjectDocument const&) = delete;
+	ObjectDocument& operator=(ObjectDocument&&) = delete;
+	ObjectDocument& operator=(ObjectDocument const&) = delete;
+
+	~ObjectDocument();
+	ObjectDocument();
+	ObjectDocument(Allocator& backing);
+};
+
+/// Frozen object.
+///
+/// Read-only node of a FrozenObjectDocument. Properties are the same as
+/// those of the Object it was frozen from.
+///
+/// Strings and sub-objects are found by byte offsets from the node itself,
+/// so a node is usable without its document.
+struct FrozenObject {
+	/// String in the document's string blob.
+	struct String {
+		u32 offset;
+		u32 size;
+	};
+
+	union Value {
+		bool boolean;
+		s64 integer;
+		f64 decimal;
+		Object::Currency currency;
+		Time time;
+		String string;
+	};
+
+	u32 properties;
+	u32 source_line;
+	u16 source;
+	u16 sub_source;
+	ObjectNameHash name_hash;
+	String name;
+	/// Unit, string type or identifier.
+	String value_name;
+	ObjectValueHash value_hash;
+	/// Offset to the block of sub-objects: operands, tags, children, then
+	/// quantity.
+	u32 subs;
+	u32 num_operands;
+	u32 num_tags;
+	u32 num_children;
+	bool has_quantity;
+	Value value;
+};
+
+/// Frozen object document.
+///
+/// Immutable flat copy of an object tree (see object::freeze()).
+///
+/// Nodes and strings share a single allocation. The direct sub-objects of
+/// each node are stored as one contiguous block, blocks are in preorder,
+/// and the distinct strings of the tree follow the last node.
+///
+/// The data can also be a memory-mapped binary file (see
+/// object::read_binary_file()).
+struct FrozenObjectDocument {
+	TOGO_LUA_MARK_USERDATA(quanta::object::FrozenObjectDocument);
+
+	Allocator* _allocator;
+	FrozenObject* _data;
+	u32 _num_objects;
+	u32 _size;
+	void* _mapping;
+	u32 _mapping_size;
+
+	FrozenObjectDocument(FrozenObjectDocument&&) = delete;
+	FrozenObjectDocument(FrozenObjectDocument const&) = delete;
+	FrozenObjectDocument& operator=(FrozenObjectDocument&&) = delete;
+	FrozenObjectDocument& operator=(FrozenObjectDocument const&) = delete;
+
+	~FrozenObjectDocument();
+	FrozenObjectDocument();
+	FrozenObjectDocument(Allocator& allocator);
+};
+
 /** @} */ // end of doc-group lib_core_object
 
 } // namespace object
@@ -194,9 +590,22 @@ using object::OBJECT_NAME_NULL;
 using object::OBJECT_VALUE_NULL;
 using object::ObjectValueType;
 using object::ObjectTimeType;
+using object::ObjectTextFormat;
 using object::ObjectOperator;
 using object::Object;
+using object::ObjectArena;
+using object::ObjectDocument;
+using object::FrozenObject;
+using object::FrozenObjectDocument;
+using object::ObjectPoolStats;
 using object::ObjectParserInfo;
+using object::ObjectTextCheckpoint;
+using object::ObjectTextLayout;
+using object::ObjectVisitKind;
+using object::ObjectValueMarker;
+using object::ObjectVisitWrap;
+using object::ObjectVisitValue;
+using object::IObjectVisitor;
 
 } // namespace quanta
 
@@ -24,15 +24,17 @@ function M.adapt_list_to_object(prop_class, serialized_name)
 	end
 end
 
-function M.prefix_certainty(obj, str)
-	if not O.value_certain(obj) then
+-- object_module is the module obj is read through (default Quanta.Object).
+function M.prefix_certainty(obj, str, object_module)
+	if not (object_module or O).value_certain(obj) then
 		str = "?" .. str
 	end
 	return str
 end
 
 function M.compose_string(parent_accessor, context, obj)
-	local value = M.prefix_certainty(obj, "")
+	local O = context.O
+	local value = M.prefix_certainty(obj, "", O)
 	if O.is_string(obj) then
 		value = value .. O.string(obj)
 	elseif O.has_children(obj) then
@@ -144,8 +146,9 @@ function M.Description.adapt_struct(serialized_name, property_name, parent_acces
 	Match.Pattern{
 		name = serialized_name,
 		vtype = {O.Type.null, O.Type.string},
-		acceptor = function(_, thing, obj)
-			thing[property_name] = M.prefix_certainty(obj, O.is_string(obj) and O.string(obj) or "")
+		acceptor = function(context, thing, obj)
+			local O = context.O
+			thing[property_name] = M.prefix_certainty(obj, O.is_string(obj) and O.string(obj) or "", O)
 		end,
 	},
 	})
@@ -204,7 +207,8 @@ Match.Pattern{
 	name = {"address", "addr"},
 	children = {Match.Pattern{
 		vtype = {O.Type.null, O.Type.string},
-		acceptor = function(_, author, obj)
+		acceptor = function(context, author, obj)
+			local O = context.O
 			if O.is_string(obj) then
 				author.address = O.string(obj)
 				author.address_certain = O.value_certain(obj)
@@ -226,6 +230,7 @@ function M.Author.adapt_struct(serialized_name, property_name)
 				if r then
 					return r
 				end
+				local O = context.O
 				local author = M.Author(
 					O.is_string(obj) and O.string(obj) or nil,
 					O.value_certain(obj),
@@ -292,6 +297,7 @@ end
 
 function M.Note.adapt_struct(serialized_name, property_name)
 	local function add_timestamped_note(context, thing, obj)
+		local O = context.O
 		local t
 		local obj_time = O.child_at(obj, 1)
 		if not O.has_date(obj_time) or O.is_date_contextual(obj_time) then
@@ -312,14 +318,15 @@ function M.Note.adapt_struct(serialized_name, property_name)
 	Match.Pattern{
 		name = serialized_name,
 		vtype = O.Type.string,
-		acceptor = function(_, thing, obj)
-			table.insert(thing[property_name], M.Note(O.string(obj)))
+		acceptor = function(context, thing, obj)
+			table.insert(thing[property_name], M.Note(context.O.string(obj)))
 		end,
 	},
 	-- = {time, string}
 	Match.Pattern{
 		name = serialized_name,
-		children = function(_, _, obj, _)
+		children = function(context, _, obj, _)
+			local O = context.O
 			return (
 				O.num_children(obj) == 2 and
 				O.is_type(O.child_at(obj, 1), O.Type.time) and
@@ -337,14 +344,15 @@ function M.Note.adapt_struct(serialized_name, property_name)
 			-- string
 			Match.Pattern{
 				vtype = O.Type.string,
-				acceptor = function(_, thing, obj)
-					table.insert(thing[property_name], M.Note(O.string(obj)))
+				acceptor = function(context, thing, obj)
+					table.insert(thing[property_name], M.Note(context.O.string(obj)))
 				end,
 			},
 			-- {time, string}
 			Match.Pattern{
 				vtype = O.Type.null,
-				children = function(_, _, obj, _)
+				children = function(context, _, obj, _)
+					local O = context.O
 					return (
 						O.num_children(obj) == 2 and
 						O.is_type(O.child_at(obj, 1), O.Type.time) and
@@ -401,12 +409,13 @@ M.Model.t_head_tags = Match.Tree({
 -- :id("...")
 Match.Pattern{
 	name = "id",
-	func = function(_, _, obj, _)
-		return O.num_children(obj) == 1
+	func = function(context, _, obj, _)
+		return context.O.num_children(obj) == 1
 	end,
 	children = {Match.Pattern{
 		vtype = {O.Type.null, O.Type.string},
-		acceptor = function(_, model, obj)
+		acceptor = function(context, model, obj)
+			local O = context.O
 			if O.is_string(obj) then
 				model.id = O.string(obj)
 				model.id_certain = O.value_certain(obj)
@@ -436,6 +445,7 @@ function M.Model.adapt_struct(serialized_name, property_name)
 			if #thing[property_name] > 0 then
 				return Match.Error(serialized_name .. " was already specified")
 			end
+			local O = context.O
 			local model = M.Model(
 				O.is_string(obj) and O.string(obj) or nil,
 				O.value_certain(obj),
@@ -15,6 +15,8 @@
 #include <togo/core/utility/utility.hpp>
 #include <togo/core/string/types.hpp>
 
+#include <cstring>
+
 namespace togo {
 	class Allocator;
 } // namespace togo
@@ -34,13 +36,21 @@ namespace unmanaged_string {
 */
 
 /// Unmanaged string.
+///
+/// Strings of up to INLINE_CAPACITY bytes are stored in the struct itself;
+/// longer strings are allocated. Data is NUL-terminated unless the string
+/// refers to a value it does not own (see unmanaged_string::set_shared()).
 struct UnmanagedString {
-	char* data;
+	enum : u32 {
+		/// Maximum size of a string stored in the struct.
+		INLINE_CAPACITY = 11,
+	};
+
 	u32 size;
+	// Characters if size <= INLINE_CAPACITY, otherwise pointer to data
+	char _storage[INLINE_CAPACITY + 1];
 
-	operator StringRef() const {
-		return StringRef{data, size};
-	}
+	operator StringRef() const;
 };
 
 /// Hashed unmanaged string.
@@ -51,10 +61,29 @@ struct HashedUnmanagedString
 	typename H::Value hash;
 
 	operator StringRef() const {
-		return StringRef{data, size};
+		return static_cast<UnmanagedString const&>(*this);
 	}
 };
 
+/// Whether the string is stored in the struct.
+inline bool is_inline(UnmanagedString const& s) {
+	return s.size <= UnmanagedString::INLINE_CAPACITY;
+}
+
+/// String data.
+inline char const* data(UnmanagedString const& s) {
+	if (unmanaged_string::is_inline(s)) {
+		return s._storage;
+	}
+	char const* data;
+	std::memcpy(&data, s._storage, sizeof(data));
+	return data;
+}
+
+inline UnmanagedString::operator StringRef() const {
+	return StringRef{unmanaged_string::data(*this), size};
+}
+
 /** @} */ // end of doc-group lib_core_unmanaged_string
 
 } // namespace unmanaged_string
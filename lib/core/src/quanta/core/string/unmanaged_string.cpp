@@ -11,24 +11,62 @@
 #include <togo/core/memory/memory.hpp>
 #include <togo/core/string/string.hpp>
 
+#include <cstring>
+
 namespace quanta {
 
+namespace unmanaged_string {
+namespace {
+
+inline static void set_heap_data(UnmanagedString& s, char const* const data) {
+	std::memcpy(s._storage, &data, sizeof(data));
+}
+
+} // anonymous namespace
+} // namespace unmanaged_string
+
 /// Set value.
+///
+/// The value is copied into s if it fits, otherwise into a new allocation.
 void unmanaged_string::set(UnmanagedString& s, StringRef value, Allocator& a) {
 	unmanaged_string::clear(s, a);
 	if (value.empty()) {
 		return;
 	}
 	s.size = value.size;
-	s.data = static_cast<char*>(a.allocate(s.size + 1));
-	string::copy(s.data, s.size + 1, value);
+	char* data = s._storage;
+	if (!unmanaged_string::is_inline(s)) {
+		data = static_cast<char*>(a.allocate(s.size + 1));
+		unmanaged_string::set_heap_data(s, data);
+	}
+	string::copy(data, s.size + 1, value);
+}
+
+/// Set value without taking a copy of it.
+///
+/// A value that fits in s is copied as with set(). Otherwise s refers to
+/// value, which must outlive s, and s must not be cleared with an allocator
+/// that would free it. value need not be NUL-terminated; the data of s is
+/// then only valid up to its size. The previous value of s is not freed.
+void unmanaged_string::set_shared(UnmanagedString& s, StringRef value) {
+	s.size = value.size;
+	if (value.empty()) {
+		s._storage[0] = '\0';
+	} else if (unmanaged_string::is_inline(s)) {
+		std::memcpy(s._storage, value.data, value.size);
+		s._storage[value.size] = '\0';
+	} else {
+		unmanaged_string::set_heap_data(s, value.data);
+	}
 }
 
 /// Free data.
 void unmanaged_string::clear(UnmanagedString& s, Allocator& a) {
-	a.deallocate(s.data);
-	s.data = nullptr;
+	if (!unmanaged_string::is_inline(s)) {
+		a.deallocate(const_cast<char*>(unmanaged_string::data(s)));
+	}
 	s.size = 0;
+	s._storage[0] = '\0';
 }
 
 } // namespace quanta
@@ -40,7 +40,13 @@ inline bool any(UnmanagedString const& s) { return s.size > 0; }
 template<class H>
 void set(HashedUnmanagedString<H>& s, StringRef value, Allocator& a) {
 	unmanaged_string::set(static_cast<UnmanagedString&>(s), value, a);
-	s.hash = hash::calc<H>(s.data, s.size);
+	s.hash = hash::calc<H>(unmanaged_string::data(s), s.size);
+}
+
+template<class H>
+void set_shared(HashedUnmanagedString<H>& s, StringRef value, typename H::Value const hash) {
+	unmanaged_string::set_shared(static_cast<UnmanagedString&>(s), value);
+	s.hash = hash;
 }
 
 template<class H>
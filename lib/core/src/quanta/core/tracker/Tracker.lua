@@ -20,8 +20,11 @@ function M:__init()
 	self.attachments = {}
 end
 
-function M:from_object(obj)
+-- object_module is the module obj is read through: Quanta.Object (default) or
+-- Quanta.FrozenObject.
+function M:from_object(obj, object_module)
 	U.type_assert(obj, "userdata")
+	U.type_assert(object_module, "table", true)
 
 	T.clear(self.date)
 	self.entries = {}
@@ -29,7 +32,7 @@ function M:from_object(obj)
 	self.entry_by_marker = {}
 	self.attachments = {}
 
-	local context = Vessel.new_match_context(nil)
+	local context = Vessel.new_match_context(nil, object_module)
 	context.user.tracker = self
 	if not context:consume(M.t_head, obj, self) then
 		return false, context.error:to_string(), context.error.source_line
@@ -64,13 +67,26 @@ function M:to_object(obj)
 	return obj
 end
 
+-- Write to file, rewriting only the changed entries when possible. layout is
+-- from the previous write of the file; if nil, the layout that write saved
+-- next to the file is used. Returns success, layout.
+function M:write_file(path, layout)
+	local obj = self:to_object()
+	return O.write_text_file_update(obj, path, layout, true, O.find_child(obj, "entries"))
+end
+
 local function entry_error(entry, msg, ...)
-	msg = string.format(
-		"%s\nat object (line %d): ```\n%s\n```",
-		string.format(msg, ...),
-		entry.source_line,
-		O.write_text_string(entry.obj, true)
-	)
+	msg = string.format(msg, ...)
+	if entry.object_module.write_text_string then
+		msg = string.format(
+			"%s\nat object (line %d): ```\n%s\n```",
+			msg,
+			entry.source_line,
+			entry.object_module.write_text_string(entry.obj, true)
+		)
+	else
+		msg = string.format("%s\nat object (line %d)", msg, entry.source_line)
+	end
 	return false, msg, entry.source_line
 end
 
@@ -273,7 +289,7 @@ Match.Pattern{name = "action_primary"},
 Match.Pattern{name = "action_passive"},
 })
 
-local function add_action(list, obj)
+local function add_action(O, list, obj)
 	local action = M.Action(
 		O.identifier(obj),
 		O.identifier_hash(obj)
@@ -295,7 +311,7 @@ function M.Action.adapt_struct_list(serialized_name, property_name)
 			tags = Match.Any,
 			children = Match.Any,
 			acceptor = function(context, parent, obj)
-				local action = add_action(parent[property_name], obj)
+				local action = add_action(context.O, parent[property_name], obj)
 				return parent:read_action(context, action, obj)
 			end,
 		}
@@ -327,10 +343,11 @@ M.Action.p_head = Match.Pattern{
 	tags = Match.Any,
 	children = Match.Any,
 	acceptor = function(context, entry, obj)
-		local action = add_action(entry.actions, obj)
+		local action = add_action(context.O, entry.actions, obj)
 		return context.user.director:read_action(context, entry, action, obj)
 	end,
 	post_branch = function(context, entry, obj)
+		local O = context.O
 		local tag_action_primary = O.find_tag(obj, "action_primary")
 		if tag_action_primary then
 			if entry.primary_action then
@@ -374,11 +391,11 @@ Match.Pattern{
 		name = {"d", ""},
 		vtype = O.Type.string,
 		acceptor = function(context, self, obj)
-			self.description = O.string(obj)
+			self.description = context.O.string(obj)
 		end,
 	}},
 	acceptor = function(context, self, obj)
-		if O.num_children(obj) > 1 then
+		if context.O.num_children(obj) > 1 then
 			return Match.Error("placeholder action can only carry a single string")
 		end
 	end,
@@ -394,8 +411,8 @@ function M.UnknownAction:__init()
 end
 
 function M.UnknownAction:from_object(context, entry, action, obj)
-	O.copy_children(self.obj, obj)
-	O.copy_tags(self.obj, obj)
+	context.O.copy_children(self.obj, obj)
+	context.O.copy_tags(self.obj, obj)
 	M.Action.remove_internal_tags(self.obj)
 end
 
@@ -467,7 +484,7 @@ function M.EntryTime:to_object(obj, scope)
 	return obj
 end
 
-local function entry_time_set_uncertainties(self, obj)
+local function entry_time_set_uncertainties(O, self, obj)
 	self.approximation = O.value_approximation(obj)
 	self.certain = not (O.marker_value_uncertain(obj) or O.marker_value_guess(obj))
 end
@@ -482,6 +499,7 @@ M.EntryTime.t_head = Match.Tree({
 Match.Pattern{
 	vtype = O.Type.time,
 	acceptor = function(context, self, obj)
+		local O = context.O
 		if O.is_zoned(obj) then
 			return Match.Error("entry range endpoint must not be zoned")
 		elseif not O.has_clock(obj) then
@@ -491,7 +509,7 @@ Match.Pattern{
 		self.type = M.EntryTime.Type.specified
 
 		T.set(self.time, O.time_resolved(obj, context.user.tracker.date))
-		entry_time_set_uncertainties(self, obj)
+		entry_time_set_uncertainties(context.O, self, obj)
 	end,
 },
 -- XXX
@@ -515,24 +533,24 @@ Match.Pattern{
 	-- ...[>0]
 	quantity = {Match.Pattern{
 		vtype = O.Type.integer,
-		value = function(_, _, obj, _)
-			if O.integer(obj) <= 0 then
+		value = function(context, _, obj, _)
+			if context.O.integer(obj) <= 0 then
 				return Match.Error("entry time ref index must be greater than zero")
 			end
 			return true
 		end,
 		acceptor = function(context, self, obj)
-			self.index = self.index * O.integer(obj)
+			self.index = self.index * context.O.integer(obj)
 		end,
 	}},
 	acceptor = function(context, self, obj)
 		self.type = M.EntryTime.Type.ref
-		if O.identifier(obj) == "EPREV" then
+		if context.O.identifier(obj) == "EPREV" then
 			self.index = -1
 		else
 			self.index = 1
 		end
-		entry_time_set_uncertainties(self, obj)
+		entry_time_set_uncertainties(context.O, self, obj)
 	end,
 },
 -- identifier
@@ -540,8 +558,8 @@ Match.Pattern{
 	vtype = O.Type.identifier,
 	acceptor = function(context, self, obj)
 		self.type = M.EntryTime.Type.marker
-		self.marker = O.identifier(obj)
-		entry_time_set_uncertainties(self, obj)
+		self.marker = context.O.identifier(obj)
+		entry_time_set_uncertainties(context.O, self, obj)
 	end,
 },
 })
@@ -600,8 +618,8 @@ function M.Entry:to_object(obj, scope)
 	O.set_name(range_obj, "range")
 	O.set_expression(range_obj)
 
-	local r_start_obj = O.push_child(range_obj)
-	local r_end_obj = O.push_child(range_obj)
+	local r_start_obj = O.push_operand(range_obj)
+	local r_end_obj = O.push_operand(range_obj)
 
 	self.r_start:to_object(r_start_obj, scope)
 	O.set_op(r_end_obj, O.Operator.sub)
@@ -666,7 +684,8 @@ M.Entry.p_head = Match.Pattern{
 		local entry = M.Entry()
 		table.insert(tracker.entries, entry)
 		entry.obj = obj
-		entry.source_line = O.source_line(obj)
+		entry.object_module = context.O
+		entry.source_line = context.O.source_line(obj)
 		return entry
 	end,
 }
@@ -685,9 +704,10 @@ Match.Pattern{
 	name = "range",
 	vtype = O.Type.expression,
 	acceptor = function(context, self, obj)
-		if O.num_children(obj) ~= 2 then
+		local O = context.O
+		if O.num_expression(obj) ~= 2 then
 			return Match.Error("range must have two elements")
-		elseif O.op(O.operand(obj, 2)) ~= O.Operator.sub then
+		elseif O.op(O.operand_at(obj, 2)) ~= O.Operator.sub then
 			return Match.Error("range operator must be a subtraction")
 		end
 
@@ -706,7 +726,7 @@ Match.Pattern{
 	children = {Match.Pattern{
 		vtype = {O.Type.identifier, O.Type.string},
 		acceptor = function(context, self, obj)
-			table.insert(self.tags, O.text(obj))
+			table.insert(self.tags, context.O.text(obj))
 		end,
 	}},
 },
@@ -716,7 +736,7 @@ Match.Pattern{
 	name = "rel_id",
 	vtype = O.Type.identifier,
 	acceptor = function(context, self, obj)
-		table.insert(self.rel_id, O.identifier(obj))
+		table.insert(self.rel_id, context.O.identifier(obj))
 	end,
 },
 -- rel_id = {...}
@@ -725,7 +745,7 @@ Match.Pattern{
 	children = {Match.Pattern{
 		vtype = O.Type.identifier,
 		acceptor = function(context, self, obj)
-			table.insert(self.rel_id, O.identifier(obj))
+			table.insert(self.rel_id, context.O.identifier(obj))
 		end,
 	}},
 },
@@ -735,7 +755,7 @@ Match.Pattern{
 	name = "continue_id",
 	vtype = O.Type.identifier,
 	acceptor = function(context, self, obj)
-		self.continue_id = O.identifier(obj)
+		self.continue_id = context.O.identifier(obj)
 		self.continue_scope = context.user.tracker.date
 	end,
 },
@@ -750,6 +770,7 @@ Match.Pattern{
 	vtype = O.Type.time,
 	children = 1,
 	acceptor = function(context, self, obj)
+		local O = context.O
 		if O.has_clock(obj) then
 			return Match.Error("scope must not have clock time")
 		end
@@ -764,7 +785,7 @@ Match.Pattern{
 	name = "marker",
 	vtype = O.Type.identifier,
 	acceptor = function(context, self, obj)
-		self.marker = O.identifier(obj)
+		self.marker = context.O.identifier(obj)
 		if context.user.tracker.entry_by_marker[self.marker] then
 			return Match.Error("marker '%s' is not unique", self.marker)
 		end
@@ -780,7 +801,7 @@ Match.Pattern{
 	name = "actions",
 	children = {M.Action.p_head},
 	acceptor = function(context, self, obj)
-		if not O.has_children(obj) then
+		if not context.O.has_children(obj) then
 			return Match.Error("entry actions must be non-empty when specified")
 		end
 	end,
@@ -823,8 +844,8 @@ M.Attachment.p_head = Match.Pattern{
 	children = Match.Any,
 	acceptor = function(context, tracker, obj)
 		local attachment = M.Attachment()
-		attachment.id = O.identifier(obj)
-		attachment.id_hash = O.identifier_hash(obj)
+		attachment.id = context.O.identifier(obj)
+		attachment.id_hash = context.O.identifier_hash(obj)
 		table.insert(tracker.attachments, attachment)
 
 		return context.user.director:read_attachment(context, tracker, attachment, obj)
@@ -838,8 +859,8 @@ function M.UnknownAttachment:__init()
 end
 
 function M.UnknownAttachment:from_object(context, tracker, attachment, obj)
-	O.copy_children(self.obj, obj)
-	O.copy_tags(self.obj, obj)
+	context.O.copy_children(self.obj, obj)
+	context.O.copy_tags(self.obj, obj)
 end
 
 function M.UnknownAttachment:to_object(attachment, obj)
@@ -869,6 +890,7 @@ Match.Pattern{
 	name = "date",
 	vtype = O.Type.time,
 	acceptor = function(context, self, obj)
+		local O = context.O
 		if O.is_date_contextual(obj) then
 			return Match.Error("date must be full")
 		elseif not O.is_zoned(obj) then
@@ -304,24 +304,26 @@ function M:add(item)
 	return item
 end
 
-local function unit_from_object(self, obj, implicit_scope, tree)
+local function unit_from_object(self, obj, implicit_scope, object_module, tree)
 	U.type_assert(obj, "userdata")
 
-	local context = Vessel.new_match_context(implicit_scope)
+	local context = Vessel.new_match_context(implicit_scope, object_module)
 	if not context:consume(tree, obj, self) then
 		return false, context.error:to_string()
 	end
 	return true
 end
 
-function M:from_object(obj, implicit_scope)
-	return unit_from_object(self, obj, implicit_scope, M.t_branch_head)
+-- object_module is the module obj is read through: Quanta.Object (default) or
+-- Quanta.FrozenObject.
+function M:from_object(obj, implicit_scope, object_module)
+	return unit_from_object(self, obj, implicit_scope, object_module, M.t_branch_head)
 end
 
-function M:from_object_by_type(obj, implicit_scope)
+function M:from_object_by_type(obj, implicit_scope, object_module)
 	U.type_assert(obj, "userdata")
 
-	return unit_from_object(self, obj, implicit_scope, M.t_head_by_type[self.type])
+	return unit_from_object(self, obj, implicit_scope, object_module, M.t_head_by_type[self.type])
 end
 
 function M:to_object(obj, keep)
@@ -580,7 +582,7 @@ function M.Modifier.adapt_struct_list()
 		name = true,
 		children = Match.Any,
 		acceptor = function(context, parent, obj)
-			local modifier = M.Modifier(O.name(obj), O.name_hash(obj))
+			local modifier = M.Modifier(context.O.name(obj), context.O.name_hash(obj))
 			table.insert(parent.modifiers, modifier)
 
 			return context.user.director:read_modifier(context, parent, modifier, obj)
@@ -622,7 +624,7 @@ function M.UnknownModifier:copy(unknown_modifier)
 end
 
 function M.UnknownModifier:from_object(context, ref, modifier, obj)
-	O.copy_children(self.obj, obj)
+	context.O.copy_children(self.obj, obj)
 end
 
 function M.UnknownModifier:to_object(modifier, obj)
@@ -651,6 +653,7 @@ local function child_post_branch(context, self, obj)
 end
 
 local function translate_basic(context, self, obj)
+	local O = context.O
 	self:set_name(O.name(obj))
 	self.source = O.source(obj)
 	self.sub_source = O.sub_source(obj)
@@ -675,15 +678,15 @@ M.t_definition_element_body = Match.Tree()
 M.p_definition_head = Match.Pattern{
 	name = Match.Any,
 	vtype = O.Type.identifier,
-	value = function(_, _, obj, _)
-		return nil ~= M.DefinitionTypeByNotation[O.identifier(obj)]
+	value = function(context, _, obj, _)
+		return nil ~= M.DefinitionTypeByNotation[context.O.identifier(obj)]
 	end,
 	children = M.t_definition_body,
 	tags = M.Modifier.t_struct_list_head,
 	quantity = Measurement.t_struct_list_head,
 	acceptor = function(context, self, obj)
 		self.type = M.Type.definition
-		self.sub_type = M.DefinitionTypeByNotation[O.identifier(obj)]
+		self.sub_type = M.DefinitionTypeByNotation[context.O.identifier(obj)]
 		translate_basic(context, self, obj)
 	end,
 }
@@ -698,6 +701,7 @@ M.p_reference_head_id = Match.Pattern{
 	acceptor = function(context, self, obj)
 		self.type = M.Type.reference
 		translate_basic(context, self, obj)
+		local O = context.O
 		if O.is_identifier(obj) then
 			self:set_id(O.identifier(obj))
 		else
@@ -789,6 +793,7 @@ Match.Pattern{
 	quantity = false,
 	acceptor = function(context, self, obj)
 		self.type = M.Type.composition
+		local O = context.O
 		local t
 		if O.has_clock(obj) then
 			return Match.Error("contextual block must not have clock time")
@@ -819,8 +824,8 @@ Match.Pattern{
 	children = M.t_composition_body,
 	tags = M.Modifier.t_struct_list_head,
 	quantity = Measurement.t_struct_list_head,
-	func = function(_, _, obj)
-		return O.has_children(obj) or O.has_operands(obj)
+	func = function(context, _, obj)
+		return context.O.has_children(obj) or context.O.has_operands(obj)
 	end,
 	acceptor = function(context, self, obj)
 		self.type = M.Type.composition
@@ -856,7 +861,8 @@ M.t_definition_head:add(M.p_definition_head)
 
 M.t_definition_body:add(common_props)
 
-local function element_name_filter(_, _, obj, _)
+local function element_name_filter(context, _, obj, _)
+	local O = context.O
 	return (
 		O.is_named(obj) and
 		string.find(O.name(obj), M.element_name_pattern) ~= nil
@@ -884,6 +890,7 @@ local function element_acceptor(element, _, unit, _)
 end
 
 local function element_post_branch(context, element, obj)
+	local O = context.O
 	if #element.items == 0 then
 		return Match.Error("no steps specified for element %s", element.name)
 	end
@@ -910,7 +917,7 @@ Match.Pattern{
 	children = M.t_definition_element_body,
 	quantity = Match.Any,
 	acceptor = function(context, unit, obj)
-		local element = M.ElementFromString(O.name(obj))
+		local element = M.ElementFromString(context.O.name(obj))
 		return element_acceptor(element, context, unit, obj) or element
 	end,
 	post_branch_pre = element_post_branch,
@@ -924,7 +931,7 @@ Match.Pattern{
 	quantity = Match.Any,
 	branch = M.t_reference_head,
 	acceptor = function(context, unit, obj)
-		local element = M.ElementFromString(O.name(obj))
+		local element = M.ElementFromString(context.O.name(obj))
 		local err = element_acceptor(element, context, unit, obj)
 		if err then
 			return err
@@ -958,6 +965,7 @@ Match.Pattern{
 M.t_definition_element_body:add(common_props)
 
 local function step_post_branch(context, step, obj)
+	local O = context.O
 	if #step.items == 0 then
 		return Match.Error("no items specified for step")
 	end
@@ -973,13 +981,13 @@ M.t_definition_element_body:add({
 -- RS#{...}
 Match.Pattern{
 	vtype = O.Type.identifier,
-	value = function(_, _, obj, _)
-		return string.find(O.identifier(obj), M.step_id_pattern) ~= nil
+	value = function(context, _, obj, _)
+		return string.find(context.O.identifier(obj), M.step_id_pattern) ~= nil
 	end,
 	children = M.t_composition_body,
 	quantity = Match.Any,
-	acceptor = function(_, element, obj)
-		local step = M.Step(O.identifier(obj))
+	acceptor = function(context, element, obj)
+		local step = M.Step(context.O.identifier(obj))
 		local current = element.items[step.seq_index]
 		if step.seq_index <= 0 then
 			return Match.Error("step RS%d index must be greater than 0", step.seq_index)
@@ -166,11 +166,13 @@ function M.reload_config()
 	U.type_assert(M.config.director, require("Quanta.Director"))
 end
 
-function M.new_match_context(implicit_scope)
+-- object_module is passed to Match.Context; see there.
+function M.new_match_context(implicit_scope, object_module)
 	U.type_assert(implicit_scope, "userdata", true)
+	U.type_assert(object_module, "table", true)
 	check_initialized()
 
-	local context = Match.Context()
+	local context = Match.Context(object_module)
 	context.user = context.user or {}
 	context.user.director = M.config.director
 	context.user.implicit_scope = implicit_scope and T(implicit_scope) or nil
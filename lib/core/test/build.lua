@@ -8,6 +8,8 @@ local configs = {
 togo.make_tests("object", {
 	["general"] = {nil, configs},
 	["io_text"] = {nil, configs},
+	["frozen"] = {nil, configs},
+	["io_binary"] = {nil, configs},
 	["lua_interface"] = {nil, configs},
 })
 
@@ -79,5 +79,50 @@ signed main() {
 		ASSERT_BOTH(t, 2011,3,7, 31+28+7, 9,30,0);
 		TOGO_ASSERTE(time::posix(t) == posix_sec);
 	}
+
+	{
+		enum : unsigned { NUM = 1000 };
+		Time times[NUM];
+		s32 year[NUM];
+		s32 month[NUM];
+		s32 day[NUM];
+		s32 year_day[NUM];
+
+		// consecutive days through leap and century years
+		Time t{};
+		adjust_zone_clock(t, +2);
+		time::gregorian::set(t, 1899,12,25, 1,0,0);
+		for (unsigned i = 0; i < NUM; ++i) {
+			times[i] = t;
+			add(t, (i < 400 ? 1 : 367) * time::SECS_PER_DAY);
+		}
+		// before the Quanta epoch and outside the batch calendar range
+		times[997] = Time{-1, 0};
+		times[998] = Time{-(s64{1} << 50), -3600};
+		times[999] = Time{s64{1} << 50, 3600};
+
+		auto const batch = array_ref(unsigned{NUM}, static_cast<Time const*>(times));
+		time::gregorian::dates(batch, year, month, day, year_day);
+		TOGO_ASSERTE(year[0] == 1899 && month[0] == 12 && day[0] == 25 && year_day[0] == 359);
+		TOGO_ASSERTE(year[7] == 1900 && month[7] == 1 && day[7] == 1 && year_day[7] == 1);
+		TOGO_ASSERTE(year[997] == 0 && month[997] == 12 && day[997] == 31 && year_day[997] == 366);
+		for (unsigned i = 0; i < NUM; ++i) {
+			Date const date = time::gregorian::date(times[i]);
+			TOGO_ASSERTE(
+				date.year == year[i] && date.month == month[i] &&
+				date.day == day[i] && date.year_day == year_day[i]
+			);
+		}
+
+		time::gregorian::dates_utc(batch, year, month, day, year_day);
+		TOGO_ASSERTE(year[0] == 1899 && month[0] == 12 && day[0] == 24 && year_day[0] == 358);
+		for (unsigned i = 0; i < NUM; ++i) {
+			Date const date = time::gregorian::date_utc(times[i]);
+			TOGO_ASSERTE(
+				date.year == year[i] && date.month == month[i] &&
+				date.day == day[i] && date.year_day == year_day[i]
+			);
+		}
+	}
 	return 0;
 }
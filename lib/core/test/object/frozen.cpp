@@ -0,0 +1,150 @@
+#include <togo/core/error/assert.hpp>
+#include <togo/core/string/string.hpp>
+#include <togo/core/collection/array.hpp>
+#include <togo/support/test.hpp>
+
+#include <quanta/core/chrono/time.hpp>
+#include <quanta/core/object/object.hpp>
+
+using namespace quanta;
+
+static void check_equal(FrozenObject const& f, Object const& obj) {
+	TOGO_ASSERTE(type(f) == type(obj));
+	TOGO_ASSERTE(f.properties == obj.properties);
+	TOGO_ASSERTE(source_line(f) == source_line(obj));
+	TOGO_ASSERTE(source(f) == source(obj) && sub_source(f) == sub_source(obj));
+	TOGO_ASSERTE(name_hash(f) == name_hash(obj));
+	TOGO_ASSERTE(string::compare_equal(name(f), name(obj)));
+	switch (type(obj)) {
+	case ObjectValueType::null:
+	case ObjectValueType::expression:
+		break;
+	case ObjectValueType::boolean:
+		TOGO_ASSERTE(boolean(f) == boolean(obj));
+		break;
+	case ObjectValueType::integer:
+		TOGO_ASSERTE(integer(f) == integer(obj));
+		TOGO_ASSERTE(unit_hash(f) == unit_hash(obj));
+		TOGO_ASSERTE(string::compare_equal(unit(f), unit(obj)));
+		break;
+	case ObjectValueType::decimal:
+		TOGO_ASSERTE(f.value.integer == obj.value.numeric.integer);
+		TOGO_ASSERTE(string::compare_equal(unit(f), unit(obj)));
+		break;
+	case ObjectValueType::currency:
+		TOGO_ASSERTE(currency(f) == currency(obj));
+		TOGO_ASSERTE(currency_exponent(f) == currency_exponent(obj));
+		TOGO_ASSERTE(string::compare_equal(unit(f), unit(obj)));
+		break;
+	case ObjectValueType::time:
+		TOGO_ASSERTE(time::compare_equal(time_value(f), time_value(obj)));
+		TOGO_ASSERTE(time_type(f) == time_type(obj));
+		TOGO_ASSERTE(is_zoned(f) == is_zoned(obj));
+		break;
+	case ObjectValueType::string:
+		TOGO_ASSERTE(string::compare_equal(object::string(f), object::string(obj)));
+		TOGO_ASSERTE(string_type_hash(f) == string_type_hash(obj));
+		TOGO_ASSERTE(string::compare_equal(string_type(f), string_type(obj)));
+		break;
+	case ObjectValueType::identifier:
+		TOGO_ASSERTE(identifier_hash(f) == identifier_hash(obj));
+		TOGO_ASSERTE(string::compare_equal(identifier(f), identifier(obj)));
+		break;
+	}
+
+	if (is_expression(obj)) {
+		auto const operands = expression(f);
+		TOGO_ASSERTE(operands.size() == array::size(expression(obj)));
+		for (unsigned i = 0; i < operands.size(); ++i) {
+			check_equal(operands[i], expression(obj)[i]);
+		}
+	}
+	auto const f_tags = tags(f);
+	TOGO_ASSERTE(f_tags.size() == array::size(tags(obj)));
+	for (unsigned i = 0; i < f_tags.size(); ++i) {
+		check_equal(f_tags[i], tags(obj)[i]);
+	}
+	auto const f_children = children(f);
+	TOGO_ASSERTE(f_children.size() == array::size(children(obj)));
+	for (unsigned i = 0; i < f_children.size(); ++i) {
+		check_equal(f_children[i], children(obj)[i]);
+	}
+	TOGO_ASSERTE(has_quantity(f) == has_quantity(obj));
+	if (has_quantity(obj)) {
+		check_equal(*quantity(f), *quantity(obj));
+	}
+}
+
+signed main() {
+	memory_init();
+
+	{
+		FrozenObjectDocument doc;
+		TOGO_ASSERTE(num_objects(doc) == 0 && size(doc) == 0);
+		auto const& root = object::root(doc);
+		TOGO_ASSERTE(is_null(root) && !is_named(root));
+		TOGO_ASSERTE(!has_children(root) && !has_tags(root) && !has_quantity(root));
+		TOGO_ASSERTE(!find_child(root, "a"));
+	}
+
+	{
+		Object a;
+		TOGO_ASSERTE(read_text_string(a,
+			"x = Entry:primary:uncertain{\n"
+			"\trange = 2016-01-02T03:04:05Z - 2016-01-02T04:00:00Z\n"
+			"\tactions = {\n"
+			"\t\tWork{\"note\", n = 42}\n"
+			"\t\tEat:home[3.25kg]\n"
+			"\t\tcost = \xC2\xA4" "12.50usd, qty = 3\n"
+			"\t\tRead{at = 08:30, d = {z = 1 + 2 * x}}\n"
+			"\t}\n"
+			"\tdesc = ```text\nfree-form```\n"
+			"\tok = true, missing = null, s = \"a long string value\"\n"
+			"}\n"
+			"y = \"long repeated string\", z = \"long repeated string\"\n"
+		));
+
+		FrozenObjectDocument doc;
+		freeze(doc, a);
+		auto const& root = object::root(doc);
+		check_equal(root, a);
+		TOGO_ASSERTE(num_objects(doc) > 20);
+		TOGO_ASSERTE(size(doc) >= num_objects(doc) * sizeof(FrozenObject));
+
+		// Blocks are contiguous and strings are shared
+		auto const x = find_child(root, "x");
+		TOGO_ASSERTE(x && x == &children(root)[0]);
+		TOGO_ASSERTE(find_child(root, object::hash_name("z")) == &children(root)[2]);
+		TOGO_ASSERTE(!find_child(root, "w"));
+		TOGO_ASSERTE(find_tag(*x, "uncertain") == &tags(*x)[1]);
+		TOGO_ASSERTE(object::string(children(root)[1]).data == object::string(children(root)[2]).data);
+		TOGO_ASSERTE(string::compare_equal(identifier(*x), "Entry"));
+		auto const actions = find_child(*x, "actions");
+		TOGO_ASSERTE(actions && children(*actions).size() == 5);
+		auto const eat = &children(*actions)[1];
+		TOGO_ASSERTE(has_quantity(*eat));
+		TOGO_ASSERTE(string::compare_equal(unit(*quantity(*eat)), "kg"));
+		auto const d = find_child(children(*actions)[4], "d");
+		auto const z = find_child(*d, "z");
+		TOGO_ASSERTE(is_expression(*z) && expression(*z).size() == 3);
+		TOGO_ASSERTE(op(expression(*z)[2]) == ObjectOperator::mul);
+
+		// Frozen documents stand alone
+		clear(a);
+		TOGO_ASSERTE(string::compare_equal(object::string(*find_child(*x, "s")), "a long string value"));
+
+		freeze(doc, a);
+		TOGO_ASSERTE(num_objects(doc) == 1 && is_null(object::root(doc)));
+		clear(doc);
+		TOGO_ASSERTE(num_objects(doc) == 0);
+	}
+
+	{
+		ObjectDocument odoc;
+		TOGO_ASSERTE(read_text_string(odoc.root, "a = 1m, b = 2m, c{d = x}"));
+		FrozenObjectDocument doc;
+		freeze(doc, odoc.root);
+		check_equal(object::root(doc), odoc.root);
+	}
+	return 0;
+}
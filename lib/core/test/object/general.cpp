@@ -1,11 +1,16 @@
 
 #include <togo/core/error/assert.hpp>
 #include <togo/core/string/string.hpp>
+#include <togo/core/utility/utility.hpp>
+#include <togo/core/collection/array.hpp>
 #include <togo/support/test.hpp>
 
 #include <quanta/core/chrono/time.hpp>
 #include <quanta/core/object/object.hpp>
 
+#include <thread>
+#include <cstdio>
+
 using namespace quanta;
 
 signed main() {
@@ -126,6 +131,164 @@ signed main() {
 		TOGO_ASSERTE(&t == find_tag(a, "leftover"));
 	}
 
+	{
+		Object a;
+		char name[8];
+		for (unsigned i = 0; i < 40; ++i) {
+			StringRef const ref{name, static_cast<unsigned>(
+				std::snprintf(name, sizeof(name), "c%u", i)
+			)};
+			set_name(push_back_sub(children(a), a), ref);
+			set_name(push_back_sub(tags(a), a), ref);
+		}
+		auto& c = children(a);
+		TOGO_ASSERTE(find_child(a, "c0") == &c[0]);
+		TOGO_ASSERTE(find_child(a, "c39") == &c[39]);
+		TOGO_ASSERTE(find_tag(a, "c39") == &tags(a)[39]);
+		TOGO_ASSERTE(!find_child(a, "c40") && !find_child(a, ""));
+
+		// Appended objects are found, the first of duplicates wins
+		set_name(push_back_sub(c, a), "c40");
+		set_name(push_back_sub(c, a), "c0");
+		TOGO_ASSERTE(find_child(a, "c40") == &c[40]);
+		TOGO_ASSERTE(find_child(a, object::hash_name("c0")) == &c[0]);
+
+		array::remove(c, 0);
+		clear_indexes(a);
+		TOGO_ASSERTE(find_child(a, "c0") == &c[40]);
+		set_name(children(a)[0], "renamed");
+		TOGO_ASSERTE(find_child(a, "renamed") == &c[0] && !find_child(a, "c1"));
+
+		// Objects named or renamed through the collection or a lookup
+		// result after the index was built are found
+		push_back_sub(c, a);
+		TOGO_ASSERTE(!find_child(a, "late"));
+		set_name(children(a)[41], "late");
+		TOGO_ASSERTE(find_child(a, "late") == &c[41]);
+		set_name(*find_child(a, "c20"), "c20_renamed");
+		TOGO_ASSERTE(!find_child(a, "c20"));
+		TOGO_ASSERTE(find_child(a, "c20_renamed") == &c[19]);
+
+		// Const lookups do not build an index
+		Object const& ca = a;
+		clear_indexes(a);
+		TOGO_ASSERTE(find_child(ca, "c30") == &c[29] && !a.extra->children_index);
+		TOGO_ASSERTE(find_child(a, "c30") == &c[29] && a.extra->children_index);
+		TOGO_ASSERTE(find_child(ca, "late") == &c[41]);
+
+		Object b{a};
+		TOGO_ASSERTE(find_child(b, "c21") == &children(b)[20]);
+		clear_children(a);
+		TOGO_ASSERTE(!find_child(a, "c20"));
+		clear_tags(a);
+		TOGO_ASSERTE(!find_tag(a, "c20"));
+	}
+
+	{
+		Object a;
+		char name[8];
+		for (unsigned i = 0; i < 1000; ++i) {
+			StringRef const ref{name, static_cast<unsigned>(
+				std::snprintf(name, sizeof(name), "c%u", i)
+			)};
+			set_name(push_back_sub(children(a), a), ref);
+		}
+		TOGO_ASSERTE(!find_child(a, "absent") && !a.extra->children_index->dirty);
+
+		// Misses in an up-to-date index are final and do not search the
+		// children; this rename bypasses the index through the member
+		set_name(a.children[500], "absent");
+		TOGO_ASSERTE(!find_child(a, "absent"));
+		TOGO_ASSERTE(!find_child(static_cast<Object const&>(a), "absent"));
+		TOGO_ASSERTE(!a.extra->children_index->dirty);
+
+		// A non-const lookup result marks the index out of date, so the
+		// next miss rebuilds it
+		TOGO_ASSERTE(find_child(a, "c999") == &a.children[999]);
+		TOGO_ASSERTE(a.extra->children_index->dirty);
+		TOGO_ASSERTE(find_child(a, "absent") == &a.children[500]);
+		TOGO_ASSERTE(!find_child(a, "c500"));
+		TOGO_ASSERTE(!a.extra->children_index->dirty);
+	}
+
+	{
+		Object a;
+		TOGO_ASSERTE(read_text_string(a, "x = \"a long string value\":t{y = 1 + 2}", true));
+		set_integer(make_quantity(a), 2);
+		auto const data = unmanaged_string::data(a.value.string.value);
+		auto const x = &children(a)[0];
+
+		// Move-assignment takes the data
+		Object b;
+		set_integer(b, 1);
+		b = rvalue_ref(a);
+		TOGO_ASSERTE(is_null(a) && !has_children(a) && !has_tags(a) && !is_named(a));
+		TOGO_ASSERTE(unmanaged_string::data(b.value.string.value) == data);
+		TOGO_ASSERTE(&children(b)[0] == x);
+		TOGO_ASSERTE(has_quantity(b) && integer(*quantity(b)) == 2);
+
+		// Child into parent
+		b = rvalue_ref(children(b)[0]);
+		TOGO_ASSERTE(string::compare_equal(name(b), "y"));
+		TOGO_ASSERTE(is_expression(b) && array::size(expression(b)) == 2);
+
+		// Copy of a temporary moves with the same allocator
+		Object c;
+		set_string(c, "another long string value");
+		auto const c_data = unmanaged_string::data(c.value.string.value);
+		Object d;
+		copy(d, rvalue_ref(c));
+		TOGO_ASSERTE(is_null(c) && unmanaged_string::data(d.value.string.value) == c_data);
+
+		ObjectDocument doc;
+		copy(doc.root, rvalue_ref(d));
+		TOGO_ASSERTE(is_null(d) && doc.root.allocator == &doc.arena);
+		TOGO_ASSERTE(string::compare_equal(object::string(doc.root), "another long string value"));
+	}
+
+	{
+		Object a;
+		TOGO_ASSERTE(read_text_string(a, "x = {y = {z = 1}, w = 2}, v = 3"));
+		auto const x_children = array::begin(object::children(children(a)[0]));
+
+		// Children are shared until changed
+		Object b;
+		copy_shared(b, a);
+		Object const& cb = b;
+		Object const& ca = a;
+		TOGO_ASSERTE(has_shared_children(a) && has_shared_children(b));
+		TOGO_ASSERTE(&children(ca) == &children(cb));
+		TOGO_ASSERTE(find_child(cb, "v") == &children(ca)[1]);
+
+		// Failed lookups do not copy
+		TOGO_ASSERTE(!find_child(b, "none") && has_shared_children(b));
+
+		// Changing b copies one level at a time
+		auto x = find_child(b, "x");
+		TOGO_ASSERTE(!has_shared_children(b) && has_shared_children(a));
+		TOGO_ASSERTE(x == &children(cb)[0] && x != &children(ca)[0]);
+		TOGO_ASSERTE(has_shared_children(*x));
+		set_integer(*find_child(*x, "w"), 4);
+		TOGO_ASSERTE(integer(*find_child(children(ca)[0], "w")) == 2);
+		TOGO_ASSERTE(integer(*find_child(*x, "w")) == 4);
+
+		// The last reference takes the children back without copying
+		clear(b);
+		TOGO_ASSERTE(has_shared_children(a));
+		auto& a_x = children(a)[0];
+		TOGO_ASSERTE(!has_shared_children(a));
+		TOGO_ASSERTE(array::begin(children(a_x)) == x_children);
+		TOGO_ASSERTE(integer(*find_child(a_x, "w")) == 2);
+
+		// Deep copies of objects with shared children
+		Object c;
+		copy_shared(c, a);
+		Object d{c};
+		TOGO_ASSERTE(!has_shared_children(d));
+		TOGO_ASSERTE(integer(*find_child(children(d)[0], "w")) == 2);
+		TOGO_ASSERTE(integer(*find_child(d, "v")) == 3);
+	}
+
 	{
 		Time wow{};
 		// treated as local when resolve_time() is called (from unzoned to -04:00)
@@ -187,5 +350,192 @@ signed main() {
 		set_op(e2, ObjectOperator::div);
 		TOGO_ASSERTE(op(e2) == ObjectOperator::div);
 	}
+
+	{
+		// Operands, tags and quantity are allocated on first use
+		Object a;
+		Object const& ca = a;
+		set_integer(a, 1, "g");
+		push_back_inplace(children(a));
+		TOGO_ASSERTE(!a.extra);
+		TOGO_ASSERTE(!has_tags(a) && array::empty(tags(ca)));
+		TOGO_ASSERTE(!has_quantity(a) && !quantity(ca));
+		TOGO_ASSERTE(!find_tag(a, "x"));
+		TOGO_ASSERTE(!a.extra);
+
+		set_name(push_back_sub(tags(a), a), "x");
+		TOGO_ASSERTE(a.extra && has_tags(a) && find_tag(a, "x"));
+		set_integer(make_quantity(a), 2);
+		TOGO_ASSERTE(integer(*quantity(ca)) == 2);
+
+		Object b{a};
+		TOGO_ASSERTE(b.extra && has_tags(b) && has_quantity(b));
+		Object c{rvalue_ref(b)};
+		TOGO_ASSERTE(!b.extra && c.extra && has_tags(c) && has_quantity(c));
+
+		Object d;
+		copy(d, children(a)[0]);
+		TOGO_ASSERTE(!d.extra);
+		set_expression(d);
+		TOGO_ASSERTE(!has_operands(d) && array::empty(expression(static_cast<Object const&>(d))));
+		TOGO_ASSERTE(!d.extra);
+	}
+
+	{
+		ObjectDocument doc;
+		TOGO_ASSERTE(&allocator(doc.root) == &doc.arena);
+		ObjectParserInfo pinfo{};
+		TOGO_ASSERTE(read_text_string(
+			doc, "a = x{b = 1m}; c = \"s\":t(y); d = 1 + 2; e[4kg]; f = 2.5; _ = 1",
+			pinfo
+		));
+		TOGO_ASSERTE(array::size(children(doc.root)) == 6);
+		TOGO_ASSERTE(doc.arena.num_allocations() > 0);
+		auto& a = children(doc.root)[0];
+		TOGO_ASSERTE(&allocator(a) == &doc.arena);
+		TOGO_ASSERTE(&allocator(children(a)[0]) == &doc.arena);
+		TOGO_ASSERTE(&allocator(tags(children(doc.root)[1])[0]) == &doc.arena);
+		TOGO_ASSERTE(&allocator(expression(children(doc.root)[2])[1]) == &doc.arena);
+		TOGO_ASSERTE(&allocator(*quantity(children(doc.root)[3])) == &doc.arena);
+		TOGO_ASSERTE(string::compare_equal(unit(children(a)[0]), "m"));
+
+		// Copies take the destination's allocator
+		Object b;
+		copy(b, doc.root);
+		TOGO_ASSERTE(&allocator(children(b)[0]) == &memory::default_allocator());
+		TOGO_ASSERTE(&allocator(*quantity(children(b)[3])) == &memory::default_allocator());
+		TOGO_ASSERTE(!interned(b));
+		auto& c = push_back_sub(children(doc.root), doc.root);
+		copy(c, b);
+		TOGO_ASSERTE(&allocator(children(children(c)[0])[0]) == &doc.arena);
+		TOGO_ASSERTE(interned(children(children(c)[0])[0]));
+
+		// Equal names, units, identifiers and string types are pooled once
+		auto& a_copy = children(c)[0];
+		TOGO_ASSERTE(interned(a) && interned(a_copy));
+		TOGO_ASSERTE(object::interned_equal(a.name, a_copy.name));
+		TOGO_ASSERTE(object::interned_equal(
+			children(a)[0].value.numeric.unit, children(a_copy)[0].value.numeric.unit
+		));
+		TOGO_ASSERTE(object::interned_equal(a.value.identifier, a_copy.value.identifier));
+		TOGO_ASSERTE(!object::interned_equal(a.name, a.value.identifier));
+		u32 const num_pooled = doc.arena._strings_size;
+		auto& x = push_back_sub(children(doc.root), doc.root);
+		set_name(x, "x");
+		set_string(x, "t");
+		set_string_type(x, "m");
+		auto const& x_a = children(doc.root)[0];
+		TOGO_ASSERTE(doc.arena._strings_size == num_pooled);
+		TOGO_ASSERTE(object::interned_equal(x.name, x_a.value.identifier));
+		TOGO_ASSERTE(object::interned_equal(x.value.string.type, children(x_a)[0].value.numeric.unit));
+		TOGO_ASSERTE(x.value.string.type.hash == unit_hash(children(x_a)[0]));
+		set_identifier(x, "short");
+		TOGO_ASSERTE(doc.arena._strings_size == num_pooled + 1);
+		TOGO_ASSERTE(string::compare_equal(identifier(x), "short"));
+		TOGO_ASSERTE(identifier_hash(x) == object::hash_value("short"));
+		TOGO_ASSERTE(
+			intern(doc.arena, "x", object::hash_name("x")).data ==
+			intern(doc.arena, "x", object::hash_value("x")).data
+		);
+
+		// Long ones also share storage
+		StringRef const long_x{"long_identifier_x"};
+		StringRef const long_m{"long_unit_name_m"};
+		push_back_sub(children(doc.root), doc.root);
+		push_back_sub(children(doc.root), doc.root);
+		push_back_sub(children(doc.root), doc.root);
+		unsigned const size = array::size(children(doc.root));
+		auto& d = children(doc.root)[size - 3];
+		auto& e = children(doc.root)[size - 2];
+		auto& f = children(doc.root)[size - 1];
+		set_name(d, long_x);
+		set_string(d, long_x);
+		set_string_type(d, long_m);
+		set_name(e, long_x);
+		set_integer(e, 1, long_m);
+		TOGO_ASSERTE(interned(d) && interned(e));
+		TOGO_ASSERTE(unmanaged_string::data(d.name) == unmanaged_string::data(e.name));
+		TOGO_ASSERTE(unmanaged_string::data(d.name) != long_x.data);
+		TOGO_ASSERTE(unmanaged_string::data(d.value.string.type) == unmanaged_string::data(e.value.numeric.unit));
+		TOGO_ASSERTE(unmanaged_string::data(d.value.string.value) != unmanaged_string::data(d.name));
+		TOGO_ASSERTE(string_type_hash(d) == unit_hash(e));
+		TOGO_ASSERTE(string::compare_equal(unit(e), long_m));
+		set_identifier(e, "s");
+		TOGO_ASSERTE(string::compare_equal(identifier(e), "s"));
+		TOGO_ASSERTE(identifier_hash(e) == object::hash_value("s"));
+		copy(f, d);
+		TOGO_ASSERTE(unmanaged_string::data(f.name) == unmanaged_string::data(d.name));
+		Object g;
+		copy(g, d);
+		TOGO_ASSERTE(!interned(g));
+		TOGO_ASSERTE(unmanaged_string::data(g.name) != unmanaged_string::data(d.name));
+		TOGO_ASSERTE(string::compare_equal(name(g), long_x));
+
+		clear(doc);
+		TOGO_ASSERTE(!has_children(doc.root));
+		TOGO_ASSERTE(doc.arena.num_allocations() == 0);
+		TOGO_ASSERTE(read_text_string(doc, "x = 1", pinfo));
+		TOGO_ASSERTE(integer(children(doc.root)[0]) == 1);
+	}
+
+	// Node pool
+	{
+		object::pool_trim();
+		auto const before = object::pool_stats();
+		TOGO_ASSERTE(before.num_free == 0);
+		{
+			Object a;
+			make_quantity(a);
+			set_integer(*quantity(a), 1);
+			push_back_sub(tags(a), a);
+		}
+		auto stats = object::pool_stats();
+		TOGO_ASSERTE(stats.misses == before.misses + 2);
+		TOGO_ASSERTE(stats.num_free == 2);
+		{
+			Object b;
+			make_quantity(b);
+			release_quantity(b);
+			make_quantity(b);
+		}
+		stats = object::pool_stats();
+		TOGO_ASSERTE(stats.hits == before.hits + 3);
+		TOGO_ASSERTE(stats.misses == before.misses + 2);
+		TOGO_ASSERTE(stats.num_free == 2);
+
+		// Arena allocations bypass the pool
+		ObjectDocument doc;
+		make_quantity(doc.root);
+		clear(doc);
+		TOGO_ASSERTE(object::pool_stats().hits == stats.hits);
+		TOGO_ASSERTE(object::pool_stats().misses == stats.misses);
+
+		object::pool_trim();
+		TOGO_ASSERTE(object::pool_stats().num_free == 0);
+	}
+
+	// Pool shutdown ordering: pooled nodes hold default allocator memory
+	// until trimmed, so the main thread trims before memory::shutdown()
+	// and other threads free theirs when they exit
+	{
+		auto& allocator = memory::default_allocator();
+		u32 const num_allocations = allocator.num_allocations();
+		{
+			Object a;
+			make_quantity(a);
+			push_back_sub(tags(a), a);
+		}
+		TOGO_ASSERTE(allocator.num_allocations() > num_allocations);
+		object::pool_trim();
+		TOGO_ASSERTE(allocator.num_allocations() == num_allocations);
+
+		std::thread worker{[]() {
+			Object a;
+			make_quantity(a);
+			push_back_sub(tags(a), a);
+		}};
+		worker.join();
+		TOGO_ASSERTE(allocator.num_allocations() == num_allocations);
+	}
 	return 0;
 }
@@ -0,0 +1,188 @@
+
+#include <togo/core/error/assert.hpp>
+#include <togo/core/collection/array.hpp>
+#include <togo/core/string/string.hpp>
+#include <togo/core/io/io.hpp>
+#include <togo/core/io/memory_stream.hpp>
+
+#include <quanta/core/object/object.hpp>
+
+#include <togo/support/test.hpp>
+
+#include <cstdio>
+
+using namespace quanta;
+
+static StringRef const data{
+	"x = Entry:primary:uncertain{\n"
+	"\trange = 2016-01-02T03:04:05Z - 2016-01-02T04:00:00Z\n"
+	"\tactions = {\n"
+	"\t\tWork{\"note\", n = 42}\n"
+	"\t\tEat:home[3.25kg]\n"
+	"\t\tcost = \xC2\xA4" "12.50usd, qty = -3\n"
+	"\t\tRead{at = 08:30, on = 2016-01-02, d = {z = 1 + 2 * x}}\n"
+	"\t}\n"
+	"\tdesc = ```text\nfree-form```\n"
+	"\tok = true, missing = null, e = 1.5e-3, s = \"a long string value\"\n"
+	"\t?~x, G~~z, q = ?~3[?5]\n"
+	"}\n"
+	"y = \"long repeated string\", z = \"long repeated string\"\n"
+};
+
+static StringRef stream_data(MemoryStream& stream) {
+	return {
+		reinterpret_cast<char*>(array::begin(stream.data())),
+		static_cast<unsigned>(stream.size())
+	};
+}
+
+static void check_same(Object const& a, Object const& b) {
+	MemoryStream a_stream{memory::default_allocator(), 1024};
+	MemoryStream b_stream{memory::default_allocator(), 1024};
+	TOGO_ASSERTE(object::write_text(a, a_stream));
+	TOGO_ASSERTE(object::write_text(b, b_stream));
+	TOGO_ASSERTE(string::compare_equal(stream_data(a_stream), stream_data(b_stream)));
+}
+
+static void check_source_lines(Object const& a, Object const& b) {
+	TOGO_ASSERTE(object::source_line(a) == object::source_line(b));
+	TOGO_ASSERTE(array::size(object::children(a)) == array::size(object::children(b)));
+	for (unsigned i = 0; i < array::size(object::children(a)); ++i) {
+		check_source_lines(object::children(a)[i], object::children(b)[i]);
+	}
+}
+
+struct MaxSizeAllocator : Allocator {
+	u32 num = 0;
+	u32 max_size = 0;
+
+	u32 num_allocations() const override { return num; }
+	u32 total_size() const override { return 0; }
+	void* allocate(u32 size, u32 align = DEFAULT_ALIGNMENT) override {
+		++num;
+		max_size = max(max_size, size);
+		return memory::default_allocator().allocate(size, align);
+	}
+	void deallocate(void* p) override {
+		if (p) {
+			--num;
+			memory::default_allocator().deallocate(p);
+		}
+	}
+};
+
+signed main() {
+	memory_init();
+
+	Object a;
+	TOGO_ASSERTE(object::read_text_string(a, data));
+
+	MemoryStream stream{memory::default_allocator(), 4096};
+	TOGO_ASSERTE(object::write_binary(a, stream));
+
+	// Thawed
+	{
+		stream.seek_to(0);
+		Object b;
+		object::set_integer(b, 1);
+		TOGO_ASSERTE(object::read_binary(b, stream));
+		check_same(a, b);
+		check_source_lines(a, b);
+	}
+
+	// Frozen
+	{
+		stream.seek_to(0);
+		FrozenObjectDocument doc;
+		TOGO_ASSERTE(object::read_binary(doc, stream));
+		FrozenObjectDocument expected;
+		object::freeze(expected, a);
+		TOGO_ASSERTE(object::num_objects(doc) == object::num_objects(expected));
+		TOGO_ASSERTE(object::size(doc) == object::size(expected));
+		auto const x = object::find_child(object::root(doc), "x");
+		TOGO_ASSERTE(x && object::find_tag(*x, "uncertain"));
+		TOGO_ASSERTE(string::compare_equal(object::string(*object::find_child(*x, "s")), "a long string value"));
+
+		// Frozen document writes the same data
+		MemoryStream out_stream{memory::default_allocator(), 4096};
+		TOGO_ASSERTE(object::write_binary(doc, out_stream));
+		TOGO_ASSERTE(string::compare_equal(stream_data(stream), stream_data(out_stream)));
+	}
+
+	// Invalid data
+	{
+		FrozenObjectDocument doc;
+		MemoryReader empty_stream{""};
+		TOGO_ASSERTE(!object::read_binary(doc, empty_stream));
+
+		MemoryStream bad_stream{memory::default_allocator(), 4096};
+		TOGO_ASSERTE(object::write_binary(a, bad_stream));
+		array::begin(bad_stream.data())[0] = 'X';
+		bad_stream.seek_to(0);
+		TOGO_ASSERTE(!object::read_binary(doc, bad_stream));
+		TOGO_ASSERTE(object::num_objects(doc) == 0);
+
+		// Truncated
+		bad_stream.clear();
+		TOGO_ASSERTE(object::write_binary(a, bad_stream));
+		array::resize(bad_stream.data(), array::size(bad_stream.data()) - 1);
+		bad_stream.seek_to(0);
+		TOGO_ASSERTE(!object::read_binary(doc, bad_stream));
+		TOGO_ASSERTE(object::num_objects(doc) == 0);
+
+		// A huge size in the header does not allocate it up front
+		bad_stream.clear();
+		TOGO_ASSERTE(object::write_binary(a, bad_stream));
+		u32 const bogus_size = 0xFFFFFF00u;
+		// BinaryHeader::size follows magic, version, object_size and num_objects
+		std::memcpy(array::begin(bad_stream.data()) + 16, &bogus_size, sizeof(bogus_size));
+		bad_stream.seek_to(0);
+		MaxSizeAllocator allocator;
+		{
+			FrozenObjectDocument bogus_doc{allocator};
+			TOGO_ASSERTE(!object::read_binary(bogus_doc, bad_stream));
+			TOGO_ASSERTE(object::num_objects(bogus_doc) == 0);
+		}
+		TOGO_ASSERTE(allocator.max_size > 0 && allocator.max_size <= 1024 * 1024);
+		TOGO_ASSERTE(allocator.num == 0);
+	}
+
+	// Empty
+	{
+		Object empty;
+		MemoryStream empty_stream{memory::default_allocator(), 128};
+		TOGO_ASSERTE(object::write_binary(empty, empty_stream));
+		empty_stream.seek_to(0);
+		Object b;
+		TOGO_ASSERTE(object::read_binary(b, empty_stream));
+		TOGO_ASSERTE(object::is_null(b) && !object::has_children(b));
+	}
+
+	// File
+	{
+		StringRef const path{"io_binary_test.qbin"};
+		TOGO_ASSERTE(object::write_binary_file(a, path));
+		FrozenObjectDocument doc;
+		TOGO_ASSERTE(object::read_binary_file(doc, path));
+	#if defined(TOGO_PLATFORM_IS_POSIX)
+		TOGO_ASSERTE(doc._mapping);
+	#endif
+		auto const x = object::find_child(object::root(doc), "x");
+		TOGO_ASSERTE(x && object::find_child(*x, "actions"));
+
+		Object b;
+		TOGO_ASSERTE(object::read_binary_file(b, path));
+		check_same(a, b);
+		object::clear(doc);
+		std::remove(path.data);
+		TOGO_ASSERTE(!object::read_binary_file(b, path));
+
+		// Shorter than a header
+		std::FILE* const file = std::fopen(path.data, "wb");
+		TOGO_ASSERTE(file && std::fwrite("QOBJ", 1, 4, file) == 4);
+		std::fclose(file);
+		TOGO_ASSERTE(!object::read_binary_file(doc, path));
+		std::remove(path.data);
+	}
+	return 0;
+}
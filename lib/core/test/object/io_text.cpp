@@ -11,6 +11,15 @@
 
 #include <togo/support/test.hpp>
 
+#include <cstdlib>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	#include <sys/stat.h>
+#endif
+
 using namespace quanta;
 
 #define M_TSN(d)	{true, false, d, {}},
@@ -39,6 +48,9 @@ struct Test {
 	TSN(" ")
 	TSN("\n")
 	TSN(" \t\n")
+	TSN("\r\n")
+	M_TSE("x\r\ny", "x\ny")
+	S_TF("x\r\ny")
 
 // comments
 	TF("\\")
@@ -115,6 +127,10 @@ struct Test {
 	TSE(" 1",  "1")
 	TSE("+1",  "1")
 	TSE("-1", "-1")
+	TSS("0")
+	TSS("10")
+	TSS("1234567890123")
+	TSS("-9223372036854775807")
 
 	TSE("+.1",  "0.1")
 	TSE("-.1", "-0.1")
@@ -135,6 +151,9 @@ struct Test {
 	TSE("+1.1e-1",  "0.11")
 	TSE("-1.1e-1", "-0.11")
 
+	TSE("3.14159265", "3.14159")
+	TSE("1e100", "1e+100")
+
 // units
 	TSS("1a")
 	TSS("1µg")
@@ -163,6 +182,22 @@ struct Test {
 	TSS("¤4.23usd")
 	TSS("¤480yen")
 	TSS("¤-124.12eur")
+	TSS("¤9223372036854775807x")
+	TSS("¤-922337203685477.5807x")
+	TSE("¤00000000000000000000001x", "¤1x")
+	TSS("¤1.1234567890x")
+	TSS("¤-1.12345678901x")
+	TSS("¤12.000000000001x")
+	TSS("¤0.0000000000001x")
+	TSS("¤12345.12345678901234x")
+	TSS("¤-1.123456789012345x")
+	TSS("¤0.1234567890123456x")
+	TSS("¤9.22337203685477580x")
+	TSS("¤-0.922337203685477580x")
+	TSS("¤0.9223372036854775807x")
+	TF("¤9223372036854775808x")
+	TF("¤12345678901234567890x")
+	TF("¤1234567890.1234567890x")
 
 // times
 	TF("2-")
@@ -252,6 +287,23 @@ struct Test {
 	TSS("02T03:04:05")
 	TSE("02T03:04", "02T03:04:00")
 
+	TSS("2015-01-02T03:04:05Z")
+	TSE("2015-01-02T03:04Z", "2015-01-02T03:04:00Z")
+	TSS("2015-01-02T03:04:05+04:05")
+	TSS("2015-01-02T03:04:05-04:05")
+	TSE("2015-01-02T03:04-04:05", "2015-01-02T03:04:00-04:05")
+	TSS("2015-01-02T03:04:05-04")
+	TSS("01:02:03:t")
+	TSE("x = 01:02:t", "x = 01:02:00:t")
+	TSE("{2015-01-02T03:04:05}", "{\n\t2015-01-02T03:04:05\n}")
+	M_TSE("x = 2015-01-02T03:04:05+04:05, y = 01:02\r\n", "x = 2015-01-02T03:04:05+04:05\ny = 01:02:00")
+
+	TF("2015-01-02T03:04:05x")
+	TF("2015-01-02T03:04:05.1")
+	TF("2015-01-02T03:04:0")
+	TF("2015-01-02+04:05")
+	TF("2015-01-02T03:04:05+04:0")
+
 // strings
 	TSE("\"\"", "\"\"")
 	TSS("\"a\"")
@@ -260,10 +312,17 @@ struct Test {
 	TSE("```a b```", "\"a b\"")
 	TSE("```a\"b```", "```a\"b```")
 	TSE("```\na\n```", "```\na\n```")
+	TSE("```\r\na\r\n```", "```\na\n```")
 
 	TSE("\"\\t\"", "\"\t\"")
 	TSE("\"\\n\"", "```\n```")
 
+	// long strings (vector scan and tail)
+	TSS("\"0123456789abcdef0123456789abcdef0123456789\"")
+	TSS("```0123456789abcdef0123456789abcdef\"123456789```")
+	TSS("```0123456789abcdef0123456789abcdef0123456789\n```")
+	TSS("```0123456789abcdef0123456789abcdef012345678\"```")
+
 	TSS("G\"\"")
 	TSS("type\"\"")
 	TSE("type``````", "type\"\"")
@@ -427,7 +486,14 @@ void check(Test const& test) {
 	Object root;
 	MemoryReader in_stream{test.data};
 	ObjectParserInfo pinfo;
-	if (object::read_text(root, in_stream, pinfo, test.single_value)) {
+	bool const success = object::read_text(root, in_stream, pinfo, test.single_value);
+	{
+		Object root_in_place;
+		ObjectParserInfo pinfo_in_place;
+		TOGO_ASSERTE(success == object::read_text_string(root_in_place, test.data, pinfo_in_place, test.single_value));
+		TOGO_ASSERTE(pinfo.line == pinfo_in_place.line && pinfo.column == pinfo_in_place.column);
+	}
+	if (success) {
 		MemoryStream out_stream{memory::default_allocator(), test.expected_output.size + 1};
 		TOGO_ASSERTE(object::write_text(root, out_stream, test.single_value));
 		StringRef output{
@@ -448,6 +514,24 @@ void check(Test const& test) {
 			),
 			"output does not match"
 		);
+
+		// Compact output reads back to the same objects
+		MemoryStream compact_stream{memory::default_allocator(), output.size + 1};
+		TOGO_ASSERTE(object::write_text(root, compact_stream, test.single_value, ObjectTextFormat::compact));
+		StringRef const compact_output{
+			reinterpret_cast<char*>(array::begin(compact_stream.data())),
+			static_cast<unsigned>(compact_stream.size())
+		};
+		TOGO_ASSERTE(compact_output.size <= output.size);
+		Object compact_root;
+		TOGO_ASSERTE(object::read_text_string(compact_root, compact_output, pinfo, test.single_value));
+		MemoryStream readable_stream{memory::default_allocator(), output.size + 1};
+		TOGO_ASSERTE(object::write_text(compact_root, readable_stream, test.single_value));
+		TOGO_ASSERT(
+			readable_stream.size() == output.size &&
+			std::memcmp(array::begin(readable_stream.data()), output.data, output.size) == 0,
+			"compact output does not read back the same"
+		);
 	} else {
 		TOGO_LOGF(
 			"failed to read%s: [%2u,%2u]: %s\n",
@@ -461,6 +545,573 @@ void check(Test const& test) {
 	TOGO_LOG("\n");
 }
 
+struct CountingVisitor : IObjectVisitor {
+	unsigned depth = 0;
+	unsigned num_objects = 0;
+	unsigned num_top = 0;
+	unsigned num_tags = 0;
+	unsigned num_operands = 0;
+	unsigned num_wraps = 0;
+	unsigned max_depth = 0;
+	unsigned stop_at = ~0u;
+	s64 sum = 0;
+	char top_names[4]{};
+
+	bool begin_object(ObjectVisitKind kind, unsigned) override {
+		++num_objects;
+		max_depth = max(max_depth, ++depth);
+		if (depth == 1 && ++num_top == stop_at) {
+			return false;
+		}
+		num_tags += kind == ObjectVisitKind::tag;
+		num_operands += kind == ObjectVisitKind::operand;
+		return true;
+	}
+
+	bool end_object() override {
+		--depth;
+		return true;
+	}
+
+	bool wrap(ObjectVisitWrap, unsigned) override {
+		++num_wraps;
+		++depth;
+		return true;
+	}
+
+	bool name(StringRef name) override {
+		if (depth == 1 && num_top <= 4) {
+			top_names[num_top - 1] = name.data[0];
+		}
+		return true;
+	}
+
+	bool value(ObjectVisitValue const& value) override {
+		if (value.type == ObjectValueType::integer) {
+			sum += value.integer;
+		}
+		return true;
+	}
+};
+
+// Records events as text
+struct RecordingVisitor : IObjectVisitor {
+	char log[1024];
+	unsigned size = 0;
+
+	void add(char const* format, ...) {
+		va_list va;
+		va_start(va, format);
+		size += std::vsnprintf(log + size, sizeof(log) - size, format, va);
+		va_end(va);
+		TOGO_ASSERTE(size < sizeof(log));
+	}
+
+	StringRef ref() const {
+		return {log, size};
+	}
+
+	bool begin_object(ObjectVisitKind kind, unsigned line) override {
+		add("{%u@%u ", unsigned_cast(kind), line);
+		return true;
+	}
+
+	bool end_object() override {
+		add("} ");
+		return true;
+	}
+
+	bool wrap(ObjectVisitWrap wrap, unsigned line) override {
+		add("wrap%u@%u ", unsigned_cast(wrap), line);
+		return true;
+	}
+
+	bool name(StringRef name) override {
+		add("%.*s= ", name.size, name.data);
+		return true;
+	}
+
+	bool op(ObjectOperator op) override {
+		add("op%u ", unsigned_cast(op));
+		return true;
+	}
+
+	bool marker(ObjectValueMarker marker, signed approximation) override {
+		add("m%u/%d ", unsigned_cast(marker), approximation);
+		return true;
+	}
+
+	bool value(ObjectVisitValue const& value) override {
+		switch (value.type) {
+		case ObjectValueType::integer: add("%lld ", static_cast<long long>(value.integer)); break;
+		case ObjectValueType::string: add("%.*s\"%.*s\" ", value.string_type.size, value.string_type.data, value.string.size, value.string.data); break;
+		case ObjectValueType::identifier: add("%.*s ", value.string.size, value.string.data); break;
+		case ObjectValueType::time: add("t%lld/%u ", static_cast<long long>(value.time.value.sec), unsigned_cast(value.time.type)); break;
+		default: add("v%u ", unsigned_cast(value.type)); break;
+		}
+		return true;
+	}
+
+	bool unit(StringRef unit) override {
+		add("u%.*s ", unit.size, unit.data);
+		return true;
+	}
+
+	bool source(unsigned source, bool certain) override {
+		add("$%u/%d ", source, certain);
+		return true;
+	}
+
+	bool sub_source(unsigned sub_source, bool certain) override {
+		add("$$%u/%d ", sub_source, certain);
+		return true;
+	}
+};
+
+void check_visit() {
+	StringRef const data{"x = 1, y = {a, b:t{c}}\nz = 2 + 3"};
+	ObjectParserInfo pinfo;
+	{
+		CountingVisitor visitor;
+		TOGO_ASSERTE(object::read_text_string_visit(data, visitor, pinfo));
+		TOGO_ASSERTE(visitor.num_top == 3);
+		TOGO_ASSERTE(
+			visitor.top_names[0] == 'x' &&
+			visitor.top_names[1] == 'y' &&
+			visitor.top_names[2] == 'z'
+		);
+		// The lead operand of z is begun as z
+		TOGO_ASSERTE(visitor.num_objects == 3 + 2 + 2 + 1);
+		TOGO_ASSERTE(visitor.num_tags == 1 && visitor.num_operands == 1 && visitor.num_wraps == 1);
+		TOGO_ASSERTE(visitor.max_depth == 3 && visitor.depth == 0);
+		TOGO_ASSERTE(visitor.sum == 6);
+
+		MemoryReader in_stream{data};
+		CountingVisitor stream_visitor;
+		TOGO_ASSERTE(object::read_text_visit(in_stream, stream_visitor, pinfo));
+		TOGO_ASSERTE(stream_visitor.num_objects == visitor.num_objects);
+	}
+	{
+		CountingVisitor visitor;
+		visitor.stop_at = 2;
+		TOGO_ASSERTE(!object::read_text_string_visit(data, visitor, pinfo));
+		TOGO_ASSERTE(visitor.num_top == 2);
+	}
+	{
+		CountingVisitor visitor;
+		TOGO_ASSERTE(!object::read_text_string_visit("x = 1, y = {", visitor, pinfo));
+		TOGO_ASSERTE(visitor.num_top == 2);
+	}
+	{
+		// Parts come in document order, as from the tree read_text() builds
+		StringRef const parts_data{
+			"a = ?1kg$2$?:t(x = \"s\") {b = G~foo\"s\", c = 2012-01-02}[5]\n"
+			"d = (1 - 2)"
+		};
+		RecordingVisitor visitor;
+		TOGO_ASSERTE(object::read_text_string_visit(parts_data, visitor, pinfo));
+		TOGO_ASSERTE(string::compare_equal(visitor.ref(),
+			"{0@1 a= m0/0 1 ukg $2/1 $$0/0 {1@1 t= {0@1 x= \"s\" } } "
+			"{0@1 b= m1/0 foo\"s\" } {0@1 c= t63461059200/1 } {2@1 5 } } "
+			"{0@2 d= v256 {3@2 op0 1 } {3@2 op1 2 } } "
+		));
+
+		Object root;
+		TOGO_ASSERTE(object::read_text_string(root, parts_data));
+		RecordingVisitor tree_visitor;
+		for (auto const& child : object::children(root)) {
+			TOGO_ASSERTE(object::visit(child, tree_visitor));
+		}
+		TOGO_ASSERTE(string::compare_equal(tree_visitor.ref(), visitor.ref()));
+	}
+	{
+		// Operators and quantity collections wrap the object before them
+		RecordingVisitor visitor;
+		TOGO_ASSERTE(object::read_text_string_visit("x = 1 + 2, y[3, 4]", visitor, pinfo));
+		TOGO_ASSERTE(string::compare_equal(visitor.ref(),
+			"{0@1 x= 1 } wrap0@1 {3@1 op0 2 } } "
+			"{0@1 y {2@1 3 } wrap1@1 {0@1 4 } } } "
+		));
+	}
+}
+
+void check_resume() {
+	StringRef const data{"x = 1\r\ny = {\n\ta = \"s\"\n}, \\\\ c\nz = 2 + 3;w\n"};
+	unsigned const expected_children[]{0, 0, 0, 0, 0, 0, 0, 1};
+	Object expected;
+	TOGO_ASSERTE(object::read_text_string(expected, data));
+
+	MemoryStream expected_stream{memory::default_allocator(), 64};
+	TOGO_ASSERTE(object::write_text(expected, expected_stream));
+	StringRef const expected_output{
+		reinterpret_cast<char*>(array::begin(expected_stream.data())),
+		static_cast<unsigned>(expected_stream.size())
+	};
+
+	// Append one byte at a time
+	Object root;
+	ObjectTextCheckpoint checkpoint{};
+	ObjectParserInfo pinfo;
+	for (unsigned size = 0; size <= data.size; ++size) {
+		TOGO_ASSERTE(object::read_text_string_resume(root, StringRef{data.data, size}, checkpoint, pinfo));
+		TOGO_ASSERTE(checkpoint.offset <= size);
+		TOGO_ASSERTE(array::size(object::children(root)) == checkpoint.num_children);
+		if (size < array_extent(expected_children)) {
+			TOGO_ASSERTE(checkpoint.num_children == expected_children[size]);
+		}
+	}
+	TOGO_ASSERTE(checkpoint.offset == data.size && checkpoint.num_children == 4);
+
+	MemoryStream out_stream{memory::default_allocator(), 64};
+	TOGO_ASSERTE(object::write_text(root, out_stream));
+	TOGO_ASSERTE(string::compare_equal(
+		expected_output,
+		StringRef{
+			reinterpret_cast<char*>(array::begin(out_stream.data())),
+			static_cast<unsigned>(out_stream.size())
+		}
+	));
+
+	// Stream resume from a saved checkpoint
+	MemoryReader in_stream{data};
+	ObjectTextCheckpoint partial = checkpoint;
+	partial.offset = 0;
+	TOGO_ASSERTE(object::read_text_resume(root, in_stream, partial, pinfo));
+	TOGO_ASSERTE(partial.offset == checkpoint.offset && partial.line == checkpoint.line);
+	TOGO_ASSERTE(array::size(object::children(root)) == 4);
+
+	// Stream resume skips to a checkpoint past the start
+	partial = {};
+	TOGO_ASSERTE(object::read_text_string_resume(root, StringRef{data.data, 12}, partial, pinfo));
+	TOGO_ASSERTE(partial.offset > 0 && partial.num_children == 1);
+	MemoryReader skip_stream{data};
+	TOGO_ASSERTE(object::read_text_resume(root, skip_stream, partial, pinfo));
+	TOGO_ASSERTE(partial.offset == checkpoint.offset && partial.line == checkpoint.line);
+	TOGO_ASSERTE(array::size(object::children(root)) == 4);
+
+	// A checkpoint past the end of the stream is an error
+	MemoryReader short_stream{StringRef{data.data, 4}};
+	TOGO_ASSERTE(!object::read_text_resume(root, short_stream, partial, pinfo));
+
+	// Errors before the end of the input are still errors
+	checkpoint = {};
+	TOGO_ASSERTE(!object::read_text_string_resume(root, "x = 1\ny = }\nz", checkpoint, pinfo));
+	TOGO_ASSERTE(pinfo.line == 2 && checkpoint.num_children == 1);
+}
+
+void check_parallel() {
+	MemoryStream data_stream{memory::default_allocator(), 1024 * 1024};
+	char line[256];
+	for (unsigned i = 0; i < 8192; ++i) {
+		signed const size = std::snprintf(
+			line, sizeof(line),
+			"e%u = {a = %u, s = \"{\\\"\", b = ```}\n```}:t(%u) \\\\ {\n\\* \\* } *\\ \n *\\\n",
+			i, i * 3, i
+		);
+		io::write(data_stream, line, static_cast<unsigned>(size));
+	}
+	StringRef const data{
+		reinterpret_cast<char*>(array::begin(data_stream.data())),
+		static_cast<unsigned>(data_stream.size())
+	};
+
+	Object expected;
+	ObjectParserInfo pinfo;
+	TOGO_ASSERTE(object::read_text_string(expected, data, pinfo));
+	MemoryStream expected_stream{memory::default_allocator(), 1024 * 1024};
+	TOGO_ASSERTE(object::write_text(expected, expected_stream));
+
+	Object root;
+	TOGO_ASSERTE(object::read_text_string_parallel(root, data, pinfo, 4));
+	TOGO_ASSERTE(array::size(object::children(root)) == 8192);
+	MemoryStream out_stream{memory::default_allocator(), 1024 * 1024};
+	TOGO_ASSERTE(object::write_text(root, out_stream));
+	TOGO_ASSERTE(
+		out_stream.size() == expected_stream.size() &&
+		std::memcmp(
+			array::begin(out_stream.data()),
+			array::begin(expected_stream.data()),
+			out_stream.size()
+		) == 0
+	);
+	TOGO_ASSERTE(
+		object::source_line(array::back(object::children(root))) ==
+		object::source_line(array::back(object::children(expected)))
+	);
+
+	// Parallel write has the same output as a sequential write
+	out_stream.clear();
+	TOGO_ASSERTE(object::write_text_parallel(root, out_stream, 4));
+	TOGO_ASSERTE(
+		out_stream.size() == expected_stream.size() &&
+		std::memcmp(
+			array::begin(out_stream.data()),
+			array::begin(expected_stream.data()),
+			out_stream.size()
+		) == 0
+	);
+
+	// Likewise with compact output
+	expected_stream.clear();
+	out_stream.clear();
+	TOGO_ASSERTE(object::write_text(expected, expected_stream, false, ObjectTextFormat::compact));
+	TOGO_ASSERTE(object::write_text_parallel(root, out_stream, 4, ObjectTextFormat::compact));
+	TOGO_ASSERTE(
+		out_stream.size() == expected_stream.size() &&
+		std::memcmp(
+			array::begin(out_stream.data()),
+			array::begin(expected_stream.data()),
+			out_stream.size()
+		) == 0
+	);
+
+	// Errors have the same position as with a sequential read
+	array::back(data_stream.data()) = '}';
+	ObjectParserInfo expected_pinfo;
+	TOGO_ASSERTE(!object::read_text_string(expected, data, expected_pinfo));
+	TOGO_ASSERTE(!object::read_text_string_parallel(root, data, pinfo, 4));
+	TOGO_ASSERTE(pinfo.line == expected_pinfo.line && pinfo.column == expected_pinfo.column);
+
+	// Workers handle values larger than a small temporary buffer
+	data_stream.clear();
+	char value[6000];
+	std::memset(value, 'v', sizeof(value));
+	for (unsigned i = 0; i < 64; ++i) {
+		signed const size = std::snprintf(line, sizeof(line), "e%u = {{{{a = \"", i);
+		io::write(data_stream, line, static_cast<unsigned>(size));
+		io::write(data_stream, value, sizeof(value));
+		io::write(data_stream, "\"}}}}\n", 6);
+	}
+	StringRef const large_data{
+		reinterpret_cast<char*>(array::begin(data_stream.data())),
+		static_cast<unsigned>(data_stream.size())
+	};
+	TOGO_ASSERTE(object::read_text_string(expected, large_data, pinfo));
+	TOGO_ASSERTE(object::read_text_string_parallel(root, large_data, pinfo, 4));
+	TOGO_ASSERTE(array::size(object::children(root)) == 64);
+	expected_stream.clear();
+	out_stream.clear();
+	TOGO_ASSERTE(object::write_text(expected, expected_stream));
+	TOGO_ASSERTE(object::write_text(root, out_stream));
+	TOGO_ASSERTE(
+		out_stream.size() == expected_stream.size() &&
+		std::memcmp(
+			array::begin(out_stream.data()),
+			array::begin(expected_stream.data()),
+			out_stream.size()
+		) == 0
+	);
+}
+
+void check_update_file(StringRef const& path, Object const& obj) {
+	MemoryStream expected{memory::default_allocator(), 4096};
+	TOGO_ASSERTE(object::write_text(obj, expected, true));
+	char data[4096];
+	FILE* const file = std::fopen(path.data, "rb");
+	TOGO_ASSERTE(file);
+	std::size_t const size = std::fread(data, 1, sizeof(data), file);
+	std::fclose(file);
+	TOGO_ASSERTE(
+		size == expected.size() &&
+		std::memcmp(data, array::begin(expected.data()), size) == 0
+	);
+}
+
+// Identity of the file at path; changes when the file is replaced
+u64 file_id(StringRef const& path) {
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	struct stat st;
+	TOGO_ASSERTE(::stat(path.data, &st) == 0);
+	return static_cast<u64>(st.st_ino);
+#else
+	(void)path;
+	return 0;
+#endif
+}
+
+void check_update() {
+	StringRef const path{"io_text_update_test.q"};
+	StringRef const layout_path{"io_text_update_test.q.layout"};
+	std::remove(path.data);
+	std::remove(layout_path.data);
+	Object obj;
+	TOGO_ASSERTE(object::read_text_string(obj, "Tracker{date = 2016-01-02, entries = {}}", true));
+	auto& entries = *object::find_child(obj, "entries");
+	for (unsigned i = 0; i < 24; ++i) {
+		auto& entry = object::push_back_sub(object::children(entries), entries);
+		object::set_identifier(entry, "Entry");
+		object::set_integer(object::push_back_sub(object::children(entry), entry), i);
+	}
+
+	// First write
+	ObjectTextLayout layout;
+	TOGO_ASSERTE(object::write_text_file_update(obj, entries, path, layout, true));
+	TOGO_ASSERTE(array::size(layout.records) == 24);
+	check_update_file(path, obj);
+
+	// Append and change the last record
+	object::set_integer(object::children(array::back(object::children(entries)))[0], 100);
+	object::set_identifier(object::push_back_sub(object::children(entries), entries), "Entry");
+	TOGO_ASSERTE(object::write_text_file_update(obj, entries, path, layout, true));
+	TOGO_ASSERTE(array::size(layout.records) == 25);
+	check_update_file(path, obj);
+
+	// A same-size change in the middle is written in place
+	u64 const id = file_id(path);
+	u64 const size = layout.size;
+	object::set_integer(object::children(object::children(entries)[5])[0], 6);
+	TOGO_ASSERTE(object::write_text_file_update(obj, entries, path, layout, true));
+	TOGO_ASSERTE(layout.size == size && file_id(path) == id);
+	check_update_file(path, obj);
+
+	// A new layout is loaded from the layout file
+	{
+		ObjectTextLayout loaded;
+		object::set_integer(object::children(object::children(entries)[23])[0], 700);
+		TOGO_ASSERTE(object::write_text_file_update(obj, entries, path, loaded, true));
+		TOGO_ASSERTE(array::size(loaded.records) == 25 && file_id(path) == id);
+		check_update_file(path, obj);
+	}
+
+	// Remove records
+	array::resize(object::children(entries), 20);
+	TOGO_ASSERTE(object::write_text_file_update(obj, entries, path, layout, true));
+	check_update_file(path, obj);
+
+	// Change the head and the first record
+	object::set_name(array::front(object::children(obj)), "d");
+	object::set_integer(object::children(array::front(object::children(entries)))[0], -1);
+	TOGO_ASSERTE(object::write_text_file_update(obj, entries, path, layout, true));
+	check_update_file(path, obj);
+
+	// File changed since the last update
+	TOGO_ASSERTE(object::write_text_file(obj, path, false));
+	object::set_integer(object::children(array::back(object::children(entries)))[0], 200);
+	TOGO_ASSERTE(object::write_text_file_update(obj, entries, path, layout, true));
+	check_update_file(path, obj);
+
+	std::remove(path.data);
+	std::remove(layout_path.data);
+}
+
+// Whether s lies in the file mapped by doc
+bool in_mapping(ObjectDocument const& doc, StringRef const& s) {
+	char const* const begin = static_cast<char const*>(doc._mapping);
+	return begin && s.data >= begin && s.data + s.size <= begin + doc._mapping_size;
+}
+
+void check_document_file() {
+	StringRef const path{"io_text_document_test.q"};
+	StringRef const data{
+		"a = \"long string without escapes\"\n"
+		"b = \"short\"\n"
+		"c = \"long string with\\tan escape\"\n"
+		"d = ```long block\nstring```\n"
+		"e = ```long block\r\nstring with CRLF```\n"
+		"f = t\"long typed string value\"\n"
+		"g = \"\"\n"
+	};
+	FILE* const file = std::fopen(path.data, "wb");
+	TOGO_ASSERTE(file && std::fwrite(data.data, 1, data.size, file) == data.size);
+	std::fclose(file);
+
+	Object expected;
+	TOGO_ASSERTE(object::read_text_file(expected, path));
+	ObjectDocument doc;
+	TOGO_ASSERTE(object::read_text_file(doc, path));
+	MemoryStream expected_stream{memory::default_allocator(), 256};
+	MemoryStream doc_stream{memory::default_allocator(), 256};
+	TOGO_ASSERTE(object::write_text(expected, expected_stream));
+	TOGO_ASSERTE(object::write_text(doc.root, doc_stream));
+	TOGO_ASSERTE(
+		doc_stream.size() == expected_stream.size() &&
+		std::memcmp(
+			array::begin(doc_stream.data()),
+			array::begin(expected_stream.data()),
+			static_cast<unsigned>(expected_stream.size())
+		) == 0
+	);
+
+#if defined(TOGO_PLATFORM_IS_POSIX)
+	// Long strings that need no unescaping are not copied
+	TOGO_ASSERTE(doc._mapping);
+	auto const string_of = [&doc](StringRef const& name) {
+		auto const obj = object::find_child(doc.root, name);
+		TOGO_ASSERTE(obj && object::is_string(*obj));
+		return object::string(*obj);
+	};
+	TOGO_ASSERTE(in_mapping(doc, string_of("a")));
+	TOGO_ASSERTE(!in_mapping(doc, string_of("b")));
+	TOGO_ASSERTE(!in_mapping(doc, string_of("c")));
+	TOGO_ASSERTE(in_mapping(doc, string_of("d")));
+	TOGO_ASSERTE(!in_mapping(doc, string_of("e")));
+	TOGO_ASSERTE(in_mapping(doc, string_of("f")));
+	TOGO_ASSERTE(string::compare_equal(string_of("d"), "long block\nstring"));
+	TOGO_ASSERTE(string::compare_equal(string_of("e"), "long block\nstring with CRLF"));
+	TOGO_ASSERTE(string_of("g").empty());
+#endif
+
+	// Copies do not refer to the mapping
+	Object copy;
+	object::copy(copy, doc.root);
+	object::clear(doc);
+	TOGO_ASSERTE(!doc._mapping);
+	TOGO_ASSERTE(string::compare_equal(
+		object::string(*object::find_child(copy, "a")), "long string without escapes"
+	));
+	std::remove(path.data);
+	TOGO_ASSERTE(!object::read_text_file(doc, path) && !doc._mapping);
+}
+
+void check_number(char const* const text) {
+	Object obj;
+	ObjectParserInfo pinfo;
+	TOGO_ASSERTE(object::read_text_string(obj, StringRef{text, cstr_tag{}}, pinfo, true));
+	if (object::is_integer(obj)) {
+		TOGO_ASSERTE(object::integer(obj) == std::strtoll(text, nullptr, 10));
+	} else {
+		TOGO_ASSERTE(object::is_decimal(obj));
+		f64 const value = object::decimal(obj);
+		f64 const expected = std::strtod(text, nullptr);
+		TOGO_ASSERTE(std::memcmp(&value, &expected, sizeof(f64)) == 0);
+	}
+}
+
+void check_numbers() {
+	char const* const numbers[]{
+		"0", "-0", "007", "9223372036854775807", "-9223372036854775807",
+		"-9223372036854775808", "9223372036854775808", "99999999999999999999",
+		"0.0", "-0.0", "0.1", "0.3", "1.7976931348623157e308", "4.9e-324",
+		"2.2250738585072014e-308", "9007199254740993", "9007199254740993.0",
+		"123456789012345678901234567890.0", "0.000000000000000000000000000001",
+		"1e22", "1e23", "1e-22", "1e-23", "1.5e400", "1.5e-400",
+		"3.14159265358979323846", "-.5", "+5.0e2",
+	};
+	for (auto const number : numbers) {
+		check_number(number);
+	}
+	char text[64];
+	u64 state = 0x9E3779B97F4A7C15;
+	for (unsigned i = 0; i < 10000; ++i) {
+		state = state * 6364136223846793005 + 1442695040888963407;
+		unsigned const digits = 1 + (state >> 33) % 19;
+		u64 mantissa = state >> 11;
+		for (unsigned d = 19; d > digits; --d) {
+			mantissa /= 10;
+		}
+		signed const exponent = static_cast<signed>((state >> 40) % 61) - 30;
+		signed const size = std::snprintf(
+			text, sizeof(text), "%llu", static_cast<unsigned long long>(mantissa)
+		);
+		// Digits after the point; at least one before it
+		signed const point = static_cast<signed>((state >> 5) % static_cast<unsigned>(size));
+		std::memmove(text + size - point + 1, text + size - point, point + 1);
+		text[size - point] = '.';
+		std::snprintf(text + size + 1, sizeof(text) - size - 1, "%se%d", point ? "" : "0", exponent);
+		check_number(text);
+	}
+}
+
 bool rewrite_file(MemoryStream& out_stream, StringRef path) {
 	Object root;
 	if (!object::read_text_file(root, path)) {
@@ -506,6 +1157,12 @@ signed main(signed argc, char* argv[]) {
 		for (auto& test : tests) {
 			check(test);
 		}
+		check_numbers();
+		check_visit();
+		check_resume();
+		check_parallel();
+		check_update();
+		check_document_file();
 	}
 	return 0;
 }
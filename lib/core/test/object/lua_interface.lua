@@ -1,5 +1,7 @@
 
 local O = require "Quanta.Object"
+local FO = require "Quanta.FrozenObject"
+local Match = require "Quanta.Match"
 local T = require "Quanta.Time"
 require "Quanta.Time.Gregorian"
 
@@ -165,6 +167,43 @@ do
 	assert(t == O.find_tag(a, "leftover"))
 end
 
+do
+	local a = O.create()
+	for i = 1, 40 do
+		O.set_name(O.push_child(a), "c" .. i)
+	end
+	assert(O.find_child(a, "c1") == O.child_at(a, 1))
+	assert(O.find_child(a, "c40") == O.child_at(a, 40))
+	assert(O.find_child(a, "c41") == nil)
+
+	O.set_name(O.push_child(a), "c41")
+	assert(O.find_child(a, "c41") == O.child_at(a, 41))
+	O.remove_child(a, 1)
+	assert(O.find_child(a, "c1") == nil)
+	assert(O.find_child(a, "c2") == O.child_at(a, 1))
+	O.pop_child(a)
+	assert(O.find_child(a, "c41") == nil)
+
+	O.set_name(O.child_at(a, 1), "renamed")
+	assert(O.find_child(a, "renamed") == O.child_at(a, 1))
+	local late = O.push_child(a)
+	assert(O.find_child(a, "late") == nil)
+	O.set_name(late, "late")
+	assert(O.find_child(a, "late") == late)
+	O.clear_children(a)
+	assert(O.find_child(a, "c3") == nil)
+end
+
+do
+	local a = O.create_mv("x = {y = 1}, z = 2")
+	local b = O.create()
+	O.copy_shared(b, a)
+	assert(O.num_children(b) == 2)
+	O.set_integer(O.find_child(O.find_child(b, "x"), "y"), 5)
+	assert(O.integer(O.find_child(O.find_child(a, "x"), "y")) == 1)
+	assert(O.integer(O.find_child(O.find_child(b, "x"), "y")) == 5)
+end
+
 do
 	local wow = T()
 	-- treated as local when resolve_time() is called (from unzoned to -04:00)
@@ -229,3 +268,104 @@ do
 	assert(O.op(e2) == O.Operator.div)
 
 end
+
+do
+	local a = O.create_mv [[
+		x = Entry:primary{n = 1, d = 2016-01-02}
+		y = Eat[2kg]
+	]]
+	local doc = FO.freeze(a)
+	local root = FO.root(doc)
+	assert(FO.num_children(root) == 2 and FO.num_objects(doc) == 7)
+	for i, v in FO.children(root) do
+		assert(
+			(i == 1 and FO.name(v) == "x") or
+			(i == 2 and FO.name(v) == "y") or
+			false
+		)
+	end
+
+	local x = FO.find_child(root, "x")
+	assert(FO.is_type(x, FO.Type.identifier) and FO.identifier(x) == "Entry")
+	assert(FO.find_tag(x, "primary") == FO.tag_at(x, 1))
+	assert(FO.find_child(x, FO.hash_name("n")) == FO.child_at(x, 1))
+	assert(FO.integer(FO.child_at(x, 1)) == 1)
+	assert(FO.has_date(FO.child_at(x, 2)) and not FO.has_clock(FO.child_at(x, 2)))
+	assert(FO.find_child(root, "z") == nil)
+
+	local q = FO.quantity(FO.child_at(root, 2))
+	assert(FO.is_integer(q) and FO.integer(q) == 2 and FO.unit(q) == "kg")
+
+	-- Match reads through the module given to its context
+	local names = {}
+	local t_names = Match.Tree({
+	Match.Pattern{
+		name = true,
+		vtype = Match.Any,
+		tags = Match.Any,
+		children = Match.Any,
+		quantity = Match.Any,
+		acceptor = function(context, _, obj)
+			table.insert(names, context.O.name(obj))
+		end,
+	},
+	})
+	t_names:build()
+	local context = Match.Context(FO)
+	assert(context:consume_sub(t_names, root))
+	assert(#names == 2 and names[1] == "x" and names[2] == "y")
+
+	local t_x = Match.Tree({
+	Match.Pattern{
+		name = "x",
+		vtype = FO.Type.identifier,
+		value = "Entry",
+		tags = 1,
+		children = {Match.Pattern{
+			name = "n",
+			vtype = FO.Type.integer,
+			value = 1,
+		}, Match.Pattern{
+			name = "d",
+			vtype = FO.Type.time,
+		}},
+	},
+	})
+	t_x:build()
+	context = Match.Context(FO)
+	assert(context:consume(t_x, x))
+	assert(not context:consume_sub(t_x, root))
+	assert(FO.name(context.error.obj) == "y" and context.error:to_string())
+
+	assert(FO.numeric(q) == 2)
+	local c = O.create()
+	FO.copy_children(c, x)
+	assert(O.num_children(c) == 2 and O.integer(O.find_child(c, "n")) == 1)
+	FO.copy_tags(c, x)
+	assert(O.find_tag(c, "primary") ~= nil)
+	FO.copy(c, FO.child_at(root, 2), false)
+	assert(O.identifier(c) == "Eat" and O.num_children(c) == 0 and O.integer(O.quantity(c)) == 2)
+
+	-- Reads from the document, not from a
+	O.clear(a)
+	assert(FO.identifier(x) == "Entry")
+	FO.freeze(a, doc)
+	assert(FO.num_objects(doc) == 1 and FO.is_null(FO.root(doc)))
+end
+
+do
+	local path = "lua_interface_update_test.q"
+	local a = O.create_mv("x = 1\ny = 2")
+	local success, layout = O.write_text_file_update(a, path)
+	assert(success and layout)
+	O.set_integer(O.push_child(a), 3)
+	assert(O.write_text_file_update(a, path, layout))
+	local b = O.create()
+	assert(O.read_text_file(b, path) and O.num_children(b) == 3)
+	-- A new layout is loaded from the file next to path
+	O.set_integer(O.child_at(a, 1), 4)
+	assert(O.write_text_file_update(a, path))
+	assert(O.read_text_file(b, path) and O.integer(O.child_at(b, 1)) == 4)
+	os.remove(path)
+	os.remove(path .. ".layout")
+end
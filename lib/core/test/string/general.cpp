@@ -16,23 +16,47 @@ signed main() {
 	{
 		UnmanagedString s{};
 		unmanaged_string::set(s, "", a);
-		TOGO_ASSERTE(s.data == nullptr && s.size == 0);
+		TOGO_ASSERTE(s.size == 0 && unmanaged_string::data(s)[0] == '\0');
 
 		unmanaged_string::set(s, "xyz", a);
-		TOGO_ASSERTE(s.data != nullptr && s.size == 3 && string::compare_equal(s, "xyz"));
+		TOGO_ASSERTE(s.size == 3 && string::compare_equal(s, "xyz"));
+		TOGO_ASSERTE(unmanaged_string::is_inline(s));
+		TOGO_ASSERTE(unmanaged_string::data(s)[3] == '\0');
+
+		StringRef const long_value{"more than inline capacity"};
+		unmanaged_string::set(s, long_value, a);
+		TOGO_ASSERTE(!unmanaged_string::is_inline(s));
+		TOGO_ASSERTE(string::compare_equal(s, long_value));
+		TOGO_ASSERTE(unmanaged_string::data(s) != long_value.data);
+
+		unmanaged_string::set(s, "xyz", a);
+		TOGO_ASSERTE(unmanaged_string::is_inline(s));
+		TOGO_ASSERTE(string::compare_equal(s, "xyz"));
+
+		UnmanagedString shared{};
+		unmanaged_string::set_shared(shared, long_value);
+		TOGO_ASSERTE(unmanaged_string::data(shared) == long_value.data);
+		unmanaged_string::set_shared(shared, "x");
+		TOGO_ASSERTE(unmanaged_string::is_inline(shared));
+		TOGO_ASSERTE(string::compare_equal(shared, "x"));
 
 		unmanaged_string::clear(s, a);
+		TOGO_ASSERTE(s.size == 0 && unmanaged_string::data(s)[0] == '\0');
 	}
 	{
 		HashedUnmanagedString<hash::Default32> s{};
 		unmanaged_string::set(s, "", a);
-		TOGO_ASSERTE(s.data == nullptr && s.size == 0);
+		TOGO_ASSERTE(s.size == 0 && unmanaged_string::data(s)[0] == '\0');
 		TOGO_ASSERTE(s.hash == hash::IDENTITY32);
 
 		unmanaged_string::set(s, "xyz", a);
-		TOGO_ASSERTE(s.data != nullptr && s.size == 3 && string::compare_equal(s, "xyz"));
+		TOGO_ASSERTE(s.size == 3 && string::compare_equal(s, "xyz"));
 		TOGO_ASSERTE(s.hash == "xyz"_hash32);
 
+		unmanaged_string::set(s, "more than inline capacity", a);
+		TOGO_ASSERTE(string::compare_equal(s, "more than inline capacity"));
+		TOGO_ASSERTE(s.hash == "more than inline capacity"_hash32);
+
 		unmanaged_string::clear(s, a);
 	}
 	return 0;
@@ -3,6 +3,7 @@ require "common"
 
 local U = require "togo.utility"
 local O = require "Quanta.Object"
+local FO = require "Quanta.FrozenObject"
 local Tracker = require "Quanta.Tracker"
 local Vessel = require "Quanta.Vessel"
 
@@ -242,6 +243,18 @@ make_test_fail(
 ),
 }
 
+function check_write_file(tracker)
+	local path = "tracker_translation_test.q"
+	U.assert(tracker:write_file(path))
+	-- Loads the layout saved by the first write
+	U.assert(tracker:write_file(path))
+	local obj = O.create()
+	U.assert(O.read_text_file(obj, path, true))
+	U.assert(O.write_text_string(obj, true) == O.write_text_string(tracker:to_object(), true))
+	os.remove(path)
+	os.remove(path .. ".layout")
+end
+
 function do_test(t)
 	local obj = O.create(t.text)
 	U.assert(obj ~= nil)
@@ -256,9 +269,19 @@ function do_test(t)
 		--tracker:to_object(obj)
 		--U.print("%s", O.write_text_string(obj, true))
 		check_tracker_equal(tracker, t.tracker)
+		check_write_file(tracker)
 	else
 		U.print("(expected)")
 	end
+
+	-- Reading the frozen document must give the same result
+	local doc = FO.freeze(obj)
+	local frozen_tracker = Tracker()
+	local frozen_success = frozen_tracker:from_object(FO.root(doc), FO)
+	U.assert(frozen_success == success, "unexpected frozen success value: %s", frozen_success)
+	if t.tracker then
+		check_tracker_equal(frozen_tracker, t.tracker)
+	end
 end
 
 function main()